@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <vector>
+
+#include "../src/Clock.h"
+#include "../src/GLExtensions.h"
+#include "../src/DeletionQueue.h"
+#include "../src/ResourceRegistry.h"
+
+//* Small helper shared by the benchmarks in bench/. Makes a hidden window with the same 3.3 core context
+//* main.cpp asks for, loads glad plus our extensions, and tears it down again when it goes out of scope.
+class BenchContext {
+public:
+  BenchContext(int width = 500, int height = 500)
+    : m_width(width), m_height(height) {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    #ifdef __APPLE__
+      glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    #endif
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    m_window = glfwCreateWindow(width, height, "bench", NULL, NULL);
+    if(m_window == NULL){
+      std::cerr << "Window failed to create\n";
+      glfwTerminate();
+      return;
+    }
+    glfwMakeContextCurrent(m_window);
+    //* Don't let vsync decide how fast the loop runs.
+    glfwSwapInterval(0);
+    gladLoadGL();
+    GLLoadExtensions((GLADloadproc)glfwGetProcAddress);
+
+    std::cout << "GL_VERSION:  " << glGetString(GL_VERSION) << '\n';
+    std::cout << "GL_RENDERER: " << glGetString(GL_RENDERER) << "\n\n";
+  }
+
+  ~BenchContext(){
+    //* The benchmark's objects die before the context does, their names are waiting in here.
+    ResourceRegistry::Clear();
+    DeletionQueue::Flush();
+    if(m_window){
+      glfwDestroyWindow(m_window);
+    }
+    glfwTerminate();
+  }
+
+  inline bool IsValid() const { return m_window != NULL; }
+  inline GLFWwindow* GetWindow() const { return m_window; }
+  inline int GetWidth() const { return m_width; }
+  inline int GetHeight() const { return m_height; }
+private:
+  GLFWwindow* m_window = NULL;
+  int m_width;
+  int m_height;
+};
+
+//* Milliseconds since some earlier point, for timing loops.
+inline double BenchNow(){
+  return Clock::NowMs();
+}
+
+//* The color buffer as RGBA8, bottom row first.
+inline std::vector<unsigned char> BenchReadPixels(int width, int height){
+  std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+  return pixels;
+}
+
+inline unsigned long long BenchChecksum(const std::vector<unsigned char>& pixels){
+  unsigned long long sum = 0;
+  for(unsigned char p : pixels){
+    sum = sum * 31 + p;
+  }
+  return sum;
+}
+
+//* Hash of what's been drawn, to check two ways of drawing a frame agree. Read it before glfwSwapBuffers,
+//* the back buffer's contents are undefined after a swap.
+inline unsigned long long BenchChecksum(int width, int height){
+  return BenchChecksum(BenchReadPixels(width, height));
+}
+
+//* Average ms spent in issue(frame) over frames frames. glFinish runs after the timed part, so this is the
+//* CPU cost of issuing the calls, and one frame's GPU work doesn't spill into the next one's time.
+template<typename IssueFrame>
+double TimeFrames(int frames, IssueFrame issue){
+  double total = 0.0;
+  for(int frame = 0; frame < frames; ++frame){
+    double start = BenchNow();
+    issue(frame);
+    total += BenchNow() - start;
+    glFinish();
+  }
+  return total / frames;
+}
@@ -0,0 +1,207 @@
+#include "BenchContext.h"
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../src/renderer.h"
+#include "../src/VertexArray.h"
+#include "../src/VertexBuffer.h"
+#include "../src/IndexBuffer.h"
+#include "../src/Shader.h"
+#include "../src/UniformRing.h"
+#include "../src/UniformBlockBindings.h"
+#include "../src/IndirectRenderer.h"
+#include "../src/InstanceCuller.h"
+
+/*
+INSTANCES spheres around a camera that turns a little every frame, all one glDrawElementsInstanced:
+  no culling    the instance buffer as it is
+  padded        InstanceCuller on plain 3.3, culled slots zeroed and still drawn
+  query buffer  InstanceCuller with the visible count written into an indirect command on the GPU
+All three use res/shaders/feedback_instanced.vert. Transform feedback keeps the instances in order, so
+with no depth buffer the images have to match exactly, and both cullers have to keep what the same sphere
+test on the CPU keeps.
+*/
+
+static const int FRAMES = 10;
+static const int INSTANCES = 100000;
+//* Rings and segments of the sphere, 2 * 12 * 16 triangles.
+static const int RINGS = 12;
+static const int SEGMENTS = 16;
+
+struct MeshVertex {
+  float position[3];
+  unsigned char color[4];
+};
+VERTEX_LAYOUT(MeshVertex, VERTEX_ATTRIB(MeshVertex, position), VERTEX_ATTRIB_NORMALIZED(MeshVertex, color));
+
+struct CameraConstants {
+  Mat4 viewProjection;
+};
+UNIFORM_BLOCK(CameraConstants, Std140, UNIFORM_MEMBER(CameraConstants, viewProjection));
+
+static Mat4 Multiply(const Mat4& a, const Mat4& b){
+  Mat4 result;
+  for(int column = 0; column < 4; ++column){
+    for(int row = 0; row < 4; ++row){
+      float sum = 0.0f;
+      for(int k = 0; k < 4; ++k){
+        sum += a.m[k * 4 + row] * b.m[column * 4 + k];
+      }
+      result.m[column * 4 + row] = sum;
+    }
+  }
+  return result;
+}
+
+static Mat4 ViewProjection(float angle){
+  float f = 1.0f / std::tan(0.525f);
+  float nearPlane = 0.5f;
+  float farPlane = 200.0f;
+  Mat4 projection = {};
+  projection.m[0] = f;
+  projection.m[5] = f;
+  projection.m[10] = (farPlane + nearPlane) / (nearPlane - farPlane);
+  projection.m[11] = -1.0f;
+  projection.m[14] = 2.0f * farPlane * nearPlane / (nearPlane - farPlane);
+  float c = std::cos(angle);
+  float s = std::sin(angle);
+  Mat4 view = { { c, 0.0f, -s, 0.0f,  0.0f, 1.0f, 0.0f, 0.0f,  s, 0.0f, c, 0.0f,  0.0f, 0.0f, 0.0f, 1.0f } };
+  return Multiply(projection, view);
+}
+
+int main(){
+  BenchContext context;
+  if(!context.IsValid()){
+    return -1;
+  }
+
+  std::vector<MeshVertex> vertices;
+  std::vector<unsigned int> indices;
+  for(int ring = 0; ring <= RINGS; ++ring){
+    float theta = 3.14159265f * ring / RINGS;
+    for(int segment = 0; segment <= SEGMENTS; ++segment){
+      float phi = 6.2831853f * segment / SEGMENTS;
+      unsigned char shade = static_cast<unsigned char>(120 + 135 * ring / RINGS);
+      vertices.push_back({ { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) }, { shade, shade, shade, 255 } });
+    }
+  }
+  for(int ring = 0; ring < RINGS; ++ring){
+    for(int segment = 0; segment < SEGMENTS; ++segment){
+      unsigned int a = ring * (SEGMENTS + 1) + segment;
+      unsigned int b = a + SEGMENTS + 1;
+      indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+    }
+  }
+  VertexBuffer mesh(vertices.data(), static_cast<unsigned int>(vertices.size() * sizeof(MeshVertex)));
+  IndexBuffer ib(indices.data(), static_cast<unsigned int>(indices.size()));
+
+  std::mt19937 random(5);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::vector<CullInstance> instances(INSTANCES);
+  for(CullInstance& instance : instances){
+    instance = { { unit(random) * 300.0f - 150.0f, unit(random) * 40.0f - 20.0f, unit(random) * 300.0f - 150.0f, 0.1f + unit(random) * 0.2f },
+      { 0.3f + unit(random) * 0.7f, 0.3f + unit(random) * 0.7f, 0.3f + unit(random) * 0.7f, 1.0f } };
+  }
+  VertexBuffer all(instances.data(), static_cast<unsigned int>(instances.size() * sizeof(CullInstance)));
+
+  InstanceCuller padded(INSTANCES, false);
+  std::unique_ptr<InstanceCuller> queried;
+  if(InstanceCuller::IsQueryBufferSupported()){
+    queried = std::make_unique<InstanceCuller>(INSTANCES, true);
+  }
+  if(!padded.IsValid() || (queried && !queried->IsValid())){
+    return -1;
+  }
+
+  struct Path {
+    const char* name;
+    InstanceCuller* culler;
+    VertexArray va;
+  };
+  std::vector<Path> paths;
+  paths.push_back({ "no culling:   ", nullptr, VertexArray() });
+  paths.push_back({ "padded:       ", &padded, VertexArray() });
+  if(queried){
+    paths.push_back({ "query buffer: ", queried.get(), VertexArray() });
+  }
+  //* Mesh at locations 0 and 1, the instances at 2 and 3 with divisor 1.
+  for(Path& path : paths){
+    path.va.AddBuffer<MeshVertex>(mesh);
+    if(path.culler){
+      path.culler->SetInstances(instances.data(), INSTANCES);
+      path.va.AddBuffer<CullInstance>(path.culler->GetVisible(), 1);
+    }else{
+      path.va.AddBuffer<CullInstance>(all, 1);
+    }
+  }
+
+  Shader shader("res/shaders/feedback_instanced.vert", "res/shaders/constants.frag");
+  UniformRing cameraRing(4096);
+  unsigned int cameraBinding = UniformBlockBindings::GetBinding("CameraConstants");
+
+  auto frame = [&](Path& path, float angle){
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+    CameraConstants camera = { ViewProjection(angle) };
+    UniformRing::Bind(cameraBinding, cameraRing.Write(camera));
+    if(path.culler){
+      Vec4 planes[6];
+      IndirectRenderer::ExtractFrustumPlanes(camera.viewProjection, planes);
+      path.culler->Cull(planes, 1.0f);
+      path.culler->Draw(path.va, ib, shader);
+    }else{
+      shader.Bind();
+      path.va.Bind();
+      ib.Bind();
+      GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr, INSTANCES));
+    }
+    cameraRing.EndFrame();
+  };
+
+  //* The reference: the same sphere test as feedback_cull.geom, here.
+  unsigned int expected = 0;
+  {
+    Vec4 planes[6];
+    IndirectRenderer::ExtractFrustumPlanes(ViewProjection(0.3f), planes);
+    for(const CullInstance& instance : instances){
+      bool inside = true;
+      for(const Vec4& plane : planes){
+        const float* p = plane.v;
+        inside &= p[0] * instance.placement[0] + p[1] * instance.placement[1] + p[2] * instance.placement[2] + p[3] >= -instance.placement[3];
+      }
+      expected += inside;
+    }
+  }
+
+  std::cout << INSTANCES << " instances of " << indices.size() / 3 << " triangles, " << expected << " in view\n";
+  unsigned long long checksums[3] = {};
+  bool countsMatch = true;
+  for(size_t p = 0; p < paths.size(); ++p){
+    frame(paths[p], 0.3f);
+    checksums[p] = BenchChecksum(context.GetWidth(), context.GetHeight());
+    unsigned int visible = paths[p].culler ? paths[p].culler->ReadVisibleCount() : INSTANCES;
+    if(paths[p].culler && visible != expected){
+      countsMatch = false;
+    }
+
+    double cpuMs = 0.0;
+    double start = BenchNow();
+    for(int f = 0; f < FRAMES; ++f){
+      double issue = BenchNow();
+      frame(paths[p], 0.3f + f * 0.01f);
+      cpuMs += BenchNow() - issue;
+      glFinish();
+    }
+    double totalMs = (BenchNow() - start) / FRAMES;
+    std::cout << paths[p].name << totalMs << " ms/frame, " << cpuMs / FRAMES << " ms CPU, " << visible << " instances drawn\n";
+  }
+  bool same = true;
+  for(size_t p = 1; p < paths.size(); ++p){
+    same &= checksums[p] == checksums[0];
+  }
+  std::cout << "Culled images match the unculled one: " << (same ? "yes" : "NO") << '\n';
+  std::cout << "Culled counts match the CPU sphere test: " << (countsMatch ? "yes" : "NO") << '\n';
+  return 0;
+}
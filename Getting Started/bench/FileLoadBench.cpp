@@ -0,0 +1,142 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/Clock.h"
+#include "../src/FileLoader.h"
+#include "../src/ShaderPreprocessor.h"
+
+/*
+Loads a generated shader library: SHADERS top level shaders of about 24 KB, each including three of
+LIBRARIES shared files of about 48 KB. Every loader touches every byte (a checksum), so mapped files pay
+for their page faults too. Doesn't need a GPU or a window.
+  getline       the old Shader::ParseShader, a stringstream and one getline per line
+  read / map    FileLoader in each mode, and Auto, which picks per file size
+  preprocess    ShaderPreprocessor::Process on every shader with includes expanded, with an empty file cache
+                and again with everything cached
+Best of ROUNDS, the files are in the page cache after the first round so this is the CPU side only.
+*/
+
+static const int SHADERS = 300;
+static const int LIBRARIES = 20;
+static const int ROUNDS = 5;
+static const char* DIRECTORY = "bench_library";
+
+static std::string MakeFunctions(const std::string& prefix, int count){
+  std::string text;
+  for(int i = 0; i < count; ++i){
+    std::string index = std::to_string(i);
+    text += "// " + prefix + " helper " + index + ", generated for the file loading benchmark\n";
+    text += "vec4 " + prefix + "_" + index + "(vec4 c, float t){\n";
+    text += "    c.rgb = mix(c.rgb, vec3(sin(t * " + index + ".0), cos(t), 0.5), 0.25);\n";
+    text += "    return clamp(c * vec4(0.9, 0.95, 1.0, 1.0), 0.0, 1.0);\n";
+    text += "}\n\n";
+  }
+  return text;
+}
+
+static std::vector<std::string> WriteLibrary(){
+  std::filesystem::create_directories(std::string(DIRECTORY) + "/lib");
+  for(int i = 0; i < LIBRARIES; ++i){
+    std::ofstream(std::string(DIRECTORY) + "/lib/common" + std::to_string(i) + ".glsl") << MakeFunctions("lib" + std::to_string(i), 240);
+  }
+  std::vector<std::string> paths;
+  for(int i = 0; i < SHADERS; ++i){
+    std::string path = std::string(DIRECTORY) + "/shader" + std::to_string(i) + ".frag";
+    std::ofstream file(path);
+    file << "#version 330 core\n";
+    for(int j = 0; j < 3; ++j){
+      file << "#include \"lib/common" << (i + j * 7) % LIBRARIES << ".glsl\"\n";
+    }
+    file << MakeFunctions("s" + std::to_string(i), 120);
+    file << "out vec4 color;\nvoid main(){ color = vec4(1.0); }\n";
+    paths.push_back(path);
+  }
+  return paths;
+}
+
+static unsigned int Checksum(const char* data, size_t size){
+  unsigned int sum = 0;
+  for(size_t i = 0; i < size; ++i){
+    sum = sum * 31 + static_cast<unsigned char>(data[i]);
+  }
+  return sum;
+}
+
+template<typename LoadAll>
+static double Best(LoadAll load, unsigned long long& bytes){
+  double best = 1e30;
+  for(int round = 0; round < ROUNDS; ++round){
+    bytes = 0;
+    double start = Clock::NowMs();
+    load(bytes);
+    double elapsed = Clock::NowMs() - start;
+    best = elapsed < best ? elapsed : best;
+  }
+  return best;
+}
+
+static void Print(const char* name, double ms, unsigned long long bytes){
+  std::cout << name << ms << " ms, " << bytes / (1024.0 * 1024.0) / (ms / 1000.0) << " MB/s\n";
+}
+
+int main(){
+  std::vector<std::string> paths = WriteLibrary();
+  volatile unsigned int sink = 0;
+  unsigned long long bytes = 0;
+
+  double getline = Best([&](unsigned long long& total){
+    for(const std::string& path : paths){
+      std::ifstream stream(path);
+      std::string line;
+      std::stringstream shader;
+      while(std::getline(stream, line)){
+        shader << line << '\n';
+      }
+      std::string source = shader.str();
+      sink = sink + Checksum(source.data(), source.size());
+      total += source.size();
+    }
+  }, bytes);
+  Print("getline:           ", getline, bytes);
+
+  const FileLoadMode modes[] = { FileLoadMode::Read, FileLoadMode::Map, FileLoadMode::Auto };
+  const char* names[] = { "read:              ", "map:               ", "auto:              " };
+  for(int m = 0; m < 3; ++m){
+    double ms = Best([&](unsigned long long& total){
+      for(const std::string& path : paths){
+        FileData file = FileLoader::Load(path, modes[m]);
+        sink = sink + Checksum(file.GetData(), file.GetSize());
+        total += file.GetSize();
+      }
+    }, bytes);
+    Print(names[m], ms, bytes);
+  }
+
+  double cold = Best([&](unsigned long long& total){
+    ShaderPreprocessor::ClearCache();
+    for(const std::string& path : paths){
+      PreprocessedShader shader = ShaderPreprocessor::Process(path);
+      total += shader.source.size();
+    }
+  }, bytes);
+  Print("preprocess cold:   ", cold, bytes);
+  double warm = Best([&](unsigned long long& total){
+    for(const std::string& path : paths){
+      PreprocessedShader shader = ShaderPreprocessor::Process(path);
+      total += shader.source.size();
+    }
+  }, bytes);
+  Print("preprocess cached: ", warm, bytes);
+
+  FileLoader::ResetStats();
+  FileData missing = FileLoader::Load(std::string(DIRECTORY) + "/does_not_exist.frag");
+  std::cout << "missing file: " << (missing.IsValid() ? "loaded?" : "reported") << ", " << FileLoader::GetStats().missing << " counted\n";
+
+  std::error_code error;
+  std::filesystem::remove_all(DIRECTORY, error);
+  return 0;
+}
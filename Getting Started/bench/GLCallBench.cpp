@@ -0,0 +1,84 @@
+#include "BenchContext.h"
+
+#include "../src/renderer.h"
+#include "../src/VertexArray.h"
+#include "../src/IndexBuffer.h"
+#include "../src/Shader.h"
+
+/*
+Measures the CPU cost of the per call glGetError checks.
+Every frame issues the same bind / uniform / draw sequence main.cpp does, DRAWS times over, once through
+GLCallChecked (what debug builds use) and once through GLCallBare (what release builds use).
+Only the time spent issuing the calls is counted, glFinish runs outside the timed part.
+*/
+
+static const int FRAMES = 200;
+static const int DRAWS = 1000;
+
+int main(){
+  BenchContext context;
+  if(!context.IsValid()){
+    return -1;
+  }
+
+  float positions[] = {
+    -0.5f, -0.5f,
+     0.5f, -0.5f,
+     0.5f,  0.5f,
+    -0.5f,  0.5f,
+  };
+  unsigned int indices[]{
+    0, 1, 2,
+    3, 2, 0
+  };
+
+  VertexArray va;
+  VertexBuffer vb(positions, 4 * 2 * sizeof(float));
+  VertexBufferLayout layout;
+  layout.Push<float>(2);
+  va.AddBuffer(vb, layout);
+  IndexBuffer ib(indices, 6);
+  Shader shader("res/shaders/vertex.vert", "res/shaders/fragment.frag");
+
+  //* Grab the raw ids back out of GL so the loops below only time the calls themselves.
+  GLint program = 0, vao = 0, ibo = 0;
+  shader.Bind();
+  va.Bind();
+  ib.Bind();
+  glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+  glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &ibo);
+  GLint location = glGetUniformLocation(program, "u_Color");
+
+  double checked = TimeFrames(FRAMES, [&](int frame){
+    float r = (frame % 100) / 100.0f;
+    GLCallChecked(glClear(GL_COLOR_BUFFER_BIT));
+    for(int i = 0; i < DRAWS; ++i){
+      GLCallChecked(glUseProgram(program));
+      GLCallChecked(glUniform4f(location, r, 0.9f, 1 - r, 1.0f));
+      GLCallChecked(glBindVertexArray(vao));
+      GLCallChecked(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo));
+      GLCallChecked(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+    }
+  });
+
+  bool debugOutput = GLDebugInit();
+  double bare = TimeFrames(FRAMES, [&](int frame){
+    float r = (frame % 100) / 100.0f;
+    GLCallBare(glClear(GL_COLOR_BUFFER_BIT));
+    for(int i = 0; i < DRAWS; ++i){
+      GLCallBare(glUseProgram(program));
+      GLCallBare(glUniform4f(location, r, 0.9f, 1 - r, 1.0f));
+      GLCallBare(glBindVertexArray(vao));
+      GLCallBare(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo));
+      GLCallBare(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+    }
+    GLDebugFlush();
+  });
+
+  std::cout << DRAWS << " draws/frame, " << FRAMES << " frames\n";
+  std::cout << "GLCallChecked: " << checked << " ms/frame CPU\n";
+  std::cout << "GLCallBare:    " << bare << " ms/frame CPU (debug output " << (debugOutput ? "on" : "unavailable") << ")\n";
+  std::cout << "saved:         " << checked - bare << " ms/frame (" << (checked > 0.0 ? 100.0 * (checked - bare) / checked : 0.0) << "%)\n";
+  return 0;
+}
@@ -0,0 +1,219 @@
+#include "BenchContext.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "../src/renderer.h"
+#include "../src/VertexArray.h"
+#include "../src/Shader.h"
+#include "../src/BufferHeap.h"
+#include "../src/UniformRing.h"
+#include "../src/UniformBlockBindings.h"
+#include "../src/IndirectRenderer.h"
+
+/*
+OBJECTS cubes, octahedra and pyramids scattered around a camera that turns a little every frame:
+  no culling   every object, one glDrawElementsBaseVertex each (the CPU path with planes nothing is outside of)
+  CPU culling  bounding spheres tested here, one draw per visible object
+  GPU culling  res/shaders/cull.comp writes the commands, one glMultiDrawElementsIndirect
+Frames are timed up to glFinish. Checks that both culling paths keep the same objects and cover the same
+pixels, and that culling on the CPU draws exactly what drawing everything does.
+*/
+
+static const int FRAMES = 30;
+static const int OBJECTS = 30000;
+
+struct MeshVertex {
+  float position[3];
+  unsigned char color[4];
+};
+VERTEX_LAYOUT(MeshVertex, VERTEX_ATTRIB(MeshVertex, position), VERTEX_ATTRIB_NORMALIZED(MeshVertex, color));
+
+struct CameraConstants {
+  Mat4 viewProjection;
+};
+UNIFORM_BLOCK(CameraConstants, Std140, UNIFORM_MEMBER(CameraConstants, viewProjection));
+
+static Mat4 Multiply(const Mat4& a, const Mat4& b){
+  Mat4 result;
+  for(int column = 0; column < 4; ++column){
+    for(int row = 0; row < 4; ++row){
+      float sum = 0.0f;
+      for(int k = 0; k < 4; ++k){
+        sum += a.m[k * 4 + row] * b.m[column * 4 + k];
+      }
+      result.m[column * 4 + row] = sum;
+    }
+  }
+  return result;
+}
+
+static Mat4 Perspective(float fovY, float aspect, float nearPlane, float farPlane){
+  float f = 1.0f / std::tan(fovY * 0.5f);
+  Mat4 result = {};
+  result.m[0] = f / aspect;
+  result.m[5] = f;
+  result.m[10] = (farPlane + nearPlane) / (nearPlane - farPlane);
+  result.m[11] = -1.0f;
+  result.m[14] = 2.0f * farPlane * nearPlane / (nearPlane - farPlane);
+  return result;
+}
+
+//* Rotation about y, then scale, then translation.
+static Mat4 Transform(float x, float y, float z, float angle, float scale){
+  float c = std::cos(angle) * scale;
+  float s = std::sin(angle) * scale;
+  return { { c, 0.0f, -s, 0.0f,  0.0f, scale, 0.0f, 0.0f,  s, 0.0f, c, 0.0f,  x, y, z, 1.0f } };
+}
+
+static HeapMesh AddMesh(BufferHeap& vertices, BufferHeap& indices, const std::vector<MeshVertex>& v, const std::vector<unsigned int>& i){
+  HeapMesh mesh;
+  mesh.vertices = vertices.Allocate(static_cast<unsigned int>(v.size() * sizeof(MeshVertex)), v.data());
+  mesh.indices = indices.Allocate(static_cast<unsigned int>(i.size() * sizeof(unsigned int)), i.data());
+  mesh.indexCount = static_cast<unsigned int>(i.size());
+  mesh.indexType = GL_UNSIGNED_INT;
+  mesh.vertexStride = sizeof(MeshVertex);
+  return mesh;
+}
+
+//* Pixels something was drawn on, the clear color is black.
+static unsigned int Coverage(const std::vector<unsigned char>& pixels){
+  unsigned int covered = 0;
+  for(size_t i = 0; i < pixels.size(); i += 4){
+    covered += pixels[i + 3] == 255 && pixels[i + 2] != 0;
+  }
+  return covered;
+}
+
+int main(){
+  BenchContext context;
+  if(!context.IsValid()){
+    return -1;
+  }
+
+  BufferHeap vertexHeap(GL_ARRAY_BUFFER, 1024 * 1024, sizeof(MeshVertex));
+  BufferHeap indexHeap(GL_ELEMENT_ARRAY_BUFFER, 1024 * 1024, sizeof(unsigned int));
+  std::vector<HeapMesh> meshes;
+  std::vector<float> radii;
+  {
+    std::vector<MeshVertex> cube;
+    for(int corner = 0; corner < 8; ++corner){
+      cube.push_back({ { corner & 1 ? 0.5f : -0.5f, corner & 2 ? 0.5f : -0.5f, corner & 4 ? 0.5f : -0.5f },
+        { static_cast<unsigned char>(corner & 1 ? 255 : 60), static_cast<unsigned char>(corner & 2 ? 255 : 60), 200, 255 } });
+    }
+    meshes.push_back(AddMesh(vertexHeap, indexHeap, cube, { 0,1,3, 0,3,2, 4,6,7, 4,7,5, 0,4,5, 0,5,1, 2,3,7, 2,7,6, 0,2,6, 0,6,4, 1,5,7, 1,7,3 }));
+    radii.push_back(0.87f);
+    std::vector<MeshVertex> octahedron = {
+      { { 0.7f, 0, 0 }, { 255, 80, 80, 255 } }, { { -0.7f, 0, 0 }, { 80, 255, 80, 255 } }, { { 0, 0.7f, 0 }, { 80, 80, 255, 255 } },
+      { { 0, -0.7f, 0 }, { 255, 255, 80, 255 } }, { { 0, 0, 0.7f }, { 80, 255, 255, 255 } }, { { 0, 0, -0.7f }, { 255, 80, 255, 255 } },
+    };
+    meshes.push_back(AddMesh(vertexHeap, indexHeap, octahedron, { 0,2,4, 2,1,4, 1,3,4, 3,0,4, 2,0,5, 1,2,5, 3,1,5, 0,3,5 }));
+    radii.push_back(0.7f);
+    std::vector<MeshVertex> pyramid = {
+      { { -0.5f, -0.5f, -0.5f }, { 240, 160, 40, 255 } }, { { 0.5f, -0.5f, -0.5f }, { 240, 160, 40, 255 } }, { { 0.5f, -0.5f, 0.5f }, { 240, 160, 40, 255 } },
+      { { -0.5f, -0.5f, 0.5f }, { 240, 160, 40, 255 } }, { { 0.0f, 0.5f, 0.0f }, { 255, 255, 200, 255 } },
+    };
+    meshes.push_back(AddMesh(vertexHeap, indexHeap, pyramid, { 0,2,1, 0,3,2, 0,1,4, 1,2,4, 2,3,4, 3,0,4 }));
+    radii.push_back(0.87f);
+  }
+
+  std::mt19937 random(11);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::vector<IndirectObject> objects(OBJECTS);
+  for(IndirectObject& object : objects){
+    object.mesh = random() % meshes.size();
+    object.transform = Transform(unit(random) * 300.0f - 150.0f, unit(random) * 40.0f - 20.0f, unit(random) * 300.0f - 150.0f,
+      unit(random) * 6.28f, 0.5f + unit(random));
+    object.bounds = { { 0.0f, 0.0f, 0.0f, radii[object.mesh] } };
+  }
+
+  Shader fallbackShader("res/shaders/indirect_fallback.vert", "res/shaders/constants.frag");
+  UniformRing cameraRing(4096);
+  unsigned int cameraBinding = UniformBlockBindings::GetBinding("CameraConstants");
+  Mat4 projection = Perspective(1.05f, 1.0f, 0.5f, 200.0f);
+
+  struct Path {
+    const char* name;
+    IndirectRenderer* renderer;
+    const Shader* shader;
+    bool cull;
+    VertexArray va;
+  };
+  IndirectRenderer cpu(OBJECTS, CullingMode::CPU);
+  std::unique_ptr<IndirectRenderer> gpu;
+  std::unique_ptr<Shader> indirectShader;
+  if(IndirectRenderer::IsGPUCullingSupported()){
+    gpu = std::make_unique<IndirectRenderer>(OBJECTS, CullingMode::GPU);
+    indirectShader = std::make_unique<Shader>("res/shaders/indirect.vert", "res/shaders/constants.frag");
+  }
+  std::vector<Path> paths;
+  paths.push_back({ "no culling:  ", &cpu, &fallbackShader, false, VertexArray() });
+  paths.push_back({ "CPU culling: ", &cpu, &fallbackShader, true, VertexArray() });
+  if(gpu){
+    paths.push_back({ "GPU culling: ", gpu.get(), indirectShader.get(), true, VertexArray() });
+  }
+  for(Path& path : paths){
+    path.va.AddBuffer<MeshVertex>(meshes[0].vertices);
+    path.renderer->AddObjectIndex(path.va);
+  }
+  for(IndirectRenderer* renderer : { &cpu, gpu.get() }){
+    if(!renderer){
+      continue;
+    }
+    for(const HeapMesh& mesh : meshes){
+      renderer->AddMesh(mesh);
+    }
+    renderer->SetObjects(objects.data(), OBJECTS);
+  }
+
+  auto frame = [&](Path& path, float angle){
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+    Mat4 view = Transform(0.0f, 0.0f, 0.0f, angle, 1.0f);
+    CameraConstants camera = { Multiply(projection, view) };
+    UniformRing::Bind(cameraBinding, cameraRing.Write(camera));
+    Vec4 planes[6];
+    IndirectRenderer::ExtractFrustumPlanes(camera.viewProjection, planes);
+    if(!path.cull){
+      for(Vec4& plane : planes){
+        plane = { { 0.0f, 0.0f, 0.0f, 1e9f } };
+      }
+    }
+    path.renderer->Cull(planes);
+    path.renderer->Draw(path.va, *path.shader);
+    path.renderer->EndFrame();
+    cameraRing.EndFrame();
+  };
+
+  std::cout << OBJECTS << " objects, " << (gpu ? (GLAD_GL_ARB_indirect_parameters ? "draw count from the GPU" : "draw count = object count")
+    : "no GPU culling on this context") << '\n';
+  unsigned long long checksums[3] = {};
+  unsigned int coverage[3] = {};
+  unsigned int visible[3] = {};
+  for(size_t p = 0; p < paths.size(); ++p){
+    frame(paths[p], 0.3f);
+    visible[p] = paths[p].renderer->ReadVisibleCount();
+    std::vector<unsigned char> pixels = BenchReadPixels(context.GetWidth(), context.GetHeight());
+    coverage[p] = Coverage(pixels);
+    checksums[p] = BenchChecksum(pixels);
+
+    double cpuMs = 0.0;
+    double start = BenchNow();
+    for(int f = 0; f < FRAMES; ++f){
+      double issue = BenchNow();
+      frame(paths[p], 0.3f + f * 0.01f);
+      cpuMs += BenchNow() - issue;
+      glFinish();
+    }
+    double totalMs = (BenchNow() - start) / FRAMES;
+    const IndirectRendererStats& stats = paths[p].renderer->GetStats();
+    std::cout << paths[p].name << totalMs << " ms/frame, " << cpuMs / FRAMES << " ms CPU, " << visible[p] << " visible, "
+      << stats.drawCalls << " draw calls\n";
+  }
+  std::cout << "CPU culling draws the same as no culling: " << (checksums[0] == checksums[1] ? "yes" : "NO") << '\n';
+  if(gpu){
+    std::cout << "GPU and CPU culling agree: " << (visible[1] == visible[2] && coverage[1] == coverage[2] ? "yes" : "NO")
+      << " (" << coverage[1] << " / " << coverage[2] << " pixels covered)\n";
+  }
+  return 0;
+}
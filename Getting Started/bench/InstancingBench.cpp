@@ -0,0 +1,97 @@
+#include "BenchContext.h"
+
+#include <vector>
+
+#include "../src/renderer.h"
+#include "../src/VertexArray.h"
+#include "../src/IndexBuffer.h"
+#include "../src/Shader.h"
+
+/*
+COPIES copies of the quad from main.cpp, drawn two ways:
+  one draw per copy   a VAO with just the quad, the offset set with glVertexAttrib2f before every draw
+  instanced           the quad plus an instance buffer of offsets (divisor 1), one glDrawElementsInstanced
+Both use res/shaders/instanced.vert, so the GPU work is the same and the difference is submission.
+*/
+
+static const int FRAMES = 20;
+static const int COPIES = 100000;
+
+struct QuadVertex {
+  float position[2];
+};
+VERTEX_LAYOUT(QuadVertex, VERTEX_ATTRIB(QuadVertex, position));
+
+struct QuadInstance {
+  float offset[2];
+};
+VERTEX_LAYOUT(QuadInstance, VERTEX_ATTRIB(QuadInstance, offset));
+
+template<typename IssueFrame>
+static void TimeFrames(const char* name, IssueFrame issue){
+  double cpu = 0.0;
+  double total = 0.0;
+  for(int frame = 0; frame < FRAMES; ++frame){
+    double start = BenchNow();
+    glClear(GL_COLOR_BUFFER_BIT);
+    issue();
+    double issued = BenchNow();
+    glFinish();
+    cpu += issued - start;
+    total += BenchNow() - start;
+  }
+  std::cout << name << cpu / FRAMES << " ms/frame CPU, " << total / FRAMES << " ms/frame with glFinish\n";
+}
+
+int main(){
+  BenchContext context;
+  if(!context.IsValid()){
+    return -1;
+  }
+
+  QuadVertex quad[] = {
+    { { -0.5f, -0.5f } },
+    { {  0.5f, -0.5f } },
+    { {  0.5f,  0.5f } },
+    { { -0.5f,  0.5f } },
+  };
+  unsigned int indices[]{ 0, 1, 2, 3, 2, 0 };
+
+  std::vector<QuadInstance> instances(COPIES);
+  for(int i = 0; i < COPIES; ++i){
+    instances[i] = { { (i % 400) / 200.0f - 1.0f, (i / 400) / 125.0f - 1.0f } };
+  }
+
+  VertexBuffer quadBuffer(quad, sizeof(quad));
+  VertexBuffer instanceBuffer(instances.data(), static_cast<unsigned int>(instances.size() * sizeof(QuadInstance)));
+  IndexBuffer ib(indices, 6);
+
+  VertexArray single;
+  single.AddBuffer<QuadVertex>(quadBuffer);
+
+  //* Locations 0 for the quad, 1 for the instance offset since AddBuffer keeps counting.
+  VertexArray instanced;
+  instanced.AddBuffer<QuadVertex>(quadBuffer);
+  instanced.AddBuffer<QuadInstance>(instanceBuffer, 1);
+
+  Shader shader("res/shaders/instanced.vert", "res/shaders/fragment.frag");
+  shader.Bind();
+  shader.SetUniform4f("u_Color", 0.8f, 0.2f, 0.5f, 1.0f);
+  GLint program = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+  glUniform1f(glGetUniformLocation(program, "u_Scale"), 0.004f);
+
+  Renderer renderer;
+  TimeFrames("one draw per copy: ", [&](){
+    for(const QuadInstance& instance : instances){
+      glVertexAttrib2f(1, instance.offset[0], instance.offset[1]);
+      renderer.Draw(single, ib, shader);
+    }
+  });
+  TimeFrames("instanced:         ", [&](){
+    renderer.DrawInstanced(instanced, ib, shader, COPIES);
+  });
+
+  std::cout << COPIES << " copies, " << FRAMES << " frames\n";
+  return 0;
+}
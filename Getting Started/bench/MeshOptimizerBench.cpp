@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/MeshOptimizer.h"
+
+/*
+Runs the MeshOptimizer pipeline over meshes and prints the cache / fetch stats before and after each step.
+Doesn't need a GPU or a window. Pass .obj files to run it on real assets (positions and faces only, polygons
+get fanned into triangles), otherwise it uses a shuffled grid and a sphere.
+*/
+
+struct Vertex {
+  float position[3];
+  float normal[3];
+  float uv[2];
+};
+
+struct Mesh {
+  std::string name;
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+};
+
+static Mesh MakeGrid(unsigned int size){
+  Mesh mesh;
+  mesh.name = "grid " + std::to_string(size) + "x" + std::to_string(size);
+  for(unsigned int y = 0; y <= size; ++y){
+    for(unsigned int x = 0; x <= size; ++x){
+      mesh.vertices.push_back({ { float(x), float(y), 0.0f }, { 0.0f, 0.0f, 1.0f }, { float(x) / size, float(y) / size } });
+    }
+  }
+  std::vector<unsigned int> quads;
+  for(unsigned int y = 0; y < size; ++y){
+    for(unsigned int x = 0; x < size; ++x){
+      quads.push_back(y * size + x);
+    }
+  }
+  //* Shuffle the quads so we start from a realistic worst case instead of a perfect scanline order.
+  std::shuffle(quads.begin(), quads.end(), std::mt19937(42));
+  for(unsigned int q : quads){
+    unsigned int x = q % size, y = q / size;
+    unsigned int a = y * (size + 1) + x, b = a + 1, c = a + size + 1, d = c + 1;
+    mesh.indices.insert(mesh.indices.end(), { a, b, d, a, d, c });
+  }
+  return mesh;
+}
+
+static Mesh MakeSphere(unsigned int rings, unsigned int segments){
+  Mesh mesh;
+  mesh.name = "sphere " + std::to_string(rings) + "x" + std::to_string(segments);
+  for(unsigned int r = 0; r <= rings; ++r){
+    float phi = 3.14159265f * r / rings;
+    for(unsigned int s = 0; s <= segments; ++s){
+      float theta = 2.0f * 3.14159265f * s / segments;
+      float p[3] = { std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta) };
+      mesh.vertices.push_back({ { p[0], p[1], p[2] }, { p[0], p[1], p[2] }, { float(s) / segments, float(r) / rings } });
+    }
+  }
+  for(unsigned int r = 0; r < rings; ++r){
+    for(unsigned int s = 0; s < segments; ++s){
+      unsigned int a = r * (segments + 1) + s, b = a + 1, c = a + segments + 1, d = c + 1;
+      mesh.indices.insert(mesh.indices.end(), { a, c, b, b, c, d });
+    }
+  }
+  return mesh;
+}
+
+static bool LoadObj(const std::string& path, Mesh& mesh){
+  std::ifstream file(path);
+  if(!file){
+    std::cerr << "Couldn't open " << path << '\n';
+    return false;
+  }
+  mesh.name = path;
+  std::string line;
+  while(getline(file, line)){
+    std::istringstream stream(line);
+    std::string tag;
+    stream >> tag;
+    if(tag == "v"){
+      Vertex v = {};
+      stream >> v.position[0] >> v.position[1] >> v.position[2];
+      mesh.vertices.push_back(v);
+    }else if(tag == "f"){
+      std::vector<unsigned int> face;
+      std::string corner;
+      while(stream >> corner){
+        long index = std::stol(corner.substr(0, corner.find('/')));
+        face.push_back(static_cast<unsigned int>(index < 0 ? mesh.vertices.size() + index : index - 1));
+      }
+      for(size_t i = 2; i < face.size(); ++i){
+        mesh.indices.insert(mesh.indices.end(), { face[0], face[i - 1], face[i] });
+      }
+    }
+  }
+  return !mesh.indices.empty();
+}
+
+static void Report(const char* step, const Mesh& mesh, double ms){
+  VertexCacheStats cache = MeshOptimizer::AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+  VertexFetchStats fetch = MeshOptimizer::AnalyzeVertexFetch(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), sizeof(Vertex));
+  std::cout << "  " << step << ": ACMR " << cache.acmr << ", ATVR " << cache.atvr << ", overfetch " << fetch.overfetch;
+  if(ms > 0.0){
+    std::cout << " (" << ms << " ms)";
+  }
+  std::cout << '\n';
+}
+
+template<typename Step>
+static double Time(Step step){
+  auto start = std::chrono::steady_clock::now();
+  step();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void Run(Mesh mesh){
+  std::cout << mesh.name << ": " << mesh.vertices.size() << " vertices, " << mesh.indices.size() / 3 << " triangles\n";
+  Report("original    ", mesh, 0.0);
+
+  double ms = Time([&]{
+    MeshOptimizer::OptimizeVertexCache(mesh.indices.data(), mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+  });
+  Report("vertex cache", mesh, ms);
+
+  ms = Time([&]{
+    MeshOptimizer::OptimizeOverdraw(mesh.indices.data(), mesh.indices.data(), mesh.indices.size(), mesh.vertices[0].position, mesh.vertices.size(), sizeof(Vertex));
+  });
+  Report("overdraw    ", mesh, ms);
+
+  std::vector<Vertex> fetched(mesh.vertices.size());
+  ms = Time([&]{
+    fetched.resize(MeshOptimizer::OptimizeVertexFetch(fetched.data(), mesh.indices.data(), mesh.indices.size(), mesh.vertices.data(), mesh.vertices.size(), sizeof(Vertex)));
+  });
+  mesh.vertices = fetched;
+  Report("vertex fetch", mesh, ms);
+  std::cout << '\n';
+}
+
+int main(int argc, char** argv){
+  if(argc > 1){
+    for(int i = 1; i < argc; ++i){
+      Mesh mesh;
+      if(LoadObj(argv[i], mesh)){
+        Run(mesh);
+      }
+    }
+    return 0;
+  }
+  Run(MakeGrid(256));
+  Run(MakeSphere(128, 256));
+  return 0;
+}
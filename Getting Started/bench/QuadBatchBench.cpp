@@ -0,0 +1,109 @@
+#include "BenchContext.h"
+
+#include <random>
+#include <vector>
+
+#include "../src/renderer.h"
+#include "../src/QuadBatch.h"
+#include "../src/GLState.h"
+
+/*
+Small rotated, colored, textured quads, drawn three ways through the same QuadBatch and shaders:
+  one draw per quad   Flush after every Submit, what drawing each quad on its own costs (SINGLE_QUADS of them)
+  batched             QUADS quads using TEXTURES textures, one draw per MAX_QUADS
+  batched, many tex   the same with MANY_TEXTURES textures, more than a batch has units, so batches also end
+                      when a quad needs a seventeenth texture
+Frames are timed up to glFinish, so quads/s includes the GPU. The first two also have to draw the same pixels.
+*/
+
+static const int FRAMES = 10;
+static const int QUADS = 200000;
+static const int SINGLE_QUADS = 20000;
+static const int TEXTURES = 8;
+static const int MANY_TEXTURES = 24;
+
+static std::vector<Quad> MakeQuads(int count, const std::vector<unsigned int>& textures, int textureCount){
+  std::mt19937 random(3);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::vector<Quad> quads(count);
+  for(Quad& quad : quads){
+    quad.position[0] = unit(random) * 2.0f - 1.0f;
+    quad.position[1] = unit(random) * 2.0f - 1.0f;
+    quad.size[0] = 0.004f + 0.01f * unit(random);
+    quad.size[1] = 0.004f + 0.01f * unit(random);
+    quad.rotation = unit(random) * 6.28f;
+    quad.color[0] = static_cast<unsigned char>(random() % 256);
+    quad.color[1] = static_cast<unsigned char>(random() % 256);
+    quad.color[2] = static_cast<unsigned char>(random() % 256);
+    //* One in eight untextured, the rest pick any of the textures.
+    unsigned int pick = random() % (textureCount + textureCount / 7);
+    quad.texture = pick < static_cast<unsigned int>(textureCount) ? textures[pick] : 0;
+  }
+  return quads;
+}
+
+static void DrawQuads(QuadBatch& batch, const std::vector<Quad>& quads, bool flushEach){
+  GLCall(glClear(GL_COLOR_BUFFER_BIT));
+  for(const Quad& quad : quads){
+    batch.Submit(quad);
+    if(flushEach){
+      batch.Flush();
+    }
+  }
+  batch.EndFrame();
+}
+
+static void Run(const char* name, QuadBatch& batch, const std::vector<Quad>& quads, bool flushEach){
+  DrawQuads(batch, quads, flushEach);
+  glFinish();
+  batch.ResetStats();
+  double start = BenchNow();
+  for(int frame = 0; frame < FRAMES; ++frame){
+    DrawQuads(batch, quads, flushEach);
+  }
+  glFinish();
+  double ms = (BenchNow() - start) / FRAMES;
+  const QuadBatchStats& stats = batch.GetStats();
+  std::cout << name << ms << " ms/frame, " << quads.size() / (ms / 1000.0) / 1e6 << "M quads/s, " << stats.drawCalls / FRAMES << " draws/frame ("
+    << stats.fullFlushes / FRAMES << " full, " << stats.textureFlushes / FRAMES << " out of texture units, " << stats.regionWraps / FRAMES << " region wraps)\n";
+}
+
+int main(){
+  BenchContext context;
+  if(!context.IsValid()){
+    return -1;
+  }
+
+  std::vector<unsigned int> textures(MANY_TEXTURES);
+  GLCall(glGenTextures(MANY_TEXTURES, textures.data()));
+  for(int i = 0; i < MANY_TEXTURES; ++i){
+    //* 2x2 checkers so the UVs matter.
+    unsigned char c = static_cast<unsigned char>(100 + i * 6);
+    unsigned char texels[16] = { 255, c, 0, 255,  0, c, 255, 255,  0, c, 255, 255,  255, c, 0, 255 };
+    GLState::BindTexture(0, GL_TEXTURE_2D, textures[i]);
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels));
+  }
+
+  {
+    QuadBatch batch(QUADS);
+    std::vector<Quad> single = MakeQuads(SINGLE_QUADS, textures, TEXTURES);
+    DrawQuads(batch, single, true);
+    unsigned long long separate = BenchChecksum(context.GetWidth(), context.GetHeight());
+    DrawQuads(batch, single, false);
+    unsigned long long batched = BenchChecksum(context.GetWidth(), context.GetHeight());
+
+    std::cout << QUADS << " quads, backend " << StreamBuffer::GetBackendName(batch.GetBuffer().GetBackend()) << '\n';
+    Run("one draw per quad: ", batch, single, true);
+    Run("batched:           ", batch, MakeQuads(QUADS, textures, TEXTURES), false);
+    Run("batched, many tex: ", batch, MakeQuads(QUADS, textures, MANY_TEXTURES), false);
+    std::cout << "images " << (separate == batched ? "match" : "DIFFER") << '\n';
+  }
+
+  for(unsigned int texture : textures){
+    GLState::OnDeleteTexture(texture);
+    DeletionQueue::Enqueue(GLObjectKind::Texture, texture);
+  }
+  return 0;
+}
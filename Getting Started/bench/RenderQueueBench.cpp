@@ -0,0 +1,171 @@
+#include "BenchContext.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/renderer.h"
+#include "../src/VertexArray.h"
+#include "../src/IndexBuffer.h"
+#include "../src/Shader.h"
+#include "../src/UniformRing.h"
+#include "../src/UniformBlockBindings.h"
+#include "../src/RenderQueue.h"
+#include "../src/GLState.h"
+
+/*
+DRAWS small quads a frame on a grid, each with one of PROGRAMS programs, one of MESHES vertex arrays and one
+of TEXTURES textures picked at random, submitted in grid order:
+  immediate  binds and draws every quad in the order it comes, like the loop in main.cpp
+  queue      the same packets through a RenderQueue, sorted by key before drawing
+The quads don't overlap, so both have to draw the same pixels. Times the CPU side of a frame and counts the
+binds GLState actually let through.
+*/
+
+static const int FRAMES = 50;
+static const int DRAWS = 4096;
+static const int PROGRAMS = 8;
+static const int MESHES = 16;
+static const int TEXTURES = 32;
+
+struct DrawConstants {
+  Vec4 offset;
+  Vec4 color;
+};
+UNIFORM_BLOCK(DrawConstants, Std140, UNIFORM_MEMBER(DrawConstants, offset), UNIFORM_MEMBER(DrawConstants, color));
+
+struct FrameConstants {
+  Vec4 tint;
+  float time;
+  float pad[3];
+};
+UNIFORM_BLOCK(FrameConstants, Std140, UNIFORM_MEMBER(FrameConstants, tint), UNIFORM_MEMBER(FrameConstants, time));
+
+struct Mesh {
+  VertexArray va;
+  VertexBuffer vb;
+  IndexBuffer ib;
+};
+
+int main(){
+  BenchContext context;
+  if(!context.IsValid()){
+    return -1;
+  }
+
+  unsigned int indices[]{
+    0, 1, 2,
+    3, 2, 0
+  };
+  VertexBufferLayout layout;
+  layout.Push<float>(2);
+  std::vector<Mesh*> meshes;
+  for(int i = 0; i < MESHES; ++i){
+    //* Every mesh a slightly different size, so they really are different meshes.
+    float size = 0.003f + 0.0002f * i;
+    float positions[] = { -size, -size, size, -size, size, size, -size, size };
+    VertexBuffer vb(positions, sizeof(positions));
+    Mesh* mesh = new Mesh{ VertexArray(), std::move(vb), IndexBuffer(indices, 6) };
+    mesh->va.AddBuffer(mesh->vb, layout);
+    //* The element buffer binding is part of the VAO, bind it with the VAO bound.
+    mesh->va.Bind();
+    mesh->ib.Bind();
+    meshes.push_back(mesh);
+  }
+
+  std::vector<unsigned int> textures(TEXTURES);
+  GLCall(glGenTextures(TEXTURES, textures.data()));
+  for(int i = 0; i < TEXTURES; ++i){
+    unsigned char texel[4] = { static_cast<unsigned char>(255 - i * 4), static_cast<unsigned char>(128 + i * 3), 255, 255 };
+    GLState::BindTexture(0, GL_TEXTURE_2D, textures[i]);
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel));
+  }
+
+  //* A define per program, otherwise the registry would hand back the same program eight times.
+  std::vector<Shader*> shaders;
+  for(int i = 0; i < PROGRAMS; ++i){
+    shaders.push_back(new Shader("res/shaders/constants.vert", "res/shaders/textured.frag", { { "BENCH_PROGRAM", std::to_string(i) } }));
+  }
+  unsigned int frameBinding = UniformBlockBindings::GetBinding("FrameConstants");
+  unsigned int drawBinding = UniformBlockBindings::GetBinding("DrawConstants");
+  UniformRing ring(DRAWS * 256 + 1024);
+  FrameConstants frameConstants = { { 1.0f, 1.0f, 1.0f, 1.0f }, 0.0f, {} };
+
+  //* Random state for every grid cell, so the submit order has nothing to do with state.
+  std::mt19937 random(7);
+  std::vector<DrawPacket> packets(DRAWS);
+  std::vector<DrawConstants> constants(DRAWS);
+  for(int i = 0; i < DRAWS; ++i){
+    DrawPacket& packet = packets[i];
+    packet.shader = shaders[random() % PROGRAMS];
+    Mesh* mesh = meshes[random() % MESHES];
+    packet.vertexArray = &mesh->va;
+    packet.indexBuffer = &mesh->ib;
+    packet.textures[0] = textures[random() % TEXTURES];
+    packet.uniformBinding = drawBinding;
+    packet.depth = static_cast<float>(random() % 1000) / 1000.0f;
+    float x = (i % 64) / 32.0f - 0.98f;
+    float y = (i / 64) / 32.0f - 0.98f;
+    constants[i] = { { x, y, 0.0f, 0.0f }, { (i % 7) / 7.0f, (i % 11) / 11.0f, (i % 13) / 13.0f, 1.0f } };
+  }
+
+  Renderer renderer;
+  RenderQueue queue;
+  auto immediate = [&](){
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+    UniformRing::Bind(frameBinding, ring.Write(frameConstants));
+    for(int i = 0; i < DRAWS; ++i){
+      const DrawPacket& packet = packets[i];
+      GLState::BindTexture(0, GL_TEXTURE_2D, packet.textures[0]);
+      UniformRing::Bind(drawBinding, ring.Write(constants[i]));
+      renderer.Draw(*packet.vertexArray, *packet.indexBuffer, *packet.shader);
+    }
+    ring.EndFrame();
+  };
+  auto sorted = [&](){
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+    UniformRing::Bind(frameBinding, ring.Write(frameConstants));
+    for(int i = 0; i < DRAWS; ++i){
+      DrawPacket packet = packets[i];
+      packet.uniforms = ring.Write(constants[i]);
+      queue.Submit(packet);
+    }
+    queue.Execute();
+    ring.EndFrame();
+  };
+
+  unsigned long long sums[2];
+  immediate(); sums[0] = BenchChecksum(context.GetWidth(), context.GetHeight());
+  sorted(); sums[1] = BenchChecksum(context.GetWidth(), context.GetHeight());
+
+  GLState::ResetStats();
+  double immediateMs = TimeFrames(FRAMES, [&](int){ immediate(); });
+  GLStateStats immediateBinds = GLState::GetStats();
+  GLState::ResetStats();
+  double queueMs = TimeFrames(FRAMES, [&](int){ sorted(); });
+  GLStateStats queueBinds = GLState::GetStats();
+  const RenderQueueStats& stats = queue.GetStats();
+
+  std::cout << DRAWS << " draws/frame, " << PROGRAMS << " programs, " << MESHES << " meshes, " << TEXTURES << " textures\n";
+  std::cout << "state changes:  " << stats.changesSubmitted << " submitted order, " << stats.changesSorted << " sorted\n";
+  std::cout << "radix sort:     " << stats.sortMs << " ms, " << stats.sortPasses << " of 8 passes\n";
+  std::cout << "immediate:      " << immediateMs << " ms/frame CPU, " << immediateBinds.programBinds / FRAMES << " program, "
+    << immediateBinds.vertexArrayBinds / FRAMES << " VAO, " << immediateBinds.textureBinds / FRAMES << " texture binds/frame\n";
+  std::cout << "queue:          " << queueMs << " ms/frame CPU, " << queueBinds.programBinds / FRAMES << " program, "
+    << queueBinds.vertexArrayBinds / FRAMES << " VAO, " << queueBinds.textureBinds / FRAMES << " texture binds/frame\n";
+  std::cout << "images " << (sums[0] == sums[1] ? "match" : "DIFFER") << '\n';
+
+  for(Shader* shader : shaders){
+    delete shader;
+  }
+  for(Mesh* mesh : meshes){
+    delete mesh;
+  }
+  for(unsigned int texture : textures){
+    GLState::OnDeleteTexture(texture);
+    DeletionQueue::Enqueue(GLObjectKind::Texture, texture);
+  }
+  return 0;
+}
@@ -0,0 +1,179 @@
+#include "BenchContext.h"
+
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../src/renderer.h"
+#include "../src/QuadBatch.h"
+#include "../src/RenderThread.h"
+#include "../src/TripleBuffer.h"
+
+/*
+PARTICLES particles bouncing around, integrated SUBSTEPS times a frame, then drawn as quads through a QuadBatch.
+Both halves are CPU work, the simulation in the loop below and the submission in QuadBatch::Submit.
+  one thread     simulate, draw, swap, all in a row
+  render thread  the simulation publishes each frame's quads through a TripleBuffer and moves on to the next
+                 frame while a RenderThread draws them
+Every frame ends in glFinish either way, so the GPU's share counts too. Checks that both draw the same
+last frame. The overlap needs a second core. On one core the two threads just take turns, and the render
+thread comes out slower: the simulation gets time sliced against the draw and every frame pays two handoffs.
+*/
+
+static const int FRAMES = 120;
+static const int PARTICLES = 40000;
+static const int SUBSTEPS = 16;
+
+struct Particle {
+  float position[2];
+  float velocity[2];
+};
+
+//* What the render thread gets, the quads ready to submit. Rebuilt whole every frame.
+struct ParticlePacket {
+  std::vector<Quad> quads;
+};
+
+static std::vector<Particle> MakeParticles(){
+  std::vector<Particle> particles(PARTICLES);
+  for(int i = 0; i < PARTICLES; ++i){
+    float angle = i * 2.3999632f;
+    float speed = 0.002f + (i % 97) * 0.00005f;
+    particles[i] = { { std::cos(angle) * (i % 1000) / 1000.0f, std::sin(angle) * (i % 1000) / 1000.0f },
+      { std::cos(angle * 3.0f) * speed, std::sin(angle * 3.0f) * speed } };
+  }
+  return particles;
+}
+
+//* A little gravity towards the middle and bounces off the edges, SUBSTEPS times, then one quad per particle.
+static void Simulate(std::vector<Particle>& particles, std::vector<Quad>& quads){
+  const float dt = 1.0f / SUBSTEPS;
+  for(int step = 0; step < SUBSTEPS; ++step){
+    for(Particle& p : particles){
+      float distance = std::sqrt(p.position[0] * p.position[0] + p.position[1] * p.position[1]) + 0.05f;
+      float pull = 0.00002f / (distance * distance);
+      p.velocity[0] -= p.position[0] / distance * pull * dt;
+      p.velocity[1] -= p.position[1] / distance * pull * dt;
+      for(int axis = 0; axis < 2; ++axis){
+        p.position[axis] += p.velocity[axis] * dt;
+        if(p.position[axis] > 1.0f || p.position[axis] < -1.0f){
+          p.velocity[axis] = -p.velocity[axis];
+          p.position[axis] = p.position[axis] > 0.0f ? 1.0f : -1.0f;
+        }
+      }
+    }
+  }
+
+  quads.resize(particles.size());
+  for(size_t i = 0; i < particles.size(); ++i){
+    const Particle& p = particles[i];
+    Quad& quad = quads[i];
+    quad = Quad();
+    quad.position[0] = p.position[0];
+    quad.position[1] = p.position[1];
+    quad.size[0] = quad.size[1] = 0.01f;
+    quad.rotation = std::atan2(p.velocity[1], p.velocity[0]);
+    float speed = std::sqrt(p.velocity[0] * p.velocity[0] + p.velocity[1] * p.velocity[1]) * 200.0f;
+    quad.color[0] = static_cast<unsigned char>(speed > 1.0f ? 255 : speed * 255);
+    quad.color[1] = 120;
+    quad.color[2] = static_cast<unsigned char>(255 - quad.color[0]);
+  }
+}
+
+static void Draw(QuadBatch& batch, const std::vector<Quad>& quads){
+  GLCall(glClear(GL_COLOR_BUFFER_BIT));
+  for(const Quad& quad : quads){
+    batch.Submit(quad);
+  }
+  batch.EndFrame();
+}
+
+int main(){
+  BenchContext context;
+  if(!context.IsValid()){
+    return -1;
+  }
+  GLFWwindow* window = context.GetWindow();
+
+  //* Simulation alone, for reference.
+  double simulateMs = 0.0;
+  {
+    std::vector<Particle> particles = MakeParticles();
+    std::vector<Quad> quads;
+    double start = BenchNow();
+    for(int frame = 0; frame < FRAMES; ++frame){
+      Simulate(particles, quads);
+    }
+    simulateMs = (BenchNow() - start) / FRAMES;
+  }
+
+  unsigned long long singleChecksum = 0;
+  double singleMs = 0.0;
+  {
+    QuadBatch batch(PARTICLES);
+    std::vector<Particle> particles = MakeParticles();
+    std::vector<Quad> quads;
+    double start = BenchNow();
+    for(int frame = 0; frame < FRAMES; ++frame){
+      Simulate(particles, quads);
+      Draw(batch, quads);
+      glFinish();
+      //* Read before the swap, the back buffer is undefined after it.
+      if(frame == FRAMES - 1){
+        singleChecksum = BenchChecksum(context.GetWidth(), context.GetHeight());
+      }
+      glfwSwapBuffers(window);
+    }
+    singleMs = (BenchNow() - start) / FRAMES;
+  }
+
+  unsigned long long threadedChecksum = 0;
+  double threadedMs = 0.0;
+  double renderMs = 0.0;
+  double idleMs = 0.0;
+  {
+    RenderThread renderThread(window);
+    TripleBuffer<ParticlePacket> packets;
+    std::unique_ptr<QuadBatch> batch;
+    //* Only touched on the render thread.
+    int drawn = 0;
+    renderThread.Start(
+      [&](){ batch = std::make_unique<QuadBatch>(PARTICLES); },
+      [&](){
+        packets.Acquire();
+        Draw(*batch, packets.GetReadBuffer().quads);
+        glFinish();
+        //* The loop swaps right after this returns, so the last frame is read here and not at shutdown.
+        if(++drawn == FRAMES){
+          threadedChecksum = BenchChecksum(context.GetWidth(), context.GetHeight());
+        }
+      },
+      [&](){ batch.reset(); });
+
+    std::vector<Particle> particles = MakeParticles();
+    double start = BenchNow();
+    for(int frame = 0; frame < FRAMES; ++frame){
+      Simulate(particles, packets.GetWriteBuffer().quads);
+      renderThread.WaitForRender();
+      packets.Publish();
+      renderThread.Kick();
+    }
+    renderThread.WaitForRender();
+    threadedMs = (BenchNow() - start) / FRAMES;
+    renderThread.Stop();
+    const RenderThreadStats& stats = renderThread.GetStats();
+    double drawnFrames = stats.frames ? static_cast<double>(stats.frames) : 1.0;
+    renderMs = stats.renderMs / drawnFrames;
+    idleMs = stats.idleMs / drawnFrames;
+  }
+
+  std::cout << PARTICLES << " particles, " << FRAMES << " frames, " << std::thread::hardware_concurrency() << " cores\n";
+  std::cout << "simulation alone: " << simulateMs << " ms/frame\n";
+  std::cout << "one thread:       " << singleMs << " ms/frame\n";
+  std::cout << "render thread:    " << threadedMs << " ms/frame (render thread " << renderMs << " ms drawing, " << idleMs
+    << " ms waiting per frame)\n";
+  std::cout << "Frame time down " << (1.0 - threadedMs / singleMs) * 100.0 << "%\n";
+  std::cout << "Same last frame: " << (singleChecksum == threadedChecksum ? "yes" : "NO") << '\n';
+  return 0;
+}
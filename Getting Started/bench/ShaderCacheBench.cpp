@@ -0,0 +1,99 @@
+#include "BenchContext.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../src/Shader.h"
+#include "../src/ProgramBinaryCache.h"
+
+/*
+Startup cost of PROGRAMS shaders, cold (empty ProgramBinaryCache, everything compiled and linked from
+source and then stored) and warm (every program loaded back with glProgramBinary).
+The shaders are generated into bench_shaders/ so each one has a different source and its own cache entry.
+Drivers keep their own shader caches too (Mesa: MESA_SHADER_CACHE_DISABLE=true turns it off), with one of
+those on the cold numbers are already partly warm.
+*/
+
+static const int PROGRAMS = 100;
+static const char* SHADER_DIRECTORY = "bench_shaders";
+static const char* CACHE_DIRECTORY = "bench_shader_cache";
+
+static void WriteFile(const std::string& path, const std::string& text){
+  std::ofstream file(path, std::ios::trunc);
+  file << text;
+}
+
+//* Enough math in the fragment shader that compiling it costs something.
+static void WriteVariant(int i){
+  std::string index = std::to_string(i);
+  WriteFile(std::string(SHADER_DIRECTORY) + "/" + index + ".vert",
+    "#version 330 core\n"
+    "layout(location = 0) in vec4 position;\n"
+    "void main(){\n"
+    "  gl_Position = position * " + std::to_string(1.0 + i * 0.001) + ";\n"
+    "}\n");
+  WriteFile(std::string(SHADER_DIRECTORY) + "/" + index + ".frag",
+    "#version 330 core\n"
+    "layout(location = 0) out vec4 color;\n"
+    "uniform vec4 u_Color;\n"
+    "void main(){\n"
+    "  vec4 c = u_Color;\n"
+    "  for(int i = 0; i < " + std::to_string(8 + i % 8) + "; ++i){\n"
+    "    c = fract(sin(c * 12.9898 + float(i) * " + index + ".0) * 43758.5453);\n"
+    "    c.xy = mat2(cos(c.z), -sin(c.z), sin(c.z), cos(c.z)) * c.xy;\n"
+    "  }\n"
+    "  color = c;\n"
+    "}\n");
+}
+
+static double CreateAll(){
+  std::vector<Shader> shaders;
+  shaders.reserve(PROGRAMS);
+  double start = BenchNow();
+  for(int i = 0; i < PROGRAMS; ++i){
+    std::string base = std::string(SHADER_DIRECTORY) + "/" + std::to_string(i);
+    shaders.emplace_back(base + ".vert", base + ".frag");
+  }
+  //* Make sure the driver actually finished, some link lazily on first use.
+  glFinish();
+  return BenchNow() - start;
+}
+
+int main(){
+  BenchContext context;
+  if(!context.IsValid()){
+    return -1;
+  }
+  if(!ProgramBinaryCache::IsSupported()){
+    std::cout << "No program binary formats on this driver, warm startup would be the same as cold\n";
+  }
+
+  std::filesystem::create_directories(SHADER_DIRECTORY);
+  for(int i = 0; i < PROGRAMS; ++i){
+    WriteVariant(i);
+  }
+  ProgramBinaryCache::SetDirectory(CACHE_DIRECTORY);
+  ProgramBinaryCache::Clear();
+
+  double cold = CreateAll();
+  ProgramBinaryCacheStats coldStats = ProgramBinaryCache::GetStats();
+  ProgramBinaryCache::ResetStats();
+  DeletionQueue::Flush();
+
+  double warm = CreateAll();
+  ProgramBinaryCacheStats warmStats = ProgramBinaryCache::GetStats();
+
+  std::cout << PROGRAMS << " programs\n";
+  std::cout << "cold: " << cold << " ms (" << coldStats.misses << " misses, " << coldStats.stored << " stored)\n";
+  std::cout << "warm: " << warm << " ms (" << warmStats.hits << " hits, " << warmStats.rejected << " rejected)\n";
+  if(warm > 0.0){
+    std::cout << "speedup: " << cold / warm << "x\n";
+  }
+
+  std::error_code error;
+  std::filesystem::remove_all(SHADER_DIRECTORY, error);
+  std::filesystem::remove_all(CACHE_DIRECTORY, error);
+  return 0;
+}
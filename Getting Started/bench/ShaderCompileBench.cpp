@@ -0,0 +1,112 @@
+#include "BenchContext.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../src/ShaderCompiler.h"
+#include "../src/ProgramBinaryCache.h"
+
+/*
+PROGRAMS generated programs built two ways:
+  blocking   every program compiled and linked before the call returns, like Shader's normal constructor
+  async      ShaderCompiler::SubmitBatch, then a render loop that only calls Poll until everything is ready
+For async it reports how long the submit blocked, the longest frame while compiling, and how long until
+the last program was ready. The two runs use different sources so the driver can't reuse the first run's work.
+The program binary cache points at a scratch directory that gets wiped, so every program is a real compile.
+*/
+
+static const int PROGRAMS = 64;
+static const char* CACHE_DIRECTORY = "bench_compile_cache";
+
+static ProgramSource MakeVariant(int seed){
+  std::string index = std::to_string(seed);
+  ProgramSource source;
+  source.vertex =
+    "#version 330 core\n"
+    "layout(location = 0) in vec4 position;\n"
+    "void main(){\n"
+    "  gl_Position = position * " + std::to_string(1.0 + seed * 0.001) + ";\n"
+    "}\n";
+  source.fragment =
+    "#version 330 core\n"
+    "layout(location = 0) out vec4 color;\n"
+    "uniform vec4 u_Color;\n"
+    "void main(){\n"
+    "  vec4 c = u_Color;\n"
+    "  for(int i = 0; i < " + std::to_string(8 + seed % 8) + "; ++i){\n"
+    "    c = fract(sin(c * 12.9898 + float(i) * " + index + ".0) * 43758.5453);\n"
+    "    c.xy = mat2(cos(c.z), -sin(c.z), sin(c.z), cos(c.z)) * c.xy;\n"
+    "  }\n"
+    "  color = c;\n"
+    "}\n";
+  return source;
+}
+
+static std::vector<ProgramSource> MakeVariants(int first){
+  std::vector<ProgramSource> sources;
+  for(int i = 0; i < PROGRAMS; ++i){
+    sources.push_back(MakeVariant(first + i));
+  }
+  return sources;
+}
+
+static void ReleaseAll(const std::vector<unsigned int>& programs){
+  for(unsigned int program : programs){
+    ShaderCompiler::Release(program);
+  }
+  DeletionQueue::Flush();
+}
+
+int main(){
+  BenchContext context;
+  if(!context.IsValid()){
+    return -1;
+  }
+  ProgramBinaryCache::SetDirectory(CACHE_DIRECTORY);
+  ProgramBinaryCache::Clear();
+
+  //* Before Init the compiler is synchronous.
+  std::vector<ProgramSource> sources = MakeVariants(0);
+  std::vector<unsigned int> programs(PROGRAMS);
+  double start = BenchNow();
+  ShaderCompiler::SubmitBatch(sources.data(), PROGRAMS, programs.data());
+  double blocking = BenchNow() - start;
+  ReleaseAll(programs);
+
+  ShaderCompiler::Init(context.GetWindow());
+  sources = MakeVariants(PROGRAMS);
+  start = BenchNow();
+  ShaderCompiler::SubmitBatch(sources.data(), PROGRAMS, programs.data());
+  double submit = BenchNow() - start;
+
+  //* Stand in for the render loop: the frames keep coming while the programs finish.
+  int frames = 0;
+  double longestFrame = 0.0;
+  while(ShaderCompiler::GetPendingCount() > 0){
+    double frameStart = BenchNow();
+    glClear(GL_COLOR_BUFFER_BIT);
+    ShaderCompiler::Poll();
+    glfwSwapBuffers(context.GetWindow());
+    double frame = BenchNow() - frameStart;
+    longestFrame = frame > longestFrame ? frame : longestFrame;
+    ++frames;
+  }
+  double allReady = BenchNow() - start;
+
+  unsigned int failed = 0;
+  for(unsigned int program : programs){
+    failed += ShaderCompiler::GetStatus(program) == ProgramStatus::Failed;
+  }
+
+  std::cout << PROGRAMS << " programs, async backend: " << ShaderCompiler::GetBackendName() << '\n';
+  std::cout << "blocking: " << blocking << " ms with the thread stalled the whole time\n";
+  std::cout << "async:    " << submit << " ms to submit, " << allReady << " ms until all ready, "
+    << frames << " frames drawn meanwhile, longest " << longestFrame << " ms (" << failed << " failed)\n";
+
+  ReleaseAll(programs);
+  ShaderCompiler::Shutdown();
+  std::error_code error;
+  std::filesystem::remove_all(CACHE_DIRECTORY, error);
+  return 0;
+}
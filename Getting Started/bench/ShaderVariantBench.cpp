@@ -0,0 +1,108 @@
+#include "BenchContext.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../src/renderer.h"
+#include "../src/VertexArray.h"
+#include "../src/IndexBuffer.h"
+#include "../src/ShaderVariants.h"
+#include "../src/ShaderCompiler.h"
+#include "../src/ProgramBinaryCache.h"
+
+/*
+Every frame draws one quad for each of the 16 keys of variant.frag's four features, the worst case of a
+scene where every combination shows up at once. Run twice:
+  on demand    before ShaderCompiler::Init, so the first Bind of each key compiles it right there
+  background   after Init, keys draw with the uber shader until their variant is ready
+Reports the longest frame and how many frames it took until every key drew specialized.
+The program binary cache points at a wiped scratch directory and the second run lists the features in a
+different order, so neither run gets its programs for free. Run with MESA_SHADER_CACHE_DISABLE=true on Mesa.
+*/
+
+static const unsigned int KEYS = 16;
+static const int MAX_FRAMES = 5000;
+static const char* CACHE_DIRECTORY = "bench_variant_cache";
+
+struct RunResult {
+  double firstFrame = 0.0;
+  double longestFrame = 0.0;
+  int framesUntilSpecialized = 0;
+  ShaderVariantStats stats;
+};
+
+static RunResult Run(GLFWwindow* window, const std::vector<std::string>& features, const VertexArray& va, const IndexBuffer& ib){
+  ShaderVariants variants("res/shaders/vertex.vert", "res/shaders/variant.frag", features);
+  ShaderVariants::ResetStats();
+  RunResult result;
+  for(int frame = 0; frame < MAX_FRAMES; ++frame){
+    double start = BenchNow();
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+    unsigned int specialized = ShaderVariants::GetStats().hits;
+    for(unsigned int key = 0; key < KEYS; ++key){
+      Shader& shader = variants.Bind(key);
+      shader.SetUniform4f("u_Color", key / 16.0f, 0.9f, 0.5f, 1.0f);
+      va.Bind();
+      ib.Bind();
+      GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+    }
+    ShaderCompiler::Poll();
+    glfwSwapBuffers(window);
+    double elapsed = BenchNow() - start;
+    result.firstFrame = frame == 0 ? elapsed : result.firstFrame;
+    result.longestFrame = elapsed > result.longestFrame ? elapsed : result.longestFrame;
+    if(ShaderVariants::GetStats().hits - specialized == KEYS){
+      result.framesUntilSpecialized = frame;
+      break;
+    }
+  }
+  result.stats = ShaderVariants::GetStats();
+  DeletionQueue::Flush();
+  return result;
+}
+
+static void Print(const char* name, const RunResult& result){
+  std::cout << name << result.longestFrame << " ms longest frame (first " << result.firstFrame << " ms), all specialized after "
+    << result.framesUntilSpecialized << " frames, hit rate " << result.stats.GetHitRate() * 100.0f << "%, "
+    << result.stats.fallbacks << " uber draws, " << result.stats.fallbackMs << " ms summed fallback time\n";
+}
+
+int main(){
+  BenchContext context;
+  if(!context.IsValid()){
+    return -1;
+  }
+  ProgramBinaryCache::SetDirectory(CACHE_DIRECTORY);
+  ProgramBinaryCache::Clear();
+
+  float positions[] = {
+    -0.5f, -0.5f,
+     0.5f, -0.5f,
+     0.5f,  0.5f,
+    -0.5f,  0.5f,
+  };
+  unsigned int indices[]{
+    0, 1, 2,
+    3, 2, 0
+  };
+  VertexArray va;
+  VertexBuffer vb(positions, sizeof(positions));
+  VertexBufferLayout layout;
+  layout.Push<float>(2);
+  va.AddBuffer(vb, layout);
+  IndexBuffer ib(indices, 6);
+
+  RunResult onDemand = Run(context.GetWindow(), { "FEATURE_INVERT", "FEATURE_GRAYSCALE", "FEATURE_CHECKER", "FEATURE_BANDS" }, va, ib);
+  ShaderCompiler::Init(context.GetWindow());
+  RunResult background = Run(context.GetWindow(), { "FEATURE_BANDS", "FEATURE_CHECKER", "FEATURE_GRAYSCALE", "FEATURE_INVERT" }, va, ib);
+
+  std::cout << KEYS << " variants drawn every frame, background backend: " << ShaderCompiler::GetBackendName() << '\n';
+  Print("on demand:  ", onDemand);
+  Print("background: ", background);
+
+  ShaderCompiler::Shutdown();
+  std::error_code error;
+  std::filesystem::remove_all(CACHE_DIRECTORY, error);
+  return 0;
+}
@@ -0,0 +1,76 @@
+#include "BenchContext.h"
+
+#include <vector>
+
+#include "../src/renderer.h"
+#include "../src/VertexArray.h"
+#include "../src/Shader.h"
+#include "../src/StreamBuffer.h"
+
+/*
+Streams REGION_SIZE bytes of vertex data every frame through each StreamBuffer backend and draws it as points,
+so the GPU actually reads what we wrote and the fences have something to wait on.
+Reports upload throughput and how long the CPU spent stalled on fences / map calls.
+*/
+
+static const int FRAMES = 300;
+static const unsigned int REGION_SIZE = 4 * 1024 * 1024;
+static const unsigned int CHUNK_SIZE = 64 * 1024;
+static const unsigned int STRIDE = 2 * sizeof(float);
+
+static void Run(StreamBufferBackend backend, Shader& shader, const std::vector<float>& source){
+  VertexArray va;
+  StreamBuffer sb(GL_ARRAY_BUFFER, REGION_SIZE, 3, backend);
+  if(sb.GetBackend() != backend){
+    std::cout << StreamBuffer::GetBackendName(backend) << ": not available on this context\n";
+    return;
+  }
+  VertexBufferLayout layout;
+  layout.Push<float>(2);
+  va.AddBuffer(sb, layout);
+
+  shader.Bind();
+  va.Bind();
+
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(source.data());
+  double start = BenchNow();
+  for(int frame = 0; frame < FRAMES; ++frame){
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+    for(unsigned int written = 0; written + CHUNK_SIZE <= REGION_SIZE; written += CHUNK_SIZE){
+      unsigned int offset = sb.Write(bytes + written, CHUNK_SIZE, STRIDE);
+      if(offset == 0xFFFFFFFF){
+        break;
+      }
+      GLCall(glDrawArrays(GL_POINTS, offset / STRIDE, CHUNK_SIZE / STRIDE));
+    }
+    sb.EndFrame();
+    glfwSwapBuffers(glfwGetCurrentContext());
+  }
+  glFinish();
+  double elapsed = BenchNow() - start;
+
+  const StreamBufferStats& stats = sb.GetStats();
+  double mb = stats.bytesWritten / (1024.0 * 1024.0);
+  std::cout << StreamBuffer::GetBackendName(backend) << ": " << mb / (elapsed / 1000.0) << " MB/s, "
+            << stats.stallMs << " ms stalled (" << stats.fenceWaits << " fence waits) over " << mb << " MB\n";
+}
+
+int main(){
+  BenchContext context;
+  if(!context.IsValid()){
+    return -1;
+  }
+  Shader shader("res/shaders/vertex.vert", "res/shaders/fragment.frag");
+  shader.Bind();
+  shader.SetUniform4f("u_Color", 0.8f, 0.2f, 0.5f, 1.0f);
+
+  std::vector<float> source(REGION_SIZE / sizeof(float));
+  for(size_t i = 0; i < source.size(); ++i){
+    source[i] = ((i * 7919) % 2000) / 1000.0f - 1.0f;
+  }
+
+  Run(StreamBufferBackend::PersistentMapped, shader, source);
+  Run(StreamBufferBackend::Unsynchronized, shader, source);
+  Run(StreamBufferBackend::Orphaning, shader, source);
+  return 0;
+}
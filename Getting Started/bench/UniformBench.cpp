@@ -0,0 +1,128 @@
+#include "BenchContext.h"
+
+#include <vector>
+
+#include "../src/renderer.h"
+#include "../src/VertexArray.h"
+#include "../src/IndexBuffer.h"
+#include "../src/Shader.h"
+
+/*
+The cost of setting one vec4 uniform, SETS times in a row on a bound program:
+  name     SetUniform4f("u_Color", ...), a std::string built from the literal and a hash lookup per call
+  handle   SetUniform4f(handle, ...) with the handle resolved once up front
+  raw      glUniform4f on a location we looked up ourselves, the floor for both
+Nothing is drawn, so the numbers are the CPU side of the set plus whatever the driver does with glUniform4f.
+
+Then a frame of DRAWS quads sharing one program, where the color only changes every RUN draws (objects sorted
+by material). Each draw sets u_Color and calls Renderer::Draw, with the shader in Immediate and Deferred upload
+mode, and once with a raw glUniform4f per draw for comparison. Reports CPU ms per frame and the upload counters.
+*/
+
+static const int ROUNDS = 20;
+static const int SETS = 100000;
+static const int FRAMES = 100;
+static const int DRAWS = 2000;
+static const int RUN = 64;
+
+template<typename SetMany>
+static double TimeSets(SetMany set){
+  double best = 1e30;
+  for(int round = 0; round < ROUNDS; ++round){
+    double start = BenchNow();
+    set();
+    double elapsed = BenchNow() - start;
+    best = elapsed < best ? elapsed : best;
+  }
+  return best * 1e6 / SETS;
+}
+
+int main(){
+  BenchContext context;
+  if(!context.IsValid()){
+    return -1;
+  }
+
+  Shader shader("res/shaders/vertex.vert", "res/shaders/fragment.frag");
+  shader.Bind();
+  UniformHandle u_Color = shader.GetUniform("u_Color");
+  GLint program = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+  GLint location = glGetUniformLocation(program, "u_Color");
+
+  double name = TimeSets([&]{
+    for(int i = 0; i < SETS; ++i){
+      shader.SetUniform4f("u_Color", i * 1e-6f, 0.9f, 0.5f, 1.0f);
+    }
+  });
+  double handle = TimeSets([&]{
+    for(int i = 0; i < SETS; ++i){
+      shader.SetUniform4f(u_Color, i * 1e-6f, 0.9f, 0.5f, 1.0f);
+    }
+  });
+  double rawSet = TimeSets([&]{
+    for(int i = 0; i < SETS; ++i){
+      glUniform4f(location, i * 1e-6f, 0.9f, 0.5f, 1.0f);
+    }
+  });
+
+  float positions[] = {
+    -0.1f, -0.1f,
+     0.1f, -0.1f,
+     0.1f,  0.1f,
+    -0.1f,  0.1f,
+  };
+  unsigned int indices[]{
+    0, 1, 2,
+    3, 2, 0
+  };
+  VertexArray va;
+  VertexBuffer vb(positions, sizeof(positions));
+  VertexBufferLayout layout;
+  layout.Push<float>(2);
+  va.AddBuffer(vb, layout);
+  IndexBuffer ib(indices, 6);
+  Renderer renderer;
+  std::vector<float> colors(DRAWS);
+  for(int i = 0; i < DRAWS; ++i){
+    colors[i] = (i / RUN % 8) / 8.0f;
+  }
+
+  double raw = TimeFrames(FRAMES, [&](int){
+    for(int i = 0; i < DRAWS; ++i){
+      shader.Bind();
+      glUniform4f(location, colors[i], 0.9f, 0.5f, 1.0f);
+      va.Bind();
+      ib.Bind();
+      GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+    }
+  });
+  UniformUploadStats perFrame[2];
+  double shadowed[2];
+  UniformUploadMode modes[2] = { UniformUploadMode::Immediate, UniformUploadMode::Deferred };
+  for(int m = 0; m < 2; ++m){
+    shader.SetUploadMode(modes[m]);
+    //* The loops above went around the shadow.
+    shader.InvalidateUniforms();
+    Shader::ResetUploadStats();
+    shadowed[m] = TimeFrames(FRAMES, [&](int){
+      for(int i = 0; i < DRAWS; ++i){
+        shader.SetUniform4f(u_Color, colors[i], 0.9f, 0.5f, 1.0f);
+        renderer.Draw(va, ib, shader);
+      }
+    });
+    perFrame[m] = Shader::GetUploadStats();
+  }
+
+  std::cout << SETS << " sets/round, best of " << ROUNDS << ", " << shader.GetUniforms().size() << " active uniforms\n";
+  std::cout << "name:   " << name << " ns/set\n";
+  std::cout << "handle: " << handle << " ns/set\n";
+  std::cout << "raw:    " << rawSet << " ns/set\n\n";
+  std::cout << DRAWS << " draws/frame, color changes every " << RUN << " draws\n";
+  std::cout << "raw glUniform4f: " << raw << " ms/frame CPU\n";
+  for(int m = 0; m < 2; ++m){
+    std::cout << (m == 0 ? "immediate:       " : "deferred:        ") << shadowed[m] << " ms/frame CPU, per frame "
+      << perFrame[m].uploads / FRAMES << " uploads, " << perFrame[m].skips / FRAMES << " skipped, " << perFrame[m].merged / FRAMES << " merged\n";
+  }
+  return 0;
+}
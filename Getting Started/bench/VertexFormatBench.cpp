@@ -0,0 +1,115 @@
+#include "BenchContext.h"
+
+#include <vector>
+
+#include "../src/renderer.h"
+#include "../src/GLState.h"
+#include "../src/VertexArray.h"
+#include "../src/IndexBuffer.h"
+#include "../src/BufferHeap.h"
+#include "../src/VertexFormatCache.h"
+#include "../src/Shader.h"
+
+/*
+CPU cost of switching between many meshes that all share one vertex layout:
+  per mesh VAO      every mesh has its own VertexBuffer + VertexArray (what AddBuffer gives you)
+  format, own VBOs  one cached VAO, every mesh still has its own VBO -> glBindVertexBuffer per draw
+  format, heap      one cached VAO, every mesh lives in one BufferHeap block -> no switches at all
+Also prints how many VAOs each way needs. Without ARB_vertex_attrib_binding the cache falls back to
+one VAO per buffer, so the middle case ends up like the first one.
+*/
+
+static const int FRAMES = 100;
+static const int MESHES = 4000;
+
+struct QuadVertex {
+  float position[2];
+};
+VERTEX_LAYOUT(QuadVertex, VERTEX_ATTRIB(QuadVertex, position));
+
+static void Report(const char* name, double ms, unsigned int vertexArrays){
+  const GLStateStats& stats = GLState::GetStats();
+  std::cout << name << ms << " ms/frame CPU, " << vertexArrays << " VAOs, "
+    << stats.vertexArrayBinds / FRAMES << " VAO binds + " << stats.bufferBinds / FRAMES << " buffer binds per frame\n";
+  GLState::ResetStats();
+}
+
+int main(){
+  BenchContext context;
+  if(!context.IsValid()){
+    return -1;
+  }
+
+  //* Tiny quads scattered over the screen, so the GPU side stays cheap and the submission cost shows.
+  std::vector<QuadVertex> vertices(MESHES * 4);
+  for(int i = 0; i < MESHES; ++i){
+    float x = (i % 64) / 32.0f - 1.0f;
+    float y = (i / 64 % 64) / 32.0f - 1.0f;
+    float size = 1.0f / 64.0f;
+    vertices[i * 4 + 0] = { { x, y } };
+    vertices[i * 4 + 1] = { { x + size, y } };
+    vertices[i * 4 + 2] = { { x + size, y + size } };
+    vertices[i * 4 + 3] = { { x, y + size } };
+  }
+  unsigned int indices[]{ 0, 1, 2, 3, 2, 0 };
+
+  Shader shader("res/shaders/vertex.vert", "res/shaders/fragment.frag");
+  shader.Bind();
+  shader.SetUniform4f("u_Color", 0.8f, 0.2f, 0.5f, 1.0f);
+  Renderer renderer;
+
+  IndexBuffer ib(indices, 6);
+  std::vector<VertexBuffer> buffers;
+  std::vector<VertexArray> arrays;
+  buffers.reserve(MESHES);
+  arrays.reserve(MESHES);
+  for(int i = 0; i < MESHES; ++i){
+    buffers.emplace_back(&vertices[i * 4], 4 * sizeof(QuadVertex));
+    arrays.emplace_back();
+    arrays.back().AddBuffer<QuadVertex>(buffers.back());
+  }
+
+  BufferHeap vertexHeap(GL_ARRAY_BUFFER, 1024 * 1024, sizeof(QuadVertex));
+  BufferHeap indexHeap(GL_ELEMENT_ARRAY_BUFFER, 1024 * 1024, 4);
+  std::vector<HeapMesh> meshes(MESHES);
+  for(int i = 0; i < MESHES; ++i){
+    meshes[i].vertices = vertexHeap.Allocate(4 * sizeof(QuadVertex), &vertices[i * 4]);
+    meshes[i].indices = indexHeap.Allocate(sizeof(indices), indices);
+    meshes[i].indexCount = 6;
+    meshes[i].vertexStride = sizeof(QuadVertex);
+  }
+  VertexFormat format = VertexFormatCache::GetFormat<QuadVertex>();
+
+  GLState::ResetStats();
+  double perMesh = TimeFrames(FRAMES, [&](int){
+    glClear(GL_COLOR_BUFFER_BIT);
+    for(int i = 0; i < MESHES; ++i){
+      renderer.Draw(arrays[i], ib, shader);
+    }
+  });
+  Report("per mesh VAO:     ", perMesh, MESHES);
+
+  double ownBuffers = TimeFrames(FRAMES, [&](int){
+    glClear(GL_COLOR_BUFFER_BIT);
+    for(int i = 0; i < MESHES; ++i){
+      VertexFormatCache::Bind(format, buffers[i].GetRendererId());
+      ib.Bind();
+      GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+    }
+  });
+  Report("format, own VBOs: ", ownBuffers, VertexFormatCache::GetVertexArrayCount());
+
+  double heap = TimeFrames(FRAMES, [&](int){
+    glClear(GL_COLOR_BUFFER_BIT);
+    for(const HeapMesh& mesh : meshes){
+      renderer.Draw(format, mesh, shader);
+    }
+  });
+  Report("format, heap:     ", heap, VertexFormatCache::GetVertexArrayCount());
+
+  std::cout << MESHES << " meshes, " << FRAMES << " frames, "
+    << (VertexFormatCache::UsesAttribBinding() ? "ARB_vertex_attrib_binding" : "3.3 fallback") << '\n';
+
+  VertexFormatCache::Clear();
+  return 0;
+}
@@ -0,0 +1,24 @@
+#version 330 core
+
+layout(location = 0) in vec4 position;
+
+//* Written once a frame, the same binding in every program that declares it.
+layout(std140) uniform FrameConstants {
+    vec4 u_Tint;
+    float u_Time;
+};
+
+//* One range of the uniform ring per draw.
+layout(std140) uniform DrawConstants {
+    vec4 u_Offset;
+    vec4 u_Color;
+};
+
+out vec4 v_Color;
+
+#include "shade.glsl"
+
+void main(){
+    gl_Position = vec4(position.xy + u_Offset.xy, 0.0, 1.0);
+    v_Color = Shade(u_Color, u_Tint, u_Time);
+}
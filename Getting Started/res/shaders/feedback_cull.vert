@@ -0,0 +1,13 @@
+#version 330 core
+
+//* InstanceCuller's cull pass: one point per instance, the geometry shader decides which ones get captured.
+layout(location = 0) in vec4 placement;
+layout(location = 1) in vec4 color;
+
+out vec4 v_Placement;
+out vec4 v_Color;
+
+void main(){
+    v_Placement = placement;
+    v_Color = color;
+}
@@ -0,0 +1,19 @@
+#version 330 core
+
+//* Draws what InstanceCuller kept. A slot it zeroed has scale 0, so every vertex lands on the origin and
+//* the triangles have no area.
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec4 color;
+layout(location = 2) in vec4 placement;
+layout(location = 3) in vec4 instanceColor;
+
+layout(std140) uniform CameraConstants {
+    mat4 u_ViewProjection;
+};
+
+out vec4 v_Color;
+
+void main(){
+    gl_Position = u_ViewProjection * vec4(position * placement.w + placement.xyz, 1.0);
+    v_Color = color * instanceColor;
+}
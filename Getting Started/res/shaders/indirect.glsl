@@ -0,0 +1,14 @@
+//* IndirectObject in IndirectRenderer.h, std430 so the C++ struct is copied in as it is.
+struct IndirectObject {
+    mat4 transform;
+    vec4 bounds;
+    uint mesh;
+    uint pad0;
+    uint pad1;
+    uint pad2;
+};
+
+//* Binding 0 in both stages, see OBJECTS_BINDING in IndirectRenderer.cpp.
+layout(std430, binding = 0) readonly buffer Objects {
+    IndirectObject objects[];
+};
@@ -0,0 +1,19 @@
+#version 430 core
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec4 color;
+//* Added by IndirectRenderer::AddObjectIndex after the mesh's attributes. The draw's baseInstance makes it the object's index.
+layout(location = 2) in uint objectIndex;
+
+#include "indirect.glsl"
+
+layout(std140) uniform CameraConstants {
+    mat4 u_ViewProjection;
+};
+
+out vec4 v_Color;
+
+void main(){
+    gl_Position = u_ViewProjection * objects[objectIndex].transform * vec4(position, 1.0);
+    v_Color = color;
+}
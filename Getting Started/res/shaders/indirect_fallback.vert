@@ -0,0 +1,20 @@
+#version 330 core
+
+//* IndirectRenderer's CPU path: no storage buffers, the transform comes in a uniform block range per draw.
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec4 color;
+
+layout(std140) uniform CameraConstants {
+    mat4 u_ViewProjection;
+};
+
+layout(std140) uniform ObjectConstants {
+    mat4 u_Transform;
+};
+
+out vec4 v_Color;
+
+void main(){
+    gl_Position = u_ViewProjection * u_Transform * vec4(position, 1.0);
+    v_Color = color;
+}
@@ -0,0 +1,11 @@
+#version 330 core 
+
+layout(location = 0) in vec4 position;
+//* One per instance (divisor 1), where this copy of the mesh goes.
+layout(location = 1) in vec2 offset;
+
+uniform float u_Scale;
+
+void main(){
+    gl_Position = vec4(position.xy * u_Scale + offset, 0.0, 1.0);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+
+layout(location = 0) in vec4 position;
+
+//* The same inputs as constants.vert as plain uniforms, one glUniform call each.
+uniform vec4 u_Tint;
+uniform float u_Time;
+uniform vec4 u_Offset;
+uniform vec4 u_Color;
+
+out vec4 v_Color;
+
+#include "shade.glsl"
+
+void main(){
+    gl_Position = vec4(position.xy + u_Offset.xy, 0.0, 1.0);
+    v_Color = Shade(u_Color, u_Tint, u_Time);
+}
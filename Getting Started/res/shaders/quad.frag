@@ -0,0 +1,50 @@
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_UV;
+in vec4 v_Color;
+flat in uint v_Slot;
+
+//* One sampler per unit QuadBatch binds. 3.30 only indexes sampler arrays with constants, so they're picked with a switch.
+uniform sampler2D u_Texture0;
+uniform sampler2D u_Texture1;
+uniform sampler2D u_Texture2;
+uniform sampler2D u_Texture3;
+uniform sampler2D u_Texture4;
+uniform sampler2D u_Texture5;
+uniform sampler2D u_Texture6;
+uniform sampler2D u_Texture7;
+uniform sampler2D u_Texture8;
+uniform sampler2D u_Texture9;
+uniform sampler2D u_Texture10;
+uniform sampler2D u_Texture11;
+uniform sampler2D u_Texture12;
+uniform sampler2D u_Texture13;
+uniform sampler2D u_Texture14;
+uniform sampler2D u_Texture15;
+
+vec4 SampleSlot(uint slot, vec2 uv){
+    switch(slot){
+        case 0u: return texture(u_Texture0, uv);
+        case 1u: return texture(u_Texture1, uv);
+        case 2u: return texture(u_Texture2, uv);
+        case 3u: return texture(u_Texture3, uv);
+        case 4u: return texture(u_Texture4, uv);
+        case 5u: return texture(u_Texture5, uv);
+        case 6u: return texture(u_Texture6, uv);
+        case 7u: return texture(u_Texture7, uv);
+        case 8u: return texture(u_Texture8, uv);
+        case 9u: return texture(u_Texture9, uv);
+        case 10u: return texture(u_Texture10, uv);
+        case 11u: return texture(u_Texture11, uv);
+        case 12u: return texture(u_Texture12, uv);
+        case 13u: return texture(u_Texture13, uv);
+        case 14u: return texture(u_Texture14, uv);
+        default: return texture(u_Texture15, uv);
+    }
+}
+
+void main(){
+    color = v_Color * SampleSlot(v_Slot, v_UV);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+
+//* BatchVertex in QuadBatch.h, the corners are already rotated and placed on the CPU.
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 uv;
+layout(location = 2) in vec4 color;
+layout(location = 3) in uint slot;
+
+out vec2 v_UV;
+out vec4 v_Color;
+flat out uint v_Slot;
+
+void main(){
+    gl_Position = vec4(position, 0.0, 1.0);
+    v_UV = uv;
+    v_Color = color;
+    v_Slot = slot;
+}
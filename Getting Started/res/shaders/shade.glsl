@@ -0,0 +1,4 @@
+//* Tint and a slow pulse over time, shared by constants.vert and offset.vert through #include.
+vec4 Shade(vec4 color, vec4 tint, float time){
+    return color * tint * (0.75 + 0.25 * sin(time));
+}
@@ -0,0 +1,11 @@
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+uniform sampler2D u_Texture;
+
+void main(){
+    color = v_Color * texture(u_Texture, vec2(0.5));
+}
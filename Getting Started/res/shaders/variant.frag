@@ -0,0 +1,26 @@
+#version 330 core
+
+#include "variants.glsl"
+
+layout(location = 0) out vec4 color;
+
+uniform vec4 u_Color;
+
+//* Each FEATURE_ is true, false, or a bit test of u_Features, see ShaderVariants.
+void main(){
+    vec4 c = u_Color;
+    if(FEATURE_INVERT){
+        c.rgb = 1.0 - c.rgb;
+    }
+    if(FEATURE_GRAYSCALE){
+        c.rgb = vec3(dot(c.rgb, vec3(0.299, 0.587, 0.114)));
+    }
+    if(FEATURE_CHECKER){
+        vec2 cell = floor(gl_FragCoord.xy / 16.0);
+        c.rgb *= mod(cell.x + cell.y, 2.0) * 0.5 + 0.5;
+    }
+    if(FEATURE_BANDS){
+        c.rgb = floor(c.rgb * 4.0) / 4.0;
+    }
+    color = c;
+}
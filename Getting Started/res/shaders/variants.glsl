@@ -0,0 +1,5 @@
+//* Included by shaders built through ShaderVariants. The uber shader reads its feature bits from here,
+//* specialized variants never declare it, their features are plain true / false.
+#ifdef UBER_SHADER
+uniform int u_Features;
+#endif
@@ -0,0 +1,110 @@
+#include "BufferHeap.h"
+
+#include <iostream>
+
+#include "renderer.h"
+#include "GLState.h"
+#include "ResourceRegistry.h"
+
+BufferHeap::BufferHeap(unsigned int target, unsigned int blockSize, unsigned int granularity)
+  : m_target(target), m_granularity(granularity == 0 ? 1 : granularity) {
+  m_blockSize = blockSize / m_granularity * m_granularity;
+}
+
+BufferHeap::~BufferHeap(){
+  for(const Block& block : m_blocks){
+    ResourceRegistry::Buffers().Destroy(block.handle);
+  }
+}
+
+unsigned int BufferHeap::AddBlock(unsigned int units){
+  BufferHandle handle = ResourceRegistry::Buffers().Create({ m_target, units * m_granularity });
+  unsigned int id = ResourceRegistry::Buffers().GetName(handle);
+  if(id == 0){
+    return OffsetAllocator::NO_SPACE;
+  }
+  //* Storage gets made through the copy write target so an element heap doesn't end up in the bound VAO.
+  GLState::BindBuffer(GL_COPY_WRITE_BUFFER, id);
+  //* Checked by hand instead of through GLCall, which would trap: running out of memory is an answer here, not a bug.
+  GLClearError();
+  GLCallBare(glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(units) * m_granularity, nullptr, GL_STATIC_DRAW));
+  GLenum error = glGetError();
+  if(error != GL_NO_ERROR){
+    std::cout << "BufferHeap: no block of " << static_cast<unsigned long long>(units) * m_granularity << " bytes, GL error " << error << std::endl;
+    ResourceRegistry::Buffers().Destroy(handle);
+    return OffsetAllocator::NO_SPACE;
+  }
+  m_blocks.push_back({ id, handle, OffsetAllocator(units) });
+  return static_cast<unsigned int>(m_blocks.size() - 1);
+}
+
+BufferAllocation BufferHeap::Allocate(unsigned int size, const void* data){
+  unsigned int units = (size + m_granularity - 1) / m_granularity;
+  BufferAllocation allocation;
+
+  for(unsigned int i = 0; i < m_blocks.size(); ++i){
+    OffsetAllocation range = m_blocks[i].allocator.Allocate(units);
+    if(range.offset != OffsetAllocator::NO_SPACE){
+      allocation = { m_blocks[i].rendererId, range.offset * m_granularity, units * m_granularity, i, range.node };
+      break;
+    }
+  }
+
+  if(!allocation.IsValid()){
+    unsigned int blockUnits = m_blockSize / m_granularity;
+    //* A block exactly units big isn't enough, the allocator only hands out regions from a bin at least that size.
+    unsigned int neededUnits = OffsetAllocator::RoundUpToBinSize(units);
+    if(neededUnits == OffsetAllocator::NO_SPACE){
+      return allocation;
+    }
+    unsigned int block = AddBlock(neededUnits > blockUnits ? neededUnits : blockUnits);
+    if(block == OffsetAllocator::NO_SPACE){
+      return allocation;
+    }
+    OffsetAllocation range = m_blocks[block].allocator.Allocate(units);
+    if(range.offset == OffsetAllocator::NO_SPACE){
+      return allocation;
+    }
+    allocation = { m_blocks[block].rendererId, range.offset * m_granularity, units * m_granularity, block, range.node };
+  }
+
+  if(data){
+    Upload(allocation, data, size);
+  }
+  return allocation;
+}
+
+void BufferHeap::Upload(const BufferAllocation& allocation, const void* data, unsigned int size, unsigned int offset){
+  ASSERT(offset + size <= allocation.size);
+  GLState::BindBuffer(GL_COPY_WRITE_BUFFER, allocation.buffer);
+  GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.offset + offset, size, data));
+}
+
+void BufferHeap::Free(BufferAllocation& allocation){
+  if(!allocation.IsValid()){
+    return;
+  }
+  m_blocks[allocation.block].allocator.Free({ allocation.offset / m_granularity, allocation.node });
+  allocation = BufferAllocation();
+}
+
+BufferHeapStats BufferHeap::GetStats() const{
+  BufferHeapStats stats;
+  unsigned long long free = 0;
+  for(const Block& block : m_blocks){
+    OffsetAllocatorStats blockStats = block.allocator.GetStats();
+    stats.capacity += static_cast<unsigned long long>(block.allocator.GetSize()) * m_granularity;
+    free += static_cast<unsigned long long>(blockStats.totalFree) * m_granularity;
+    unsigned long long largest = static_cast<unsigned long long>(blockStats.largestFree) * m_granularity;
+    if(largest > stats.largestFree){
+      stats.largestFree = largest;
+    }
+    stats.allocationCount += blockStats.allocations;
+    stats.freeRegions += blockStats.freeRegions;
+  }
+  stats.blockCount = static_cast<unsigned int>(m_blocks.size());
+  stats.used = stats.capacity - free;
+  stats.occupancy = stats.capacity ? static_cast<float>(stats.used) / stats.capacity : 0.0f;
+  stats.fragmentation = free ? 1.0f - static_cast<float>(stats.largestFree) / free : 0.0f;
+  return stats;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "OffsetAllocator.h"
+#include "ResourceRegistry.h"
+
+//* A piece of one of the heap's GL buffers. offset and size are in bytes.
+struct BufferAllocation {
+  unsigned int buffer = 0;
+  unsigned int offset = 0;
+  unsigned int size = 0;
+  unsigned int block = 0;
+  unsigned int node = OffsetAllocator::NO_SPACE;
+
+  inline bool IsValid() const { return node != OffsetAllocator::NO_SPACE; }
+};
+
+//* A mesh living in a pair of heaps, drawn with Renderer::Draw using base vertex + index offset.
+struct HeapMesh {
+  BufferAllocation vertices;
+  BufferAllocation indices;
+  unsigned int indexCount = 0;
+  //* Use IndexBuffer::PickType / Narrow before uploading to store narrower indices.
+  unsigned int indexType = GL_UNSIGNED_INT;
+  unsigned int vertexStride = 0;
+};
+
+struct BufferHeapStats {
+  unsigned int blockCount = 0;
+  unsigned int allocationCount = 0;
+  unsigned int freeRegions = 0;
+  unsigned long long capacity = 0;
+  unsigned long long used = 0;
+  unsigned long long largestFree = 0;
+  //* used / capacity
+  float occupancy = 0.0f;
+  //* 1 - largestFree / free, 0 means all free space is one region.
+  float fragmentation = 0.0f;
+};
+
+/*
+Hands out pieces of a few big GL buffers instead of one buffer object per mesh, so thousands of meshes share
+a handful of VBOs / IBOs and a single VAO per block.
+Every size and offset is a multiple of the granularity. For vertex heaps make it the vertex stride so
+offset / stride is an exact base vertex, for index heaps the index size is enough.
+When no block has room a new one is created, allocations bigger than a block get a block of their own.
+*/
+class BufferHeap {
+public:
+  BufferHeap(unsigned int target, unsigned int blockSize = 64 * 1024 * 1024, unsigned int granularity = 16);
+  ~BufferHeap();
+  BufferHeap(const BufferHeap&) = delete;
+  BufferHeap& operator=(const BufferHeap&) = delete;
+
+  //* Returns an invalid allocation if GL couldn't give us another block (GL_OUT_OF_MEMORY on glBufferData).
+  BufferAllocation Allocate(unsigned int size, const void* data = nullptr);
+  void Upload(const BufferAllocation& allocation, const void* data, unsigned int size, unsigned int offset = 0);
+  void Free(BufferAllocation& allocation);
+
+  BufferHeapStats GetStats() const;
+  inline unsigned int GetTarget() const { return m_target; }
+  inline unsigned int GetGranularity() const { return m_granularity; }
+  inline unsigned int GetBlockCount() const { return static_cast<unsigned int>(m_blocks.size()); }
+  inline unsigned int GetBuffer(unsigned int block) const { return m_blocks[block].rendererId; }
+private:
+  struct Block {
+    //* Copied out of the registry so handing out allocations doesn't look the name up every time.
+    unsigned int rendererId;
+    BufferHandle handle;
+    //* Sizes are in granules, not bytes.
+    OffsetAllocator allocator;
+  };
+  //* Index of the new block, or OffsetAllocator::NO_SPACE if glBufferData failed.
+  unsigned int AddBlock(unsigned int units);
+
+  unsigned int m_target;
+  unsigned int m_blockSize;
+  unsigned int m_granularity;
+  std::vector<Block> m_blocks;
+};
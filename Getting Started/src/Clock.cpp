@@ -0,0 +1,8 @@
+#include "Clock.h"
+
+#include <chrono>
+
+double Clock::NowMs(){
+  using namespace std::chrono;
+  return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
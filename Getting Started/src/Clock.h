@@ -0,0 +1,8 @@
+#pragma once
+
+//* Wall clock for the stats counters and the benchmarks. steady_clock, so it never jumps backwards.
+class Clock {
+public:
+  //* Milliseconds since some fixed earlier point, only differences between two calls mean anything.
+  static double NowMs();
+};
@@ -0,0 +1,82 @@
+#include "ComputeShader.h"
+
+#include <iostream>
+
+#include "renderer.h"
+#include "GLState.h"
+#include "GLExtensions.h"
+#include "DeletionQueue.h"
+#include "ShaderStages.h"
+#include "UniformBlockBindings.h"
+
+ComputeShader::ComputeShader(const std::string& filepath, const std::vector<ShaderDefine>& defines)
+  : m_FilePath(filepath) {
+  if(!IsSupported()){
+    std::cout << "Compute shaders need GL 4.3 or ARB_compute_shader, not building " << filepath << std::endl;
+    return;
+  }
+  PreprocessedShader source = ShaderPreprocessor::Process(filepath, defines);
+  unsigned int program = ShaderStages::Build({ { GL_COMPUTE_SHADER, std::move(source.source), filepath } }, filepath);
+  if(!program){
+    return;
+  }
+
+  //* Same binding per block name as every Shader, so a block bound once serves both.
+  GLint blockCount = 0;
+  GLint maxNameLength = 0;
+  GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount));
+  GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxNameLength));
+  std::vector<char> blockName(maxNameLength > 0 ? maxNameLength : 1);
+  for(GLint i = 0; i < blockCount; ++i){
+    GLsizei nameLength = 0;
+    GLCall(glGetActiveUniformBlockName(program, i, static_cast<GLsizei>(blockName.size()), &nameLength, blockName.data()));
+    unsigned int binding = UniformBlockBindings::GetBinding(std::string(blockName.data(), nameLength));
+    if(binding != UniformBlockBindings::InvalidBinding){
+      GLCall(glUniformBlockBinding(program, i, binding));
+    }
+  }
+  m_RendererId = program;
+}
+
+ComputeShader::~ComputeShader(){
+  Release();
+}
+
+ComputeShader::ComputeShader(ComputeShader&& other) noexcept
+  : m_FilePath(std::move(other.m_FilePath)), m_RendererId(other.m_RendererId) {
+  other.m_RendererId = 0;
+}
+
+ComputeShader& ComputeShader::operator=(ComputeShader&& other) noexcept{
+  if(this != &other){
+    Release();
+    m_FilePath = std::move(other.m_FilePath);
+    m_RendererId = other.m_RendererId;
+    other.m_RendererId = 0;
+  }
+  return *this;
+}
+
+void ComputeShader::Release(){
+  if(m_RendererId){
+    GLState::OnDeleteProgram(m_RendererId);
+    DeletionQueue::Enqueue(GLObjectKind::Program, m_RendererId);
+    m_RendererId = 0;
+  }
+}
+
+void ComputeShader::Bind() const{
+  GLState::BindProgram(m_RendererId);
+}
+
+void ComputeShader::Dispatch(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) const{
+  if(!m_RendererId || groupsX == 0 || groupsY == 0 || groupsZ == 0){
+    return;
+  }
+  Bind();
+  GLCall(glDispatchCompute(groupsX, groupsY, groupsZ));
+}
+
+bool ComputeShader::IsSupported(){
+  return GLAD_GL_ARB_compute_shader && GLAD_GL_ARB_shader_storage_buffer_object;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ShaderPreprocessor.h"
+
+/*
+A program with a single compute stage. The file goes through ShaderPreprocessor like Shader's, and its
+uniform blocks get their bindings from UniformBlockBindings. Storage buffers use layout(binding = N) in the
+shader itself. Compiles and links before the constructor returns, compute programs are few and small.
+Only build one when IsSupported(), a 3.3 context has no compute stage.
+*/
+class ComputeShader {
+public:
+  ComputeShader(const std::string& filepath, const std::vector<ShaderDefine>& defines = {});
+  ~ComputeShader();
+  //* Unlike Shader, the program isn't shared through ProgramRegistry, each ComputeShader deletes its own. So no copies.
+  ComputeShader(const ComputeShader&) = delete;
+  ComputeShader& operator=(const ComputeShader&) = delete;
+  ComputeShader(ComputeShader&& other) noexcept;
+  ComputeShader& operator=(ComputeShader&& other) noexcept;
+
+  void Bind() const;
+  //* Binds and runs groupsX * groupsY * groupsZ work groups. Whoever reads the results needs a glMemoryBarrier first.
+  void Dispatch(unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1) const;
+
+  //* False when compiling or linking failed, the log went to stdout. Dispatch does nothing then.
+  inline bool IsValid() const { return m_RendererId != 0; }
+  inline unsigned int GetRendererId() const { return m_RendererId; }
+
+  static bool IsSupported();
+private:
+  void Release();
+  std::string m_FilePath;
+  unsigned int m_RendererId = 0;
+};
@@ -0,0 +1,138 @@
+#include "DeletionQueue.h"
+
+#include <atomic>
+#include <deque>
+#include <vector>
+
+#include "renderer.h"
+#include "GLState.h"
+#include "VertexFormatCache.h"
+
+static const unsigned int KIND_COUNT = static_cast<unsigned int>(GLObjectKind::Count);
+
+struct PendingName {
+  GLObjectKind kind;
+  unsigned int name;
+  PendingName* next;
+};
+
+//* Names dropped since the last EndFrame, retired once the fence after them signals.
+struct DeletionBatch {
+  GLsync fence = nullptr;
+  std::vector<unsigned int> names[KIND_COUNT];
+};
+
+//* Producers push onto this, the GL thread takes the whole list at once with an exchange, so there's no ABA.
+static std::atomic<PendingName*> s_Pending{nullptr};
+static std::atomic<unsigned int> s_PendingCount{0};
+//* Only touched on the GL thread.
+static std::deque<DeletionBatch> s_Batches;
+static unsigned long long s_Retired = 0;
+
+void DeletionQueue::Enqueue(GLObjectKind kind, unsigned int name){
+  if(name == 0){
+    return;
+  }
+  //* Counted before the push: once the node is visible TakePending may already be taking it back off the count.
+  //* The release below orders this add before that fetch_sub, so the count never dips under zero.
+  s_PendingCount.fetch_add(1, std::memory_order_relaxed);
+  PendingName* node = new PendingName{ kind, name, s_Pending.load(std::memory_order_relaxed) };
+  while(!s_Pending.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed));
+}
+
+//* Moves everything pushed so far into batch, returns false if nothing was there.
+static bool TakePending(DeletionBatch& batch){
+  PendingName* node = s_Pending.exchange(nullptr, std::memory_order_acquire);
+  if(!node){
+    return false;
+  }
+  while(node){
+    batch.names[static_cast<unsigned int>(node->kind)].push_back(node->name);
+    PendingName* next = node->next;
+    delete node;
+    s_PendingCount.fetch_sub(1, std::memory_order_relaxed);
+    node = next;
+  }
+  return true;
+}
+
+static void Retire(DeletionBatch& batch){
+  std::vector<unsigned int>& buffers = batch.names[static_cast<unsigned int>(GLObjectKind::Buffer)];
+  if(!buffers.empty()){
+    GLCall(glDeleteBuffers(static_cast<GLsizei>(buffers.size()), buffers.data()));
+    for(unsigned int name : buffers){
+      GLState::OnDeleteBuffer(name);
+      VertexFormatCache::OnDeleteBuffer(name);
+    }
+  }
+  std::vector<unsigned int>& vertexArrays = batch.names[static_cast<unsigned int>(GLObjectKind::VertexArray)];
+  if(!vertexArrays.empty()){
+    GLCall(glDeleteVertexArrays(static_cast<GLsizei>(vertexArrays.size()), vertexArrays.data()));
+    for(unsigned int name : vertexArrays){
+      GLState::OnDeleteVertexArray(name);
+    }
+  }
+  std::vector<unsigned int>& textures = batch.names[static_cast<unsigned int>(GLObjectKind::Texture)];
+  if(!textures.empty()){
+    GLCall(glDeleteTextures(static_cast<GLsizei>(textures.size()), textures.data()));
+    for(unsigned int name : textures){
+      GLState::OnDeleteTexture(name);
+    }
+  }
+  //* Programs don't have a batched delete.
+  for(unsigned int name : batch.names[static_cast<unsigned int>(GLObjectKind::Program)]){
+    GLCall(glDeleteProgram(name));
+    GLState::OnDeleteProgram(name);
+  }
+
+  for(unsigned int i = 0; i < KIND_COUNT; ++i){
+    s_Retired += batch.names[i].size();
+  }
+  if(batch.fence){
+    GLCall(glDeleteSync(batch.fence));
+  }
+}
+
+void DeletionQueue::EndFrame(){
+  DeletionBatch batch;
+  if(TakePending(batch)){
+    //* Anything submitted up to now might still reference these names, so they wait for this fence.
+    GLCall(batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    s_Batches.push_back(std::move(batch));
+  }
+
+  //* Batches are in submission order, so stop at the first one the GPU isn't done with.
+  while(!s_Batches.empty()){
+    GLenum status;
+    GLCall(status = glClientWaitSync(s_Batches.front().fence, 0, 0));
+    if(status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED){
+      break;
+    }
+    Retire(s_Batches.front());
+    s_Batches.pop_front();
+  }
+}
+
+void DeletionQueue::Flush(){
+  DeletionBatch batch;
+  TakePending(batch);
+  for(DeletionBatch& pending : s_Batches){
+    Retire(pending);
+  }
+  s_Batches.clear();
+  Retire(batch);
+  //* Retiring buffers can queue the fallback VAOs that used them, take those too.
+  DeletionBatch dropped;
+  while(TakePending(dropped)){
+    Retire(dropped);
+    dropped = DeletionBatch();
+  }
+}
+
+unsigned int DeletionQueue::GetPendingCount(){
+  return s_PendingCount.load(std::memory_order_relaxed);
+}
+
+unsigned long long DeletionQueue::GetRetiredCount(){
+  return s_Retired;
+}
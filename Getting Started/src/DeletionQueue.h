@@ -0,0 +1,28 @@
+#pragma once
+
+enum class GLObjectKind {
+  Buffer,
+  VertexArray,
+  Texture,
+  Program,
+  Count,
+};
+
+/*
+Deferred glDelete* for names that might still be in use by the GPU, or that are dropped off the GL thread.
+Enqueue can be called from any thread, it's a lock free push onto a list and never touches GL.
+Once per frame the GL thread calls EndFrame(), which moves everything queued so far into a batch behind a
+fence, and deletes every older batch whose fence has signaled with one glDelete* call per kind.
+Flush() deletes everything right away, call it before the context goes away.
+*/
+class DeletionQueue {
+public:
+  static void Enqueue(GLObjectKind kind, unsigned int name);
+
+  static void EndFrame();
+  static void Flush();
+
+  //* Queued from any thread but not deleted yet.
+  static unsigned int GetPendingCount();
+  static unsigned long long GetRetiredCount();
+};
@@ -0,0 +1,201 @@
+#include "FileLoader.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//* Enough to keep a batch of loads from allocating, small enough not to sit on much memory.
+static const size_t MAX_POOLED_BUFFERS = 8;
+
+static std::mutex s_Mutex;
+static std::vector<std::vector<char>> s_Pool;
+static FileLoaderStats s_Stats;
+
+//* The smallest pooled buffer that fits, or a new one.
+static std::vector<char> AcquireBuffer(size_t size){
+  std::lock_guard<std::mutex> lock(s_Mutex);
+  size_t best = s_Pool.size();
+  for(size_t i = 0; i < s_Pool.size(); ++i){
+    if(s_Pool[i].capacity() >= size && (best == s_Pool.size() || s_Pool[i].capacity() < s_Pool[best].capacity())){
+      best = i;
+    }
+  }
+  std::vector<char> buffer;
+  if(best < s_Pool.size()){
+    buffer = std::move(s_Pool[best]);
+    s_Pool.erase(s_Pool.begin() + best);
+  }
+  buffer.resize(size);
+  return buffer;
+}
+
+static void ReleaseBuffer(std::vector<char>&& buffer){
+  std::lock_guard<std::mutex> lock(s_Mutex);
+  if(s_Pool.size() < MAX_POOLED_BUFFERS && buffer.capacity() > 0){
+    s_Pool.push_back(std::move(buffer));
+  }
+}
+
+FileData::~FileData(){
+  Release();
+}
+
+FileData::FileData(FileData&& other) noexcept
+  : m_data(other.m_data), m_size(other.m_size), m_mapping(other.m_mapping), m_buffer(std::move(other.m_buffer)), m_valid(other.m_valid) {
+  other.m_data = nullptr;
+  other.m_size = 0;
+  other.m_mapping = nullptr;
+  other.m_valid = false;
+}
+
+FileData& FileData::operator=(FileData&& other) noexcept{
+  if(this != &other){
+    Release();
+    m_data = other.m_data;
+    m_size = other.m_size;
+    m_mapping = other.m_mapping;
+    m_buffer = std::move(other.m_buffer);
+    m_valid = other.m_valid;
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_mapping = nullptr;
+    other.m_valid = false;
+  }
+  return *this;
+}
+
+void FileData::Release(){
+#ifndef _WIN32
+  if(m_mapping){
+    munmap(m_mapping, m_size);
+  }
+#endif
+  if(m_buffer.capacity() > 0){
+    ReleaseBuffer(std::move(m_buffer));
+    m_buffer = std::vector<char>();
+  }
+  m_data = nullptr;
+  m_size = 0;
+  m_mapping = nullptr;
+  m_valid = false;
+}
+
+static void Report(const std::string& path, int error){
+  std::cout << "ERROR: can't load file " << path << ": " << strerror(error) << std::endl;
+}
+
+FileData FileLoader::LoadFile(const std::string& path, FileLoadMode mode, bool quietIfMissing){
+  FileData file;
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_RDONLY);
+  struct stat info;
+  if(fd < 0 || fstat(fd, &info) != 0){
+    int error = errno;
+    if(fd >= 0){
+      close(fd);
+    }
+    if(!(quietIfMissing && error == ENOENT)){
+      Report(path, error);
+    }
+    return file;
+  }
+  size_t size = static_cast<size_t>(info.st_size);
+  bool map = mode == FileLoadMode::Map || (mode == FileLoadMode::Auto && size >= FileLoader::MAP_THRESHOLD);
+  //* mmap refuses zero lengths, an empty file is just an empty read.
+  if(map && size > 0){
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(mapping != MAP_FAILED){
+      close(fd);
+      file.m_mapping = mapping;
+      file.m_data = static_cast<const char*>(mapping);
+      file.m_size = size;
+      file.m_valid = true;
+      return file;
+    }
+  }
+  file.m_buffer = AcquireBuffer(size);
+  size_t done = 0;
+  while(done < size){
+    ssize_t got = read(fd, file.m_buffer.data() + done, size - done);
+    if(got < 0 && errno == EINTR){
+      continue;
+    }
+    if(got <= 0){
+      //* Shrunk under us, or a real error. Either way the data is incomplete.
+      int error = got < 0 ? errno : EIO;
+      close(fd);
+      Report(path, error);
+      file.Release();
+      return file;
+    }
+    done += static_cast<size_t>(got);
+  }
+  close(fd);
+#else
+  std::FILE* stream = std::fopen(path.c_str(), "rb");
+  if(!stream){
+    int error = errno;
+    if(!(quietIfMissing && error == ENOENT)){
+      Report(path, error);
+    }
+    return file;
+  }
+  std::fseek(stream, 0, SEEK_END);
+  size_t size = static_cast<size_t>(std::ftell(stream));
+  std::fseek(stream, 0, SEEK_SET);
+  file.m_buffer = AcquireBuffer(size);
+  size_t done = std::fread(file.m_buffer.data(), 1, size, stream);
+  std::fclose(stream);
+  if(done != size){
+    Report(path, EIO);
+    file.Release();
+    return file;
+  }
+#endif
+  file.m_data = file.m_buffer.data();
+  file.m_size = size;
+  file.m_valid = true;
+  return file;
+}
+
+static void Count(const FileData& file){
+  std::lock_guard<std::mutex> lock(s_Mutex);
+  if(!file.IsValid()){
+    ++s_Stats.missing;
+    return;
+  }
+  ++s_Stats.files;
+  s_Stats.mapped += file.IsMapped();
+  s_Stats.bytes += file.GetSize();
+}
+
+FileData FileLoader::Load(const std::string& path, FileLoadMode mode){
+  FileData file = LoadFile(path, mode, false);
+  Count(file);
+  return file;
+}
+
+FileData FileLoader::LoadIfExists(const std::string& path, FileLoadMode mode){
+  FileData file = LoadFile(path, mode, true);
+  Count(file);
+  return file;
+}
+
+FileLoaderStats FileLoader::GetStats(){
+  std::lock_guard<std::mutex> lock(s_Mutex);
+  return s_Stats;
+}
+
+void FileLoader::ResetStats(){
+  std::lock_guard<std::mutex> lock(s_Mutex);
+  s_Stats = FileLoaderStats();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class FileLoadMode {
+  //* Maps files of MAP_THRESHOLD bytes and up, reads smaller ones. Mapping costs a few syscalls and page faults,
+  //* for a 2 KB shader one read is cheaper.
+  Auto,
+  //* mmap, read only and private. The pages come straight from the page cache, nothing is copied.
+  Map,
+  //* One read into a buffer from a pool, so loading many files doesn't allocate for each one.
+  Read,
+};
+
+struct FileLoaderStats {
+  unsigned int files = 0;
+  unsigned int mapped = 0;
+  unsigned int missing = 0;
+  unsigned long long bytes = 0;
+};
+
+/*
+A whole file in memory as one pointer and length. Move only, the mapping or the pooled buffer is given back
+when it goes away, so don't keep pointers into it past that.
+*/
+class FileData {
+public:
+  FileData() = default;
+  ~FileData();
+  FileData(const FileData&) = delete;
+  FileData& operator=(const FileData&) = delete;
+  FileData(FileData&& other) noexcept;
+  FileData& operator=(FileData&& other) noexcept;
+
+  inline const char* GetData() const { return m_data; }
+  inline size_t GetSize() const { return m_size; }
+  inline std::string_view GetView() const { return std::string_view(m_data, m_size); }
+  //* False when the file couldn't be opened or read. An empty file is valid.
+  inline bool IsValid() const { return m_valid; }
+  inline bool IsMapped() const { return m_mapping != nullptr; }
+private:
+  friend class FileLoader;
+  void Release();
+
+  const char* m_data = nullptr;
+  size_t m_size = 0;
+  void* m_mapping = nullptr;
+  std::vector<char> m_buffer;
+  bool m_valid = false;
+};
+
+/*
+Loads files whole for every asset loader (shaders, program binaries, ...), instead of each one streaming
+them line by line. A file that can't be opened prints an error with the reason and comes back invalid,
+never as silently empty data.
+Safe to call from any thread.
+*/
+class FileLoader {
+public:
+  static const size_t MAP_THRESHOLD = 64 * 1024;
+
+  static FileData Load(const std::string& path, FileLoadMode mode = FileLoadMode::Auto);
+  //* Like Load, but a missing file is expected and stays quiet. Other failures are still reported.
+  static FileData LoadIfExists(const std::string& path, FileLoadMode mode = FileLoadMode::Auto);
+
+  static FileLoaderStats GetStats();
+  static void ResetStats();
+private:
+  static FileData LoadFile(const std::string& path, FileLoadMode mode, bool quietIfMissing);
+};
@@ -0,0 +1,142 @@
+#include "GLDebug.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "GLExtensions.h"
+
+struct GLCallSite {
+  const char* fn = nullptr;
+  const char* file = nullptr;
+  int line = 0;
+};
+
+static thread_local GLCallSite s_CallSite;
+static GLDebugRing s_Ring;
+static bool s_DebugOutput = false;
+
+GLDebugRing::GLDebugRing(): m_head(0), m_tail(0), m_dropped(0) {
+  for(unsigned int i = 0; i < Capacity; ++i){
+    m_slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+bool GLDebugRing::Push(const GLDebugMessage& message){
+  unsigned int pos = m_head.load(std::memory_order_relaxed);
+  for(;;){
+    Slot& slot = m_slots[pos % Capacity];
+    unsigned int seq = slot.sequence.load(std::memory_order_acquire);
+    int diff = static_cast<int>(seq - pos);
+    if(diff == 0){
+      //* Slot is free for this position, try to claim it.
+      if(m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+        slot.message = message;
+        slot.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    }else if(diff < 0){
+      //* The consumer hasn't caught up yet, drop instead of stalling the driver thread.
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }else{
+      pos = m_head.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool GLDebugRing::Pop(GLDebugMessage& out){
+  Slot& slot = m_slots[m_tail % Capacity];
+  unsigned int seq = slot.sequence.load(std::memory_order_acquire);
+  if(static_cast<int>(seq - (m_tail + 1)) < 0){
+    return false;
+  }
+  out = slot.message;
+  slot.sequence.store(m_tail + Capacity, std::memory_order_release);
+  ++m_tail;
+  return true;
+}
+
+void GLMarkCallSite(const char* fn, const char* file, int line){
+  s_CallSite.fn = fn;
+  s_CallSite.file = file;
+  s_CallSite.line = line;
+}
+
+static void APIENTRY DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* /*userParam*/){
+  GLDebugMessage msg;
+  msg.source = source;
+  msg.type = type;
+  msg.id = id;
+  msg.severity = severity;
+  msg.fn = s_CallSite.fn;
+  msg.file = s_CallSite.file;
+  msg.line = s_CallSite.line;
+
+  size_t n = length < 0 ? strlen(message) : static_cast<size_t>(length);
+  if(n >= sizeof(msg.text)){
+    n = sizeof(msg.text) - 1;
+  }
+  memcpy(msg.text, message, n);
+  msg.text[n] = '\0';
+
+  s_Ring.Push(msg);
+}
+
+bool GLDebugInit(bool synchronous){
+  if(!GLAD_GL_KHR_debug){
+    return false;
+  }
+  glEnable(GL_DEBUG_OUTPUT);
+  if(synchronous){
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  }else{
+    glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  }
+  glDebugMessageCallback(DebugCallback, nullptr);
+  //* Notifications are mostly "buffer will use VIDEO memory" spam, only keep the real stuff.
+  glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+  s_DebugOutput = true;
+  return true;
+}
+
+static const char* SeverityName(unsigned int severity){
+  switch(severity){
+    case GL_DEBUG_SEVERITY_HIGH: return "high";
+    case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+    case GL_DEBUG_SEVERITY_LOW: return "low";
+  }
+  return "info";
+}
+
+unsigned int GLDebugFlush(){
+  unsigned int errors = 0;
+
+  if(!s_DebugOutput){
+    //* No debug output on this context, one glGetError loop per frame is still way cheaper than two per call.
+    while(GLenum error = glGetError()){
+      std::cout << "OpenGL error: " << error << " [frame]\n";
+      ++errors;
+    }
+    return errors;
+  }
+
+  GLDebugMessage msg;
+  while(s_Ring.Pop(msg)){
+    std::cout << "OpenGL " << SeverityName(msg.severity) << ": " << msg.text;
+    if(msg.fn){
+      std::cout << " [" << msg.fn << "] [" << msg.file << "] [" << msg.line << "]";
+    }
+    std::cout << '\n';
+    if(msg.type == GL_DEBUG_TYPE_ERROR){
+      ++errors;
+    }
+  }
+
+  static unsigned int reportedDrops = 0;
+  unsigned int dropped = s_Ring.GetDropped();
+  if(dropped != reportedDrops){
+    std::cout << "OpenGL debug ring overflowed, " << dropped - reportedDrops << " messages dropped\n";
+    reportedDrops = dropped;
+  }
+  return errors;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+
+//* One message coming back from the KHR_debug callback. The text is copied into a fixed array so the
+//* callback never allocates, it might be running on one of the driver's threads.
+struct GLDebugMessage {
+  unsigned int source;
+  unsigned int type;
+  unsigned int id;
+  unsigned int severity;
+  //* Call site of the GLCall that caused it. Only filled in when GL_TRACK_CALL_SITES is defined and the
+  //* callback runs on the calling thread (synchronous mode), otherwise these are null / 0.
+  const char* fn;
+  const char* file;
+  int line;
+  char text[256];
+};
+
+/*
+Fixed size multi producer / single consumer ring for debug messages.
+Producers are whatever threads the driver calls the callback on, the consumer is the render loop calling GLDebugFlush.
+Every slot has a sequence number so a producer can claim a slot with one CAS and publish it with one store.
+If the ring is full the message is dropped and counted instead of blocking the driver.
+*/
+class GLDebugRing {
+public:
+  static constexpr unsigned int Capacity = 256;
+
+  GLDebugRing();
+
+  bool Push(const GLDebugMessage& message);
+  bool Pop(GLDebugMessage& out);
+  inline unsigned int GetDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+private:
+  struct Slot {
+    std::atomic<unsigned int> sequence;
+    GLDebugMessage message;
+  };
+  Slot m_slots[Capacity];
+  std::atomic<unsigned int> m_head;
+  unsigned int m_tail;
+  std::atomic<unsigned int> m_dropped;
+};
+
+/*
+Turns on GL_DEBUG_OUTPUT and installs the callback. Returns false when the context has no KHR_debug
+(macOS tops out at 4.1), in that case GLDebugFlush falls back to one glGetError loop per frame.
+Synchronous output is slower but makes the driver call us from inside the GL call, so the call site is exact.
+*/
+bool GLDebugInit(bool synchronous = false);
+
+//* Drains the ring and prints every message. Call once per frame. Returns how many errors were reported.
+unsigned int GLDebugFlush();
+
+//* Remembers which GLCall is running on this thread, used by GLCall when GL_TRACK_CALL_SITES is defined.
+void GLMarkCallSite(const char* fn, const char* file, int line);
@@ -0,0 +1,117 @@
+#include "GLExtensions.h"
+
+#include <cstring>
+
+int GLAD_GL_KHR_debug = 0;
+PFNGLDEBUGMESSAGECONTROLPROC glad_glDebugMessageControl = nullptr;
+PFNGLDEBUGMESSAGECALLBACKPROC glad_glDebugMessageCallback = nullptr;
+int GLAD_GL_ARB_buffer_storage = 0;
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = nullptr;
+int GLAD_GL_ARB_vertex_attrib_binding = 0;
+PFNGLBINDVERTEXBUFFERPROC glad_glBindVertexBuffer = nullptr;
+PFNGLVERTEXATTRIBFORMATPROC glad_glVertexAttribFormat = nullptr;
+PFNGLVERTEXATTRIBIFORMATPROC glad_glVertexAttribIFormat = nullptr;
+PFNGLVERTEXATTRIBBINDINGPROC glad_glVertexAttribBinding = nullptr;
+PFNGLVERTEXBINDINGDIVISORPROC glad_glVertexBindingDivisor = nullptr;
+int GLAD_GL_ARB_base_instance = 0;
+PFNGLDRAWARRAYSINSTANCEDBASEINSTANCEPROC glad_glDrawArraysInstancedBaseInstance = nullptr;
+PFNGLDRAWELEMENTSINSTANCEDBASEINSTANCEPROC glad_glDrawElementsInstancedBaseInstance = nullptr;
+PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC glad_glDrawElementsInstancedBaseVertexBaseInstance = nullptr;
+int GLAD_GL_ARB_get_program_binary = 0;
+PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary = nullptr;
+PFNGLPROGRAMBINARYPROC glad_glProgramBinary = nullptr;
+PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri = nullptr;
+int GLAD_GL_KHR_parallel_shader_compile = 0;
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR = nullptr;
+int GLAD_GL_ARB_compute_shader = 0;
+PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute = nullptr;
+PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier = nullptr;
+int GLAD_GL_ARB_shader_storage_buffer_object = 0;
+int GLAD_GL_ARB_clear_buffer_object = 0;
+PFNGLCLEARBUFFERSUBDATAPROC glad_glClearBufferSubData = nullptr;
+int GLAD_GL_ARB_draw_indirect = 0;
+PFNGLDRAWELEMENTSINDIRECTPROC glad_glDrawElementsIndirect = nullptr;
+int GLAD_GL_ARB_multi_draw_indirect = 0;
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect = nullptr;
+int GLAD_GL_ARB_indirect_parameters = 0;
+PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTARBPROC glad_glMultiDrawElementsIndirectCountARB = nullptr;
+int GLAD_GL_ARB_query_buffer_object = 0;
+
+static bool VersionAtLeast(int major, int minor){
+  return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+}
+
+bool GLHasExtension(const char* name){
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for(GLint i = 0; i < count; ++i){
+    const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+    if(ext && strcmp(ext, name) == 0){
+      return true;
+    }
+  }
+  return false;
+}
+
+void GLLoadExtensions(GLADloadproc load){
+  //* KHR_debug is core in 4.3, before that the driver has to advertise it.
+  if(VersionAtLeast(4, 3) || GLHasExtension("GL_KHR_debug")){
+    glad_glDebugMessageControl = (PFNGLDEBUGMESSAGECONTROLPROC)load("glDebugMessageControl");
+    glad_glDebugMessageCallback = (PFNGLDEBUGMESSAGECALLBACKPROC)load("glDebugMessageCallback");
+    GLAD_GL_KHR_debug = glad_glDebugMessageControl && glad_glDebugMessageCallback;
+  }
+  if(VersionAtLeast(4, 4) || GLHasExtension("GL_ARB_buffer_storage")){
+    glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+    GLAD_GL_ARB_buffer_storage = glad_glBufferStorage != nullptr;
+  }
+  if(VersionAtLeast(4, 3) || GLHasExtension("GL_ARB_vertex_attrib_binding")){
+    glad_glBindVertexBuffer = (PFNGLBINDVERTEXBUFFERPROC)load("glBindVertexBuffer");
+    glad_glVertexAttribFormat = (PFNGLVERTEXATTRIBFORMATPROC)load("glVertexAttribFormat");
+    glad_glVertexAttribIFormat = (PFNGLVERTEXATTRIBIFORMATPROC)load("glVertexAttribIFormat");
+    glad_glVertexAttribBinding = (PFNGLVERTEXATTRIBBINDINGPROC)load("glVertexAttribBinding");
+    glad_glVertexBindingDivisor = (PFNGLVERTEXBINDINGDIVISORPROC)load("glVertexBindingDivisor");
+    GLAD_GL_ARB_vertex_attrib_binding = glad_glBindVertexBuffer && glad_glVertexAttribFormat && glad_glVertexAttribIFormat && glad_glVertexAttribBinding && glad_glVertexBindingDivisor;
+  }
+  if(VersionAtLeast(4, 2) || GLHasExtension("GL_ARB_base_instance")){
+    glad_glDrawArraysInstancedBaseInstance = (PFNGLDRAWARRAYSINSTANCEDBASEINSTANCEPROC)load("glDrawArraysInstancedBaseInstance");
+    glad_glDrawElementsInstancedBaseInstance = (PFNGLDRAWELEMENTSINSTANCEDBASEINSTANCEPROC)load("glDrawElementsInstancedBaseInstance");
+    glad_glDrawElementsInstancedBaseVertexBaseInstance = (PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC)load("glDrawElementsInstancedBaseVertexBaseInstance");
+    GLAD_GL_ARB_base_instance = glad_glDrawArraysInstancedBaseInstance && glad_glDrawElementsInstancedBaseInstance && glad_glDrawElementsInstancedBaseVertexBaseInstance;
+  }
+  if(VersionAtLeast(4, 1) || GLHasExtension("GL_ARB_get_program_binary")){
+    glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+    glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+    glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+    GLAD_GL_ARB_get_program_binary = glad_glGetProgramBinary && glad_glProgramBinary && glad_glProgramParameteri;
+  }
+  //* Not core anywhere. The ARB version has the same enums, only the entry point name differs.
+  if(GLHasExtension("GL_KHR_parallel_shader_compile")){
+    glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+  }else if(GLHasExtension("GL_ARB_parallel_shader_compile")){
+    glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+  }
+  GLAD_GL_KHR_parallel_shader_compile = glad_glMaxShaderCompilerThreadsKHR != nullptr;
+  if(VersionAtLeast(4, 3) || GLHasExtension("GL_ARB_compute_shader")){
+    glad_glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
+    glad_glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)load("glMemoryBarrier");
+    GLAD_GL_ARB_compute_shader = glad_glDispatchCompute && glad_glMemoryBarrier;
+  }
+  GLAD_GL_ARB_shader_storage_buffer_object = VersionAtLeast(4, 3) || GLHasExtension("GL_ARB_shader_storage_buffer_object");
+  if(VersionAtLeast(4, 3) || GLHasExtension("GL_ARB_clear_buffer_object")){
+    glad_glClearBufferSubData = (PFNGLCLEARBUFFERSUBDATAPROC)load("glClearBufferSubData");
+    GLAD_GL_ARB_clear_buffer_object = glad_glClearBufferSubData != nullptr;
+  }
+  if(VersionAtLeast(4, 0) || GLHasExtension("GL_ARB_draw_indirect")){
+    glad_glDrawElementsIndirect = (PFNGLDRAWELEMENTSINDIRECTPROC)load("glDrawElementsIndirect");
+    GLAD_GL_ARB_draw_indirect = glad_glDrawElementsIndirect != nullptr;
+  }
+  if(VersionAtLeast(4, 3) || GLHasExtension("GL_ARB_multi_draw_indirect")){
+    glad_glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+    GLAD_GL_ARB_multi_draw_indirect = glad_glMultiDrawElementsIndirect != nullptr;
+  }
+  if(GLHasExtension("GL_ARB_indirect_parameters")){
+    glad_glMultiDrawElementsIndirectCountARB = (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTARBPROC)load("glMultiDrawElementsIndirectCountARB");
+    GLAD_GL_ARB_indirect_parameters = glad_glMultiDrawElementsIndirectCountARB != nullptr;
+  }
+  GLAD_GL_ARB_query_buffer_object = VersionAtLeast(4, 4) || GLHasExtension("GL_ARB_query_buffer_object");
+}
@@ -0,0 +1,305 @@
+#include "GLState.h"
+
+#include <array>
+#include <unordered_map>
+
+#include "renderer.h"
+#include "GLExtensions.h"
+
+//* Marks a binding we don't know anymore, so the next bind always goes to the driver.
+static const unsigned int UNKNOWN = 0xFFFFFFFF;
+
+static const unsigned int MAX_TEXTURE_UNITS = 32;
+//* GL guarantees at least 16, nothing here uses more than a couple.
+static const unsigned int MAX_VERTEX_BINDINGS = 8;
+//* The smallest GL_MAX_UNIFORM_BUFFER_BINDINGS a 3.3 driver may have. Storage buffers promise even fewer, 8.
+static const unsigned int MAX_INDEXED_BINDINGS = 36;
+
+//* Buffer targets with their own shadow slot. GL_ELEMENT_ARRAY_BUFFER isn't here, it belongs to the VAO.
+static const unsigned int s_BufferTargets[] = {
+  GL_ARRAY_BUFFER,
+  GL_UNIFORM_BUFFER,
+  GL_COPY_READ_BUFFER,
+  GL_COPY_WRITE_BUFFER,
+  GL_PIXEL_PACK_BUFFER,
+  GL_PIXEL_UNPACK_BUFFER,
+  GL_TEXTURE_BUFFER,
+  GL_TRANSFORM_FEEDBACK_BUFFER,
+  GL_DRAW_INDIRECT_BUFFER,
+  GL_SHADER_STORAGE_BUFFER,
+  GL_PARAMETER_BUFFER_ARB,
+  GL_QUERY_BUFFER,
+};
+static const unsigned int BUFFER_TARGET_COUNT = sizeof(s_BufferTargets) / sizeof(s_BufferTargets[0]);
+
+//* Targets with indexed bindings that belong to the context. Transform feedback ones live in the feedback object, so not those.
+static const unsigned int s_IndexedTargets[] = {
+  GL_UNIFORM_BUFFER,
+  GL_SHADER_STORAGE_BUFFER,
+};
+static const unsigned int INDEXED_TARGET_COUNT = sizeof(s_IndexedTargets) / sizeof(s_IndexedTargets[0]);
+
+static const unsigned int s_TextureTargets[] = {
+  GL_TEXTURE_2D,
+  GL_TEXTURE_CUBE_MAP,
+  GL_TEXTURE_2D_ARRAY,
+  GL_TEXTURE_3D,
+  GL_TEXTURE_BUFFER,
+};
+static const unsigned int TEXTURE_TARGET_COUNT = sizeof(s_TextureTargets) / sizeof(s_TextureTargets[0]);
+
+static unsigned int s_Program = 0;
+static unsigned int s_VertexArray = 0;
+static unsigned int s_Buffers[BUFFER_TARGET_COUNT] = {};
+//* Element buffer of every VAO we've seen bound, the current one is cached in s_ElementBuffer.
+static std::unordered_map<unsigned int, unsigned int> s_ElementBuffers;
+static unsigned int s_ElementBuffer = 0;
+struct VertexBufferBinding {
+  unsigned int buffer = UNKNOWN;
+  unsigned int offset = 0;
+  unsigned int stride = 0;
+};
+//* Vertex buffer bindings per VAO, only filled in for VAOs that went through BindVertexBuffer.
+static std::unordered_map<unsigned int, std::array<VertexBufferBinding, MAX_VERTEX_BINDINGS>> s_VertexBuffers;
+struct IndexedBufferBinding {
+  unsigned int buffer = 0;
+  unsigned int offset = 0;
+  unsigned int size = 0;
+};
+static IndexedBufferBinding s_IndexedBuffers[INDEXED_TARGET_COUNT][MAX_INDEXED_BINDINGS];
+static unsigned int s_ActiveUnit = 0;
+static unsigned int s_Textures[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT] = {};
+static GLStateStats s_Stats;
+
+static int BufferSlot(unsigned int target){
+  for(unsigned int i = 0; i < BUFFER_TARGET_COUNT; ++i){
+    if(s_BufferTargets[i] == target){
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int IndexedSlot(unsigned int target){
+  for(unsigned int i = 0; i < INDEXED_TARGET_COUNT; ++i){
+    if(s_IndexedTargets[i] == target){
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int TextureSlot(unsigned int target){
+  for(unsigned int i = 0; i < TEXTURE_TARGET_COUNT; ++i){
+    if(s_TextureTargets[i] == target){
+      return i;
+    }
+  }
+  return -1;
+}
+
+void GLState::BindProgram(unsigned int program){
+  if(s_Program == program){
+    ++s_Stats.programSkips;
+    return;
+  }
+  GLCall(glUseProgram(program));
+  s_Program = program;
+  ++s_Stats.programBinds;
+}
+
+void GLState::BindVertexArray(unsigned int vao){
+  if(s_VertexArray == vao){
+    ++s_Stats.vertexArraySkips;
+    return;
+  }
+  GLCall(glBindVertexArray(vao));
+  s_VertexArray = vao;
+  ++s_Stats.vertexArrayBinds;
+
+  //* A VAO we haven't seen yet is either brand new (element buffer 0) or was set up behind our back.
+  auto it = s_ElementBuffers.find(vao);
+  s_ElementBuffer = it != s_ElementBuffers.end() ? it->second : (vao == 0 ? 0 : UNKNOWN);
+}
+
+void GLState::BindBuffer(unsigned int target, unsigned int buffer){
+  if(target == GL_ELEMENT_ARRAY_BUFFER){
+    if(s_ElementBuffer == buffer){
+      ++s_Stats.bufferSkips;
+      return;
+    }
+    GLCall(glBindBuffer(target, buffer));
+    s_ElementBuffer = buffer;
+    if(s_VertexArray != UNKNOWN){
+      s_ElementBuffers[s_VertexArray] = buffer;
+    }
+    ++s_Stats.bufferBinds;
+    return;
+  }
+
+  int slot = BufferSlot(target);
+  if(slot >= 0 && s_Buffers[slot] == buffer){
+    ++s_Stats.bufferSkips;
+    return;
+  }
+  GLCall(glBindBuffer(target, buffer));
+  if(slot >= 0){
+    s_Buffers[slot] = buffer;
+  }
+  ++s_Stats.bufferBinds;
+}
+
+void GLState::BindTexture(unsigned int unit, unsigned int target, unsigned int texture){
+  int slot = TextureSlot(target);
+  if(unit < MAX_TEXTURE_UNITS && slot >= 0 && s_Textures[unit][slot] == texture){
+    ++s_Stats.textureSkips;
+    return;
+  }
+  if(s_ActiveUnit != unit){
+    GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+    s_ActiveUnit = unit;
+  }
+  GLCall(glBindTexture(target, texture));
+  if(unit < MAX_TEXTURE_UNITS && slot >= 0){
+    s_Textures[unit][slot] = texture;
+  }
+  ++s_Stats.textureBinds;
+}
+
+void GLState::BindVertexBuffer(unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int stride){
+  if(s_VertexArray == UNKNOWN || binding >= MAX_VERTEX_BINDINGS){
+    GLCall(glBindVertexBuffer(binding, buffer, offset, stride));
+    ++s_Stats.bufferBinds;
+    return;
+  }
+  VertexBufferBinding& current = s_VertexBuffers[s_VertexArray][binding];
+  if(current.buffer == buffer && current.offset == offset && current.stride == stride){
+    ++s_Stats.bufferSkips;
+    return;
+  }
+  GLCall(glBindVertexBuffer(binding, buffer, offset, stride));
+  current = { buffer, offset, stride };
+  ++s_Stats.bufferBinds;
+}
+
+void GLState::BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size){
+  int slot = IndexedSlot(target);
+  IndexedBufferBinding* current = slot >= 0 && index < MAX_INDEXED_BINDINGS ? &s_IndexedBuffers[slot][index] : nullptr;
+  if(current && current->buffer == buffer && current->offset == offset && current->size == size){
+    ++s_Stats.bufferSkips;
+    return;
+  }
+  GLCall(glBindBufferRange(target, index, buffer, offset, size));
+  if(current){
+    *current = { buffer, offset, size };
+  }
+  int generic = BufferSlot(target);
+  if(generic >= 0){
+    s_Buffers[generic] = buffer;
+  }
+  ++s_Stats.bufferBinds;
+}
+
+void GLState::OnDeleteProgram(unsigned int program){
+  //* Deleting the program in use only flags it for deletion, forget it so the next bind always goes through.
+  if(s_Program == program){
+    s_Program = UNKNOWN;
+  }
+}
+
+void GLState::OnDeleteVertexArray(unsigned int vao){
+  if(s_VertexArray == vao){
+    s_VertexArray = 0;
+    s_ElementBuffer = 0;
+  }
+  s_ElementBuffers.erase(vao);
+  s_VertexBuffers.erase(vao);
+}
+
+void GLState::OnDeleteBuffer(unsigned int buffer){
+  for(unsigned int i = 0; i < BUFFER_TARGET_COUNT; ++i){
+    if(s_Buffers[i] == buffer){
+      s_Buffers[i] = 0;
+    }
+  }
+  //* The current VAO loses the binding, others still point at the dead buffer so just forget what they had.
+  if(s_ElementBuffer == buffer){
+    s_ElementBuffer = 0;
+  }
+  for(auto& vaoBuffer : s_ElementBuffers){
+    if(vaoBuffer.second == buffer){
+      vaoBuffer.second = vaoBuffer.first == s_VertexArray ? 0 : UNKNOWN;
+    }
+  }
+  //* A new buffer can get the same name, so a matching name must not count as already bound.
+  for(auto& vaoBindings : s_VertexBuffers){
+    for(VertexBufferBinding& binding : vaoBindings.second){
+      if(binding.buffer == buffer){
+        binding.buffer = UNKNOWN;
+      }
+    }
+  }
+  for(unsigned int i = 0; i < INDEXED_TARGET_COUNT; ++i){
+    for(IndexedBufferBinding& binding : s_IndexedBuffers[i]){
+      if(binding.buffer == buffer){
+        binding.buffer = UNKNOWN;
+      }
+    }
+  }
+}
+
+void GLState::OnDeleteTexture(unsigned int texture){
+  for(unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; ++unit){
+    for(unsigned int i = 0; i < TEXTURE_TARGET_COUNT; ++i){
+      if(s_Textures[unit][i] == texture){
+        s_Textures[unit][i] = 0;
+      }
+    }
+  }
+}
+
+void GLState::Invalidate(){
+  s_Program = UNKNOWN;
+  s_VertexArray = UNKNOWN;
+  s_ElementBuffer = UNKNOWN;
+  s_ElementBuffers.clear();
+  s_VertexBuffers.clear();
+  for(unsigned int i = 0; i < BUFFER_TARGET_COUNT; ++i){
+    s_Buffers[i] = UNKNOWN;
+  }
+  for(unsigned int i = 0; i < INDEXED_TARGET_COUNT; ++i){
+    for(IndexedBufferBinding& binding : s_IndexedBuffers[i]){
+      binding.buffer = UNKNOWN;
+    }
+  }
+  s_ActiveUnit = UNKNOWN;
+  for(unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; ++unit){
+    for(unsigned int i = 0; i < TEXTURE_TARGET_COUNT; ++i){
+      s_Textures[unit][i] = UNKNOWN;
+    }
+  }
+}
+
+unsigned int GLState::GetProgram(){
+  return s_Program;
+}
+
+unsigned int GLState::GetVertexArray(){
+  return s_VertexArray;
+}
+
+unsigned int GLState::GetBuffer(unsigned int target){
+  if(target == GL_ELEMENT_ARRAY_BUFFER){
+    return s_ElementBuffer;
+  }
+  int slot = BufferSlot(target);
+  return slot >= 0 ? s_Buffers[slot] : UNKNOWN;
+}
+
+const GLStateStats& GLState::GetStats(){
+  return s_Stats;
+}
+
+void GLState::ResetStats(){
+  s_Stats = GLStateStats();
+}
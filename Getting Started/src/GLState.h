@@ -0,0 +1,53 @@
+#pragma once
+
+//* How many binds went to the driver and how many were skipped because GL already had that object bound.
+struct GLStateStats {
+  unsigned int programBinds = 0;
+  unsigned int programSkips = 0;
+  unsigned int vertexArrayBinds = 0;
+  unsigned int vertexArraySkips = 0;
+  unsigned int bufferBinds = 0;
+  unsigned int bufferSkips = 0;
+  unsigned int textureBinds = 0;
+  unsigned int textureSkips = 0;
+
+  inline unsigned int GetIssued() const { return programBinds + vertexArrayBinds + bufferBinds + textureBinds; }
+  inline unsigned int GetSkipped() const { return programSkips + vertexArraySkips + bufferSkips + textureSkips; }
+};
+
+/*
+Shadow copy of the GL binding state for the current context.
+Every Bind() in the wrappers goes through here, and a bind of whatever is already bound turns into a no-op.
+The element array buffer binding is part of the VAO, so it's remembered per VAO instead of globally.
+If something binds behind our back (raw gl calls, another library) call Invalidate() so the next binds get sent again.
+Only use it from the thread that owns the context.
+*/
+class GLState {
+public:
+  static void BindProgram(unsigned int program);
+  static void BindVertexArray(unsigned int vao);
+  //* Targets we don't track are passed straight through to glBindBuffer.
+  static void BindBuffer(unsigned int target, unsigned int buffer);
+  static void BindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+  //* glBindVertexBuffer (4.3) on the current VAO. Like the element buffer these live in the VAO, so they're
+  //* remembered per VAO. Counted with the buffer binds.
+  static void BindVertexBuffer(unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int stride);
+  //* glBindBufferRange, remembered per index for GL_UNIFORM_BUFFER and GL_SHADER_STORAGE_BUFFER. It also sets the target's generic binding, which we
+  //* follow. Counted with the buffer binds.
+  static void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size);
+
+  //* GL drops bindings to deleted objects, so the wrappers tell us when they delete something.
+  static void OnDeleteProgram(unsigned int program);
+  static void OnDeleteVertexArray(unsigned int vao);
+  static void OnDeleteBuffer(unsigned int buffer);
+  static void OnDeleteTexture(unsigned int texture);
+
+  static void Invalidate();
+
+  static unsigned int GetProgram();
+  static unsigned int GetVertexArray();
+  static unsigned int GetBuffer(unsigned int target);
+
+  static const GLStateStats& GetStats();
+  static void ResetStats();
+};
@@ -1,25 +1,183 @@
 #include "IndexBuffer.h"
 
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+  #define INDEX_SIMD_SSE2
+#elif defined(__ARM_NEON)
+  #include <arm_neon.h>
+  #define INDEX_SIMD_NEON
+#endif
+
 #include "renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count, bool allowByteIndices): m_count(count) {
+  m_type = PickType(FindMaxIndex(data, count), allowByteIndices);
+  GLsizeiptr size = static_cast<GLsizeiptr>(count) * GetTypeSize(m_type);
 
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count): m_count(count) {
   //* Open GL will make a singular buffer
   GLCall(glGenBuffers(1, &m_rendererId));
   //* creates a buffer of memory which says that it's an array and pass in the id of the buffer as well
-  GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_rendererId));
-  //* This will be us resizing the buffer and starting to use it
-  GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLuint), data, GL_STATIC_DRAW));
+  GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_rendererId);
+
+  //* Mapping a zero length range is GL_INVALID_VALUE, so an empty buffer just gets allocated.
+  if(m_type == GL_UNSIGNED_INT || size == 0){
+    //* This will be us resizing the buffer and starting to use it
+    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+    return;
+  }
+
+  //* Narrow straight into the buffer's memory instead of into a temporary copy first.
+  GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, nullptr, GL_STATIC_DRAW));
+  void* dst;
+  GLCall(dst = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  GLboolean intact = GL_FALSE;
+  //* A failed map returns null and leaves nothing to unmap.
+  if(dst){
+    Narrow(data, count, m_type, dst);
+    GLCall(intact = glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER));
+  }
+  //* The map can fail or the driver can lose mapped contents (mode switch etc.), fall back to a plain upload.
+  if(!intact){
+    std::vector<unsigned char> narrowed(size);
+    Narrow(data, count, m_type, narrowed.data());
+    GLCall(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, size, narrowed.data()));
+  }
 }
 
 IndexBuffer::~IndexBuffer(){
-  GLCall(glDeleteBuffers(1, &m_rendererId));
+  Release();
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept: m_rendererId(other.m_rendererId), m_count(other.m_count), m_type(other.m_type) {
+  other.m_rendererId = 0;
+  other.m_count = 0;
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept{
+  if(this != &other){
+    Release();
+    m_rendererId = other.m_rendererId;
+    m_count = other.m_count;
+    m_type = other.m_type;
+    other.m_rendererId = 0;
+    other.m_count = 0;
+  }
+  return *this;
+}
+
+//* A moved from buffer has id 0 and has nothing to delete.
+void IndexBuffer::Release(){
+  if(m_rendererId){
+    DeletionQueue::Enqueue(GLObjectKind::Buffer, m_rendererId);
+    m_rendererId = 0;
+  }
 }
 
 
 void IndexBuffer::Bind() const{
-  GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_rendererId));
+  GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_rendererId);
 }
 
 void IndexBuffer::Unbind() const{
-  GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+  GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+unsigned int IndexBuffer::GetTypeSize(unsigned int type){
+  switch(type){
+    case GL_UNSIGNED_BYTE: return 1;
+    case GL_UNSIGNED_SHORT: return 2;
+    case GL_UNSIGNED_INT: return 4;
+  }
+  ASSERT(false);
+  return 0;
+}
+
+unsigned int IndexBuffer::PickType(unsigned int maxIndex, bool allowByteIndices){
+  if(allowByteIndices && maxIndex <= 0xFF){
+    return GL_UNSIGNED_BYTE;
+  }
+  if(maxIndex <= 0xFFFF){
+    return GL_UNSIGNED_SHORT;
+  }
+  return GL_UNSIGNED_INT;
+}
+
+unsigned int IndexBuffer::FindMaxIndex(const unsigned int* data, unsigned int count){
+  unsigned int maxIndex = 0;
+  unsigned int i = 0;
+#if defined(INDEX_SIMD_SSE2)
+  //* SSE2 only has a signed 32 bit compare, flipping the sign bit makes it order unsigned values correctly.
+  const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000));
+  __m128i vmax = bias;
+  for(; i + 4 <= count; i += 4){
+    __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), bias);
+    __m128i greater = _mm_cmpgt_epi32(v, vmax);
+    vmax = _mm_or_si128(_mm_and_si128(greater, v), _mm_andnot_si128(greater, vmax));
+  }
+  alignas(16) unsigned int lanes[4];
+  _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_xor_si128(vmax, bias));
+  for(unsigned int lane : lanes){
+    maxIndex = lane > maxIndex ? lane : maxIndex;
+  }
+#elif defined(INDEX_SIMD_NEON)
+  uint32x4_t vmax = vdupq_n_u32(0);
+  for(; i + 4 <= count; i += 4){
+    vmax = vmaxq_u32(vmax, vld1q_u32(data + i));
+  }
+  maxIndex = vmaxvq_u32(vmax);
+#endif
+  for(; i < count; ++i){
+    maxIndex = data[i] > maxIndex ? data[i] : maxIndex;
+  }
+  return maxIndex;
+}
+
+void IndexBuffer::Narrow(const unsigned int* data, unsigned int count, unsigned int type, void* dst){
+  unsigned int i = 0;
+  if(type == GL_UNSIGNED_SHORT){
+    unsigned short* out = static_cast<unsigned short*>(dst);
+#if defined(INDEX_SIMD_SSE2)
+    //* _mm_packs_epi32 saturates to signed 16 bit, so shift everything down by 32768 and flip it back after.
+    const __m128i offset = _mm_set1_epi32(32768);
+    const __m128i flip = _mm_set1_epi16(static_cast<short>(0x8000));
+    for(; i + 8 <= count; i += 8){
+      __m128i a = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), offset);
+      __m128i b = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 4)), offset);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(_mm_packs_epi32(a, b), flip));
+    }
+#elif defined(INDEX_SIMD_NEON)
+    for(; i + 8 <= count; i += 8){
+      vst1q_u16(out + i, vcombine_u16(vmovn_u32(vld1q_u32(data + i)), vmovn_u32(vld1q_u32(data + i + 4))));
+    }
+#endif
+    for(; i < count; ++i){
+      out[i] = static_cast<unsigned short>(data[i]);
+    }
+  }else if(type == GL_UNSIGNED_BYTE){
+    unsigned char* out = static_cast<unsigned char*>(dst);
+#if defined(INDEX_SIMD_SSE2)
+    //* Everything is under 256 here so the signed packs can't saturate.
+    for(; i + 16 <= count; i += 16){
+      const __m128i* src = reinterpret_cast<const __m128i*>(data + i);
+      __m128i lo = _mm_packs_epi32(_mm_loadu_si128(src), _mm_loadu_si128(src + 1));
+      __m128i hi = _mm_packs_epi32(_mm_loadu_si128(src + 2), _mm_loadu_si128(src + 3));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(INDEX_SIMD_NEON)
+    for(; i + 8 <= count; i += 8){
+      uint16x8_t wide = vcombine_u16(vmovn_u32(vld1q_u32(data + i)), vmovn_u32(vld1q_u32(data + i + 4)));
+      vst1_u8(out + i, vmovn_u16(wide));
+    }
+#endif
+    for(; i < count; ++i){
+      out[i] = static_cast<unsigned char>(data[i]);
+    }
+  }else{
+    memcpy(dst, data, static_cast<size_t>(count) * sizeof(unsigned int));
+  }
 }
\ No newline at end of file
@@ -1,15 +1,46 @@
+#pragma once
+
+/*
+Indices always come in as 32 bit, but get stored as the narrowest type that holds the biggest one:
+GL_UNSIGNED_BYTE under 256 vertices, GL_UNSIGNED_SHORT under 65536, GL_UNSIGNED_INT otherwise.
+Draw with GetType() instead of hardcoding GL_UNSIGNED_INT.
+Some GPUs don't fetch 8 bit indices natively and convert them on the fly, pass allowByteIndices = false there.
+*/
 class IndexBuffer {
 private:
+  void Release();
   unsigned int m_rendererId;
   unsigned int m_count;
+  unsigned int m_type;
 public:
-  IndexBuffer(const unsigned int* data, unsigned int count);
+  IndexBuffer(const unsigned int* data, unsigned int count, bool allowByteIndices = true);
   ~IndexBuffer();
+  //* No copies, both would queue the buffer for deletion. A moved-from IndexBuffer has a count of 0.
+  IndexBuffer(const IndexBuffer&) = delete;
+  IndexBuffer& operator=(const IndexBuffer&) = delete;
+  IndexBuffer(IndexBuffer&& other) noexcept;
+  IndexBuffer& operator=(IndexBuffer&& other) noexcept;
 
   void Bind() const;
   void Unbind() const;
 
-  inline unsigned int GetCount() {
+  inline unsigned int GetCount() const {
     return m_count;
   }
+  inline unsigned int GetType() const {
+    return m_type;
+  }
+  inline unsigned int GetIndexSize() const {
+    return GetTypeSize(m_type);
+  }
+  inline unsigned int GetRendererId() const {
+    return m_rendererId;
+  }
+
+  //* The narrowing is SIMD (SSE2 / NEON) and usable on its own, e.g. for indices going into a BufferHeap.
+  static unsigned int FindMaxIndex(const unsigned int* data, unsigned int count);
+  static unsigned int PickType(unsigned int maxIndex, bool allowByteIndices = true);
+  static unsigned int GetTypeSize(unsigned int type);
+  //* dst needs room for count * GetTypeSize(type) bytes.
+  static void Narrow(const unsigned int* data, unsigned int count, unsigned int type, void* dst);
 };
\ No newline at end of file
@@ -0,0 +1,289 @@
+#include "IndirectRenderer.h"
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+#include "renderer.h"
+#include "GLState.h"
+#include "GLExtensions.h"
+#include "DeletionQueue.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "UniformBlockBindings.h"
+
+//* Storage buffer bindings, the same numbers are in res/shaders/indirect.glsl and cull.comp.
+static const unsigned int OBJECTS_BINDING = 0;
+static const unsigned int MESHES_BINDING = 1;
+static const unsigned int COMMANDS_BINDING = 2;
+static const unsigned int COUNTER_BINDING = 3;
+//* local_size_x in cull.comp.
+static const unsigned int CULL_GROUP_SIZE = 64;
+//* No driver asks for more than this GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, so it's what one object's constants take in the ring.
+static const unsigned int MAX_UNIFORM_ALIGNMENT = 256;
+
+struct CullConstants {
+  Vec4 planes[6];
+  unsigned int objectCount;
+  unsigned int pad[3];
+};
+UNIFORM_BLOCK(CullConstants, Std140, UNIFORM_MEMBER(CullConstants, planes), UNIFORM_MEMBER(CullConstants, objectCount));
+
+//* What the CPU path's vertex shader (indirect_fallback.vert) gets per draw.
+struct ObjectConstants {
+  Mat4 transform;
+};
+UNIFORM_BLOCK(ObjectConstants, Std140, UNIFORM_MEMBER(ObjectConstants, transform));
+
+struct IndirectInstance {
+  unsigned int object;
+};
+VERTEX_LAYOUT(IndirectInstance, VERTEX_ATTRIB_INTEGER(IndirectInstance, object));
+
+static std::vector<unsigned int> MakeObjectIds(unsigned int count){
+  std::vector<unsigned int> ids(count);
+  for(unsigned int i = 0; i < count; ++i){
+    ids[i] = i;
+  }
+  return ids;
+}
+
+static unsigned int CreateBuffer(unsigned int size, const void* data = nullptr){
+  unsigned int buffer = 0;
+  GLCall(glGenBuffers(1, &buffer));
+  GLState::BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+  GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, data, GL_DYNAMIC_DRAW));
+  return buffer;
+}
+
+static void DeleteBuffer(unsigned int& buffer){
+  if(buffer){
+    DeletionQueue::Enqueue(GLObjectKind::Buffer, buffer);
+    buffer = 0;
+  }
+}
+
+//* The sphere's center moved to world space and its radius grown by the largest axis scale, so non uniform scales stay conservative.
+static bool SphereInFrustum(const IndirectObject& object, const Vec4 planes[6]){
+  const float* m = object.transform.m;
+  const float* c = object.bounds.v;
+  float center[3];
+  for(int row = 0; row < 3; ++row){
+    center[row] = m[row] * c[0] + m[4 + row] * c[1] + m[8 + row] * c[2] + m[12 + row];
+  }
+  float scale = 0.0f;
+  for(int column = 0; column < 3; ++column){
+    const float* axis = m + column * 4;
+    float length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    scale = length > scale ? length : scale;
+  }
+  float radius = c[3] * std::sqrt(scale);
+  for(int i = 0; i < 6; ++i){
+    const float* plane = planes[i].v;
+    if(plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3] < -radius){
+      return false;
+    }
+  }
+  return true;
+}
+
+IndirectRenderer::IndirectRenderer(unsigned int maxObjects, CullingMode mode, unsigned int drawsPerFrame)
+  : m_Mode(mode), m_MaxObjects(maxObjects),
+    m_ObjectIds(MakeObjectIds(maxObjects).data(), maxObjects * sizeof(unsigned int)),
+    //* Cull constants plus, for the CPU path, one block per object per Draw.
+    m_Ring((maxObjects * (drawsPerFrame == 0 ? 1 : drawsPerFrame) + 2) * MAX_UNIFORM_ALIGNMENT) {
+  if(m_Mode == CullingMode::Auto){
+    m_Mode = IsGPUCullingSupported() ? CullingMode::GPU : CullingMode::CPU;
+  }
+  if(m_Mode == CullingMode::GPU && !IsGPUCullingSupported()){
+    std::cout << "GPU culling needs compute shaders, storage buffers and multi draw indirect (GL 4.3), culling on the CPU" << std::endl;
+    m_Mode = CullingMode::CPU;
+  }
+  if(m_Mode == CullingMode::GPU){
+    m_Cull = std::make_unique<ComputeShader>("res/shaders/cull.comp");
+    if(!m_Cull->IsValid()){
+      m_Cull.reset();
+      m_Mode = CullingMode::CPU;
+    }
+  }
+  if(m_Mode == CullingMode::GPU){
+    m_ObjectBuffer = CreateBuffer(maxObjects * sizeof(IndirectObject));
+    m_CommandBuffer = CreateBuffer(maxObjects * sizeof(DrawElementsIndirectCommand));
+    m_CounterBuffer = CreateBuffer(sizeof(unsigned int));
+  }
+}
+
+IndirectRenderer::~IndirectRenderer(){
+  DeleteBuffer(m_ObjectBuffer);
+  DeleteBuffer(m_MeshBuffer);
+  DeleteBuffer(m_CommandBuffer);
+  DeleteBuffer(m_CounterBuffer);
+}
+
+bool IndirectRenderer::IsGPUCullingSupported(){
+  return ComputeShader::IsSupported() && GLAD_GL_ARB_multi_draw_indirect && GLAD_GL_ARB_clear_buffer_object;
+}
+
+unsigned int IndirectRenderer::AddMesh(const HeapMesh& mesh){
+  if(m_Meshes.empty()){
+    m_VertexBuffer = mesh.vertices.buffer;
+    m_IndexBuffer = mesh.indices.buffer;
+    m_IndexType = mesh.indexType;
+  }
+  //* One draw means one vertex buffer, one index buffer and one index type for everything.
+  ASSERT(mesh.vertices.buffer == m_VertexBuffer && mesh.indices.buffer == m_IndexBuffer && mesh.indexType == m_IndexType);
+  MeshEntry entry;
+  entry.indexCount = mesh.indexCount;
+  entry.firstIndex = mesh.indices.offset / IndexBuffer::GetTypeSize(mesh.indexType);
+  entry.baseVertex = static_cast<int>(mesh.vertices.offset / mesh.vertexStride);
+  entry.pad = 0;
+  m_Meshes.push_back(entry);
+  m_MeshesDirty = true;
+  return static_cast<unsigned int>(m_Meshes.size() - 1);
+}
+
+void IndirectRenderer::AddObjectIndex(VertexArray& va) const{
+  va.AddBuffer<IndirectInstance>(m_ObjectIds, 1);
+}
+
+void IndirectRenderer::SetObjects(const IndirectObject* objects, unsigned int count){
+  ASSERT(count <= m_MaxObjects);
+  m_ObjectCount = count;
+  if(m_Mode == CullingMode::CPU){
+    m_Objects.assign(objects, objects + count);
+    return;
+  }
+  GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_ObjectBuffer);
+  GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, 0, count * sizeof(IndirectObject), objects));
+}
+
+void IndirectRenderer::Cull(const Vec4 planes[6]){
+  m_Stats = IndirectRendererStats();
+  m_Stats.objects = m_ObjectCount;
+  if(m_Mode == CullingMode::GPU){
+    CullOnGPU(planes);
+  }else{
+    CullOnCPU(planes);
+  }
+}
+
+void IndirectRenderer::CullOnCPU(const Vec4 planes[6]){
+  m_Visible.clear();
+  for(unsigned int i = 0; i < m_ObjectCount; ++i){
+    if(SphereInFrustum(m_Objects[i], planes)){
+      m_Visible.push_back(i);
+    }
+  }
+  m_Stats.visible = static_cast<unsigned int>(m_Visible.size());
+}
+
+void IndirectRenderer::CullOnGPU(const Vec4 planes[6]){
+  //* The counter starts at 0. Without a draw count buffer the commands of culled objects have to read count 0 too.
+  unsigned int zero = 0;
+  GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_CounterBuffer);
+  GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, 0, sizeof(zero), &zero));
+  //* Nothing to cull, and binding an empty mesh buffer as a range would be GL_INVALID_VALUE.
+  if(m_ObjectCount == 0 || m_Meshes.empty()){
+    return;
+  }
+  if(m_MeshesDirty){
+    DeleteBuffer(m_MeshBuffer);
+    m_MeshBuffer = CreateBuffer(static_cast<unsigned int>(m_Meshes.size() * sizeof(MeshEntry)), m_Meshes.data());
+    m_MeshesDirty = false;
+  }
+  if(!GLAD_GL_ARB_indirect_parameters){
+    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_CommandBuffer);
+    GLCall(glClearBufferSubData(GL_COPY_WRITE_BUFFER, GL_R32UI, 0, m_ObjectCount * sizeof(DrawElementsIndirectCommand), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero));
+  }
+
+  CullConstants constants;
+  for(int i = 0; i < 6; ++i){
+    constants.planes[i] = planes[i];
+  }
+  constants.objectCount = m_ObjectCount;
+  UniformRing::Bind(UniformBlockBindings::GetBinding("CullConstants"), m_Ring.Write(constants));
+  GLState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, OBJECTS_BINDING, m_ObjectBuffer, 0, m_MaxObjects * sizeof(IndirectObject));
+  GLState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, MESHES_BINDING, m_MeshBuffer, 0, static_cast<unsigned int>(m_Meshes.size() * sizeof(MeshEntry)));
+  GLState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, COMMANDS_BINDING, m_CommandBuffer, 0, m_MaxObjects * sizeof(DrawElementsIndirectCommand));
+  GLState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, COUNTER_BINDING, m_CounterBuffer, 0, sizeof(unsigned int));
+  m_Cull->Dispatch((m_ObjectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE);
+  //* The draw reads the commands and the count as indirect parameters, not through a shader. Next frame's
+  //* glBufferSubData / glClearBufferSubData overwrite what the shader wrote, which needs the update bit.
+  GLCall(glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT));
+}
+
+void IndirectRenderer::Draw(const VertexArray& va, const Shader& shader){
+  if(m_ObjectCount == 0 || m_Meshes.empty()){
+    return;
+  }
+  shader.Bind();
+  va.Bind();
+  GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBuffer);
+  unsigned int indexSize = IndexBuffer::GetTypeSize(m_IndexType);
+
+  if(m_Mode == CullingMode::CPU){
+    unsigned int binding = UniformBlockBindings::GetBinding("ObjectConstants");
+    for(unsigned int object : m_Visible){
+      const MeshEntry& mesh = m_Meshes[m_Objects[object].mesh];
+      UniformAllocation constants = m_Ring.Write(ObjectConstants{ m_Objects[object].transform });
+      //* Bind would skip it and the object would draw with the previous one's transform, better to draw nothing.
+      if(!constants.IsValid()){
+        if(!m_RingFullReported){
+          std::cout << "IndirectRenderer: uniform ring full, more Draw calls this frame than drawsPerFrame. Skipping the rest." << std::endl;
+          m_RingFullReported = true;
+        }
+        return;
+      }
+      UniformRing::Bind(binding, constants);
+      GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, m_IndexType,
+        reinterpret_cast<const void*>(static_cast<uintptr_t>(mesh.firstIndex * indexSize)), mesh.baseVertex));
+      ++m_Stats.drawCalls;
+    }
+    return;
+  }
+
+  GLState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, OBJECTS_BINDING, m_ObjectBuffer, 0, m_MaxObjects * sizeof(IndirectObject));
+  GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+  if(GLAD_GL_ARB_indirect_parameters){
+    GLState::BindBuffer(GL_PARAMETER_BUFFER_ARB, m_CounterBuffer);
+    GLCall(glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, m_IndexType, nullptr, 0, m_ObjectCount, sizeof(DrawElementsIndirectCommand)));
+  }else{
+    GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, m_IndexType, nullptr, m_ObjectCount, sizeof(DrawElementsIndirectCommand)));
+  }
+  ++m_Stats.drawCalls;
+}
+
+void IndirectRenderer::EndFrame(){
+  m_Ring.EndFrame();
+}
+
+unsigned int IndirectRenderer::ReadVisibleCount() const{
+  if(m_Mode == CullingMode::CPU){
+    return static_cast<unsigned int>(m_Visible.size());
+  }
+  unsigned int count = 0;
+  GLCall(glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT));
+  GLState::BindBuffer(GL_COPY_READ_BUFFER, m_CounterBuffer);
+  GLCall(glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(count), &count));
+  return count;
+}
+
+void IndirectRenderer::ExtractFrustumPlanes(const Mat4& viewProjection, Vec4 planes[6]){
+  //* Row r of a column major matrix is m[r], m[4 + r], m[8 + r], m[12 + r].
+  const float* m = viewProjection.m;
+  auto row = [m](int r, int i){ return m[i * 4 + r]; };
+  for(int i = 0; i < 6; ++i){
+    //* left = row 3 + row 0, right = row 3 - row 0, then the same with rows 1 and 2.
+    int axis = i / 2;
+    float sign = i % 2 == 0 ? 1.0f : -1.0f;
+    float* plane = planes[i].v;
+    for(int c = 0; c < 4; ++c){
+      plane[c] = row(3, c) + sign * row(axis, c);
+    }
+    float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+    for(int c = 0; c < 4; ++c){
+      plane[c] /= length;
+    }
+  }
+}
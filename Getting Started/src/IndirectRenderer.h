@@ -0,0 +1,133 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "BufferHeap.h"
+#include "VertexBuffer.h"
+#include "UniformRing.h"
+#include "ComputeShader.h"
+
+class VertexArray;
+class Shader;
+
+//* What glMultiDrawElementsIndirect reads for each draw, 20 bytes, tightly packed.
+struct DrawElementsIndirectCommand {
+  unsigned int count;
+  unsigned int instanceCount;
+  unsigned int firstIndex;
+  int baseVertex;
+  unsigned int baseInstance;
+};
+
+//* One object in the objects storage buffer, IndirectObject in res/shaders/indirect.glsl.
+struct IndirectObject {
+  //* Object to world, column major.
+  Mat4 transform;
+  //* Bounding sphere in object space, center in xyz, radius in w.
+  Vec4 bounds;
+  //* What AddMesh returned.
+  unsigned int mesh;
+  unsigned int pad[3];
+};
+UNIFORM_BLOCK(IndirectObject, Std430, UNIFORM_MEMBER(IndirectObject, transform), UNIFORM_MEMBER(IndirectObject, bounds),
+  UNIFORM_MEMBER(IndirectObject, mesh));
+
+enum class CullingMode {
+  //* GPU when IsGPUCullingSupported, CPU otherwise.
+  Auto,
+  //* res/shaders/cull.comp writes the draw commands, one glMultiDrawElementsIndirect draws them. Needs 4.3.
+  GPU,
+  //* Culled in a loop here, one glDrawElementsBaseVertex per visible object with its transform in a uniform block.
+  CPU,
+};
+
+struct IndirectRendererStats {
+  unsigned int objects = 0;
+  //* CPU culling only. GPU culling leaves the count on the GPU, ReadVisibleCount fetches it.
+  unsigned int visible = 0;
+  unsigned int drawCalls = 0;
+};
+
+/*
+Draws many objects made of a few meshes, culled against the view frustum every frame.
+With GPU culling, objects and meshes live in storage buffers. A compute shader tests each object's bounding
+sphere and appends a draw command for the ones inside, and a single glMultiDrawElementsIndirect draws them.
+Each command's baseInstance is its object's index, which reaches the vertex shader through an instanced
+attribute (AddObjectIndex), so the vertex shader can fetch the transform. With ARB_indirect_parameters the
+draw count comes straight from the compute shader's counter. Without it every object gets a command slot and
+the culled ones are left at count 0.
+Meshes all have to come from the same vertex and index heap block, that's what makes one draw possible.
+Vertex shaders for the two modes differ, see res/shaders/indirect.vert and indirect_fallback.vert.
+GL thread only. EndFrame() once a frame.
+*/
+class IndirectRenderer {
+public:
+  //* drawsPerFrame is how many Draw calls share a frame (a depth pre-pass or shadow pass each count). The CPU path
+  //* writes every visible object's transform once per Draw, so its uniform ring is sized for that many.
+  IndirectRenderer(unsigned int maxObjects, CullingMode mode = CullingMode::Auto, unsigned int drawsPerFrame = 1);
+  ~IndirectRenderer();
+  IndirectRenderer(const IndirectRenderer&) = delete;
+  IndirectRenderer& operator=(const IndirectRenderer&) = delete;
+
+  //* Returns the index IndirectObject::mesh refers to it by.
+  unsigned int AddMesh(const HeapMesh& mesh);
+  //* Appends the per instance object index to va, at location va.GetAttributeCount(). Call once per VAO.
+  void AddObjectIndex(VertexArray& va) const;
+  //* Replaces every object. Only needs calling again when objects move.
+  void SetObjects(const IndirectObject* objects, unsigned int count);
+
+  //* planes from ExtractFrustumPlanes, in world space.
+  void Cull(const Vec4 planes[6]);
+  //* va has to be set up on the meshes' vertex heap block and have had AddObjectIndex.
+  void Draw(const VertexArray& va, const Shader& shader);
+  void EndFrame();
+
+  //* Waits for the GPU when culling there, for checks and benchmarks, not every frame.
+  unsigned int ReadVisibleCount() const;
+
+  inline CullingMode GetMode() const { return m_Mode; }
+  inline const IndirectRendererStats& GetStats() const { return m_Stats; }
+  static bool IsGPUCullingSupported();
+  //* Gribb / Hartmann: the six planes (left, right, bottom, top, near, far) of a column major view projection,
+  //* normalized, pointing inwards.
+  static void ExtractFrustumPlanes(const Mat4& viewProjection, Vec4 planes[6]);
+private:
+  //* MeshEntry in res/shaders/indirect.glsl.
+  struct MeshEntry {
+    unsigned int indexCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int pad;
+  };
+
+  void CullOnCPU(const Vec4 planes[6]);
+  void CullOnGPU(const Vec4 planes[6]);
+
+  CullingMode m_Mode;
+  unsigned int m_MaxObjects;
+  unsigned int m_ObjectCount = 0;
+  std::vector<MeshEntry> m_Meshes;
+  unsigned int m_VertexBuffer = 0;
+  unsigned int m_IndexBuffer = 0;
+  unsigned int m_IndexType = 0;
+  //* 0, 1, 2 ... one per object, read once per instance so baseInstance picks the object.
+  VertexBuffer m_ObjectIds;
+  UniformRing m_Ring;
+
+  //* CPU culling keeps its own copy of the objects and fills m_Visible.
+  std::vector<IndirectObject> m_Objects;
+  std::vector<unsigned int> m_Visible;
+
+  //* GPU culling only, left empty on the CPU path.
+  std::unique_ptr<ComputeShader> m_Cull;
+  unsigned int m_ObjectBuffer = 0;
+  unsigned int m_MeshBuffer = 0;
+  unsigned int m_CommandBuffer = 0;
+  unsigned int m_CounterBuffer = 0;
+  //* AddMesh only appends to m_Meshes, the next GPU cull uploads the table.
+  bool m_MeshesDirty = false;
+  //* So running out of ring space is only reported once.
+  bool m_RingFullReported = false;
+  IndirectRendererStats m_Stats;
+};
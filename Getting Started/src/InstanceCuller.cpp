@@ -0,0 +1,158 @@
+#include "InstanceCuller.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "renderer.h"
+#include "GLState.h"
+#include "GLExtensions.h"
+#include "DeletionQueue.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderStages.h"
+#include "IndirectRenderer.h"
+
+static const char* CULL_VERTEX = "res/shaders/feedback_cull.vert";
+static const char* CULL_GEOMETRY = "res/shaders/feedback_cull.geom";
+//* The geometry shader's outputs, captured interleaved in CullInstance's member order.
+static const char* s_Varyings[] = { "o_Placement", "o_Color" };
+
+//* Vertex + geometry, no fragment stage, the rasterizer is off while it runs anyway.
+static unsigned int BuildCullProgram(){
+  std::vector<ShaderStageSource> stages = {
+    { GL_VERTEX_SHADER, ShaderPreprocessor::Process(CULL_VERTEX).source, CULL_VERTEX },
+    { GL_GEOMETRY_SHADER, ShaderPreprocessor::Process(CULL_GEOMETRY).source, CULL_GEOMETRY },
+  };
+  return ShaderStages::Build(stages, std::string(CULL_VERTEX) + " + " + CULL_GEOMETRY, [](unsigned int program){
+    //* Has to be set before linking, the linker lays out the captured outputs.
+    GLCall(glTransformFeedbackVaryings(program, 2, s_Varyings, GL_INTERLEAVED_ATTRIBS));
+  });
+}
+
+static unsigned int CreateBuffer(unsigned int size, const void* data){
+  unsigned int buffer = 0;
+  GLCall(glGenBuffers(1, &buffer));
+  GLState::BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+  GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, data, GL_STATIC_DRAW));
+  return buffer;
+}
+
+InstanceCuller::InstanceCuller(unsigned int maxInstances, bool allowQueryBuffer)
+  : m_MaxInstances(maxInstances),
+    m_Source(allowQueryBuffer && IsQueryBufferSupported() ? InstanceCountSource::QueryBuffer : InstanceCountSource::Padded),
+    m_Instances(nullptr, maxInstances * sizeof(CullInstance)),
+    m_Visible(nullptr, maxInstances * sizeof(CullInstance)) {
+  m_CullArray.AddBuffer<CullInstance>(m_Instances);
+  m_Program = BuildCullProgram();
+  if(!m_Program){
+    return;
+  }
+  m_PlanesLocation = glGetUniformLocation(m_Program, "u_Planes");
+  m_RadiusLocation = glGetUniformLocation(m_Program, "u_Radius");
+  GLCall(glGenQueries(1, &m_Query));
+
+  if(m_Source == InstanceCountSource::QueryBuffer){
+    DrawElementsIndirectCommand command = {};
+    m_Command = CreateBuffer(sizeof(command), &command);
+  }else{
+    std::vector<CullInstance> zeros(maxInstances, CullInstance{});
+    m_Zeros = CreateBuffer(maxInstances * sizeof(CullInstance), zeros.data());
+  }
+}
+
+InstanceCuller::~InstanceCuller(){
+  if(m_Program){
+    GLState::OnDeleteProgram(m_Program);
+    DeletionQueue::Enqueue(GLObjectKind::Program, m_Program);
+  }
+  //* Queries aren't in the deletion queue. Ended queries can be deleted right away, GL keeps what's pending.
+  if(m_Query){
+    GLCall(glDeleteQueries(1, &m_Query));
+  }
+  for(unsigned int buffer : { m_Zeros, m_Command }){
+    if(buffer){
+      GLState::OnDeleteBuffer(buffer);
+      DeletionQueue::Enqueue(GLObjectKind::Buffer, buffer);
+    }
+  }
+}
+
+void InstanceCuller::SetInstances(const CullInstance* instances, unsigned int count){
+  m_Count = count < m_MaxInstances ? count : m_MaxInstances;
+  GLState::BindBuffer(GL_ARRAY_BUFFER, m_Instances.GetRendererId());
+  GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, m_Count * sizeof(CullInstance), instances));
+}
+
+void InstanceCuller::Cull(const Vec4 planes[6], float radius){
+  if(!m_Program || m_Count == 0){
+    return;
+  }
+  unsigned int visibleSize = m_Count * sizeof(CullInstance);
+  if(m_Source == InstanceCountSource::Padded){
+    //* The feedback only writes the visible ones, whatever the last cull left behind them has to go.
+    GLState::BindBuffer(GL_COPY_READ_BUFFER, m_Zeros);
+    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_Visible.GetRendererId());
+    GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, visibleSize));
+  }
+
+  GLState::BindProgram(m_Program);
+  GLCall(glUniform4fv(m_PlanesLocation, 6, planes[0].v));
+  GLCall(glUniform1f(m_RadiusLocation, radius));
+  m_CullArray.Bind();
+  GLState::BindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, m_Visible.GetRendererId(), 0, visibleSize);
+
+  GLCall(glEnable(GL_RASTERIZER_DISCARD));
+  GLCall(glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, m_Query));
+  GLCall(glBeginTransformFeedback(GL_POINTS));
+  GLCall(glDrawArrays(GL_POINTS, 0, m_Count));
+  GLCall(glEndTransformFeedback());
+  GLCall(glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN));
+  GLCall(glDisable(GL_RASTERIZER_DISCARD));
+
+  if(m_Source == InstanceCountSource::QueryBuffer){
+    //* With a query buffer bound the "pointer" is an offset, and the GPU waits for the result instead of us.
+    GLState::BindBuffer(GL_QUERY_BUFFER, m_Command);
+    GLCall(glGetQueryObjectuiv(m_Query, GL_QUERY_RESULT, reinterpret_cast<GLuint*>(offsetof(DrawElementsIndirectCommand, instanceCount))));
+    GLState::BindBuffer(GL_QUERY_BUFFER, 0);
+  }
+  ++m_Stats.culls;
+  m_Stats.instancesTested += m_Count;
+}
+
+void InstanceCuller::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader){
+  if(!m_Program || m_Count == 0){
+    return;
+  }
+  shader.Bind();
+  va.Bind();
+  ib.Bind();
+  if(m_Source == InstanceCountSource::QueryBuffer){
+    //* Only count, instanceCount belongs to the query. firstIndex, baseVertex and baseInstance stay 0.
+    if(m_CommandIndexCount != ib.GetCount()){
+      m_CommandIndexCount = ib.GetCount();
+      GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_Command);
+      GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, offsetof(DrawElementsIndirectCommand, count), sizeof(m_CommandIndexCount), &m_CommandIndexCount));
+    }
+    GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_Command);
+    GLCall(glDrawElementsIndirect(GL_TRIANGLES, ib.GetType(), nullptr));
+  }else{
+    GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr, m_Count));
+  }
+  ++m_Stats.draws;
+}
+
+unsigned int InstanceCuller::ReadVisibleCount() const{
+  if(!m_Query || m_Stats.culls == 0){
+    return 0;
+  }
+  //* Cull leaves GL_QUERY_BUFFER unbound, so this one lands in count.
+  GLuint count = 0;
+  GLCall(glGetQueryObjectuiv(m_Query, GL_QUERY_RESULT, &count));
+  return count;
+}
+
+bool InstanceCuller::IsQueryBufferSupported(){
+  return GLAD_GL_ARB_query_buffer_object && GLAD_GL_ARB_draw_indirect;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "VertexBuffer.h"
+#include "VertexArray.h"
+#include "VertexLayout.h"
+#include "UniformLayout.h"
+
+class IndexBuffer;
+class Shader;
+
+//* One instance of the culled mesh, the inputs of res/shaders/feedback_cull.vert and what feedback_cull.geom captures.
+//* Only 32 bit floats, transform feedback can't write normalized bytes.
+struct CullInstance {
+  //* World position in xyz, uniform scale in w.
+  float placement[4];
+  float color[4];
+};
+VERTEX_LAYOUT(CullInstance, VERTEX_ATTRIB(CullInstance, placement), VERTEX_ATTRIB(CullInstance, color));
+
+enum class InstanceCountSource {
+  //* ARB_query_buffer_object + ARB_draw_indirect: the query writes the visible count into an indirect
+  //* command on the GPU, glDrawElementsIndirect draws exactly that many.
+  QueryBuffer,
+  //* Plain 3.3: the visible buffer is zeroed before every cull and all of its slots are drawn. The ones
+  //* past the visible count have scale 0 and produce no fragments, their vertices still run.
+  Padded,
+};
+
+struct InstanceCullerStats {
+  unsigned int culls = 0;
+  unsigned int draws = 0;
+  //* Instances handed to the cull pass, the GPU's verdict stays on the GPU.
+  unsigned int instancesTested = 0;
+};
+
+/*
+GPU instance culling without compute shaders. The instances go through a vertex + geometry shader pass as
+points with the rasterizer off. The geometry shader emits only the ones whose bounding sphere touches the
+frustum, and transform feedback packs them into GetVisible(). The instanced draw reads that buffer like any
+other instance buffer: va.AddBuffer<CullInstance>(culler.GetVisible(), 1) after the mesh's own attributes.
+The visible count never comes back to the CPU, see InstanceCountSource for where the draw gets it instead.
+glDrawTransformFeedbackInstanced doesn't help here, it takes the vertex count from the feedback, not the
+instance count.
+GL thread only.
+*/
+class InstanceCuller {
+public:
+  InstanceCuller(unsigned int maxInstances, bool allowQueryBuffer = true);
+  ~InstanceCuller();
+  InstanceCuller(const InstanceCuller&) = delete;
+  InstanceCuller& operator=(const InstanceCuller&) = delete;
+
+  //* Replaces every instance, at most maxInstances. Only needs calling again when they move.
+  void SetInstances(const CullInstance* instances, unsigned int count);
+  //* planes from IndirectRenderer::ExtractFrustumPlanes. radius is the mesh's bounding sphere at scale 1.
+  void Cull(const Vec4 planes[6], float radius);
+  //* ib gets bound into va here. Draws what the last Cull kept.
+  void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader);
+
+  //* Stalls until the last Cull is done, for checks and benchmarks only.
+  unsigned int ReadVisibleCount() const;
+
+  //* False when the cull program didn't build, the log went to stdout. Cull and Draw do nothing then.
+  inline bool IsValid() const { return m_Program != 0; }
+  inline const VertexBuffer& GetVisible() const { return m_Visible; }
+  inline InstanceCountSource GetCountSource() const { return m_Source; }
+  inline const InstanceCullerStats& GetStats() const { return m_Stats; }
+  inline void ResetStats() { m_Stats = InstanceCullerStats(); }
+  static bool IsQueryBufferSupported();
+private:
+  unsigned int m_MaxInstances;
+  unsigned int m_Count = 0;
+  InstanceCountSource m_Source;
+  VertexBuffer m_Instances;
+  VertexBuffer m_Visible;
+  //* Reads m_Instances one point per instance for the cull pass.
+  VertexArray m_CullArray;
+  unsigned int m_Program = 0;
+  int m_PlanesLocation = -1;
+  int m_RadiusLocation = -1;
+  unsigned int m_Query = 0;
+  //* Padded: maxInstances zeroed instances, copied over m_Visible before every cull.
+  unsigned int m_Zeros = 0;
+  //* QueryBuffer: one DrawElementsIndirectCommand, instanceCount filled in by the query.
+  unsigned int m_Command = 0;
+  unsigned int m_CommandIndexCount = 0;
+  InstanceCullerStats m_Stats;
+};
@@ -0,0 +1,292 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+static const unsigned int INVALID = 0xFFFFFFFF;
+
+//* Which triangles use each vertex, as one flat array with per vertex offsets.
+struct TriangleAdjacency {
+  std::vector<unsigned int> offsets;
+  std::vector<unsigned int> triangles;
+};
+
+static void BuildAdjacency(TriangleAdjacency& adjacency, const unsigned int* indices, size_t indexCount, size_t vertexCount){
+  adjacency.offsets.assign(vertexCount + 1, 0);
+  for(size_t i = 0; i < indexCount; ++i){
+    ++adjacency.offsets[indices[i] + 1];
+  }
+  for(size_t v = 0; v < vertexCount; ++v){
+    adjacency.offsets[v + 1] += adjacency.offsets[v];
+  }
+  adjacency.triangles.resize(indexCount);
+  std::vector<unsigned int> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+  for(size_t i = 0; i < indexCount; ++i){
+    adjacency.triangles[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+  }
+}
+
+/*
+Tipsify: fan around a vertex, emitting all its remaining triangles, then move to whichever vertex just emitted
+is still in cache and has the most left to emit. If none qualifies we're at a dead end and pop recent vertices
+off a stack, and if those are used up too, scan forward for any vertex with triangles left.
+Every triangle index where the next fan had to start cold (cache flushed) goes into hardBoundaries.
+*/
+static void Tipsify(std::vector<unsigned int>& out, const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize, std::vector<unsigned int>* hardBoundaries){
+  size_t triangleCount = indexCount / 3;
+  out.clear();
+  out.reserve(triangleCount * 3);
+  if(triangleCount == 0){
+    return;
+  }
+
+  TriangleAdjacency adjacency;
+  BuildAdjacency(adjacency, indices, indexCount, vertexCount);
+
+  std::vector<unsigned int> live(vertexCount);
+  for(size_t v = 0; v < vertexCount; ++v){
+    live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+  }
+  std::vector<unsigned int> cacheTime(vertexCount, 0);
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<unsigned int> deadEnd;
+  std::vector<unsigned int> candidates;
+
+  unsigned int timestamp = cacheSize + 1;
+  size_t cursor = 0;
+  unsigned int fan = 0;
+
+  while(fan != INVALID){
+    candidates.clear();
+    for(unsigned int a = adjacency.offsets[fan]; a < adjacency.offsets[fan + 1]; ++a){
+      unsigned int triangle = adjacency.triangles[a];
+      if(emitted[triangle]){
+        continue;
+      }
+      for(unsigned int k = 0; k < 3; ++k){
+        unsigned int v = indices[triangle * 3 + k];
+        out.push_back(v);
+        deadEnd.push_back(v);
+        candidates.push_back(v);
+        --live[v];
+        if(timestamp - cacheTime[v] > cacheSize){
+          cacheTime[v] = timestamp++;
+        }
+      }
+      emitted[triangle] = true;
+    }
+
+    //* Best next fan: still in cache after emitting its remaining triangles, and oldest in cache.
+    unsigned int next = INVALID;
+    int best = -1;
+    for(unsigned int v : candidates){
+      if(live[v] == 0){
+        continue;
+      }
+      int priority = 0;
+      if(timestamp - cacheTime[v] + 2 * live[v] <= cacheSize){
+        priority = static_cast<int>(timestamp - cacheTime[v]);
+      }
+      if(priority > best){
+        best = priority;
+        next = v;
+      }
+    }
+
+    if(next == INVALID){
+      while(!deadEnd.empty() && next == INVALID){
+        unsigned int v = deadEnd.back();
+        deadEnd.pop_back();
+        if(live[v] > 0){
+          next = v;
+        }
+      }
+      while(next == INVALID && cursor < vertexCount){
+        if(live[cursor] > 0){
+          next = static_cast<unsigned int>(cursor);
+        }
+        ++cursor;
+      }
+      if(hardBoundaries && next != INVALID && timestamp - cacheTime[next] > cacheSize){
+        hardBoundaries->push_back(static_cast<unsigned int>(out.size() / 3));
+      }
+    }
+    fan = next;
+  }
+}
+
+void MeshOptimizer::OptimizeVertexCache(unsigned int* dst, const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize){
+  std::vector<unsigned int> out;
+  Tipsify(out, indices, indexCount, vertexCount, cacheSize, nullptr);
+  memcpy(dst, out.data(), out.size() * sizeof(unsigned int));
+}
+
+void MeshOptimizer::OptimizeOverdraw(unsigned int* dst, const unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride, float threshold, unsigned int cacheSize){
+  size_t triangleCount = indexCount / 3;
+  std::vector<unsigned int> ordered;
+  std::vector<unsigned int> boundaries;
+  Tipsify(ordered, indices, indexCount, vertexCount, cacheSize, &boundaries);
+  if(triangleCount == 0){
+    return;
+  }
+
+  //* Soft boundaries: inside every hard cluster, cut again as soon as the cluster so far has a cache miss
+  //* ratio within threshold of the whole mesh, so sorting the smaller clusters costs little cache efficiency.
+  float meshAcmr = AnalyzeVertexCache(ordered.data(), ordered.size(), vertexCount, cacheSize).acmr;
+  boundaries.push_back(static_cast<unsigned int>(triangleCount));
+  std::vector<unsigned int> clusters;
+  std::vector<unsigned int> cacheTime(vertexCount, 0);
+  unsigned int timestamp = cacheSize + 1;
+  unsigned int start = 0;
+  for(unsigned int end : boundaries){
+    if(end <= start){
+      continue;
+    }
+    clusters.push_back(start);
+    timestamp += cacheSize + 1;
+    unsigned int clusterStart = start;
+    unsigned int misses = 0;
+    for(unsigned int t = start; t < end; ++t){
+      for(unsigned int k = 0; k < 3; ++k){
+        unsigned int v = ordered[t * 3 + k];
+        if(timestamp - cacheTime[v] > cacheSize){
+          cacheTime[v] = timestamp++;
+          ++misses;
+        }
+      }
+      unsigned int triangles = t - clusterStart + 1;
+      if(t + 1 < end && static_cast<float>(misses) / triangles <= meshAcmr * threshold){
+        clusters.push_back(t + 1);
+        clusterStart = t + 1;
+        misses = 0;
+        timestamp += cacheSize + 1;
+      }
+    }
+    start = end;
+  }
+  clusters.push_back(static_cast<unsigned int>(triangleCount));
+
+  auto position = [&](unsigned int v) {
+    return reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(positions) + v * positionStride);
+  };
+
+  //* Area weighted centroid of the whole mesh.
+  float meshCenter[3] = { 0.0f, 0.0f, 0.0f };
+  float meshArea = 0.0f;
+  std::vector<float> centers((clusters.size() - 1) * 3, 0.0f);
+  std::vector<float> normals((clusters.size() - 1) * 3, 0.0f);
+  std::vector<float> areas(clusters.size() - 1, 0.0f);
+  for(size_t c = 0; c + 1 < clusters.size(); ++c){
+    for(unsigned int t = clusters[c]; t < clusters[c + 1]; ++t){
+      const float* p0 = position(ordered[t * 3 + 0]);
+      const float* p1 = position(ordered[t * 3 + 1]);
+      const float* p2 = position(ordered[t * 3 + 2]);
+      float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+      float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+      float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+      float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+      for(unsigned int k = 0; k < 3; ++k){
+        float center = (p0[k] + p1[k] + p2[k]) / 3.0f;
+        centers[c * 3 + k] += center * area;
+        normals[c * 3 + k] += n[k];
+        meshCenter[k] += center * area;
+      }
+      areas[c] += area;
+      meshArea += area;
+    }
+  }
+  for(unsigned int k = 0; k < 3; ++k){
+    meshCenter[k] = meshArea > 0.0f ? meshCenter[k] / meshArea : 0.0f;
+  }
+
+  //* How far out along its own facing direction a cluster sits. Outermost clusters get drawn first.
+  std::vector<float> sortKeys(clusters.size() - 1);
+  for(size_t c = 0; c + 1 < clusters.size(); ++c){
+    float* n = &normals[c * 3];
+    float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    float key = 0.0f;
+    if(areas[c] > 0.0f && length > 0.0f){
+      for(unsigned int k = 0; k < 3; ++k){
+        key += (centers[c * 3 + k] / areas[c] - meshCenter[k]) * (n[k] / length);
+      }
+    }
+    sortKeys[c] = key;
+  }
+
+  std::vector<unsigned int> order(clusters.size() - 1);
+  for(size_t c = 0; c < order.size(); ++c){
+    order[c] = static_cast<unsigned int>(c);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) { return sortKeys[a] > sortKeys[b]; });
+
+  unsigned int* out = dst;
+  for(unsigned int c : order){
+    size_t count = (clusters[c + 1] - clusters[c]) * 3;
+    memcpy(out, &ordered[clusters[c] * 3], count * sizeof(unsigned int));
+    out += count;
+  }
+}
+
+size_t MeshOptimizer::OptimizeVertexFetch(void* dstVertices, unsigned int* indices, size_t indexCount, const void* vertices, size_t vertexCount, size_t vertexSize){
+  //! dstVertices can't be the same memory as vertices, old vertices are still read after new ones are written.
+  std::vector<unsigned int> remap(vertexCount, INVALID);
+  unsigned int next = 0;
+  unsigned char* dst = static_cast<unsigned char*>(dstVertices);
+  const unsigned char* src = static_cast<const unsigned char*>(vertices);
+
+  for(size_t i = 0; i < indexCount; ++i){
+    unsigned int v = indices[i];
+    if(remap[v] == INVALID){
+      memcpy(dst + next * vertexSize, src + v * vertexSize, vertexSize);
+      remap[v] = next++;
+    }
+    indices[i] = remap[v];
+  }
+  return next;
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize){
+  VertexCacheStats stats;
+  std::vector<unsigned int> cacheTime(vertexCount, 0);
+  unsigned int timestamp = cacheSize + 1;
+
+  for(size_t i = 0; i < indexCount; ++i){
+    unsigned int v = indices[i];
+    //* FIFO: hits don't refresh the entry, it leaves cacheSize misses after it came in.
+    if(timestamp - cacheTime[v] > cacheSize){
+      cacheTime[v] = timestamp++;
+      ++stats.verticesTransformed;
+    }
+  }
+
+  size_t triangleCount = indexCount / 3;
+  stats.acmr = triangleCount ? static_cast<float>(stats.verticesTransformed) / triangleCount : 0.0f;
+  stats.atvr = vertexCount ? static_cast<float>(stats.verticesTransformed) / vertexCount : 0.0f;
+  return stats;
+}
+
+VertexFetchStats MeshOptimizer::AnalyzeVertexFetch(const unsigned int* indices, size_t indexCount, size_t vertexCount, size_t vertexSize){
+  static const size_t LINE_SIZE = 64;
+  static const size_t LINE_COUNT = 128;
+
+  VertexFetchStats stats;
+  std::vector<size_t> tags(LINE_COUNT, ~size_t(0));
+
+  for(size_t i = 0; i < indexCount; ++i){
+    size_t start = indices[i] * vertexSize;
+    size_t end = start + vertexSize - 1;
+    for(size_t line = start / LINE_SIZE; line <= end / LINE_SIZE; ++line){
+      size_t slot = line % LINE_COUNT;
+      if(tags[slot] != line){
+        tags[slot] = line;
+        stats.bytesFetched += LINE_SIZE;
+      }
+    }
+  }
+
+  size_t bufferSize = vertexCount * vertexSize;
+  stats.overfetch = bufferSize ? static_cast<float>(stats.bytesFetched) / bufferSize : 0.0f;
+  return stats;
+}
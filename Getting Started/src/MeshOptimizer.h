@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+
+struct VertexCacheStats {
+  unsigned int verticesTransformed = 0;
+  //* Average cache miss ratio, transformed vertices per triangle. 0.5 is the best a grid can do, 3 the worst.
+  float acmr = 0.0f;
+  //* Average transformed to vertex ratio, 1 means every vertex was shaded exactly once.
+  float atvr = 0.0f;
+};
+
+struct VertexFetchStats {
+  unsigned long long bytesFetched = 0;
+  //* bytesFetched / size of the vertex buffer, 1 means every byte was pulled from memory once.
+  float overfetch = 0.0f;
+};
+
+/*
+Reorders index and vertex data on the CPU before it gets uploaded. Nothing in here touches GL, so it runs in
+tools and on machines without a GPU. The usual order is VertexCache -> Overdraw -> VertexFetch, since each
+step keeps most of what the previous one did.
+All index arrays are 32 bit triangle lists, narrowing happens later in IndexBuffer.
+dst can be the same array as indices everywhere.
+*/
+class MeshOptimizer {
+public:
+  //* Post transform cache ordering (Tipsify, Sander et al. 2007), tuned for a cache of cacheSize vertices.
+  static void OptimizeVertexCache(unsigned int* dst, const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = 16);
+
+  /*
+  Splits the cache optimized triangle order into clusters and sorts the clusters so the ones facing away from
+  the mesh center come first, which lets early z reject more of what's drawn after them.
+  threshold is how much worse the ACMR is allowed to get to make more, smaller clusters (1.05 = 5%).
+  positions are 3 floats every positionStride bytes.
+  */
+  static void OptimizeOverdraw(unsigned int* dst, const unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride, float threshold = 1.05f, unsigned int cacheSize = 16);
+
+  //* Rewrites vertices in the order the indices first use them and remaps the indices to match.
+  //* Unused vertices are dropped. Returns how many vertices ended up in dstVertices.
+  static size_t OptimizeVertexFetch(void* dstVertices, unsigned int* indices, size_t indexCount, const void* vertices, size_t vertexCount, size_t vertexSize);
+
+  //* FIFO cache simulation, like the fixed function post transform caches this ordering targets.
+  static VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = 16);
+  //* Simulates a small direct mapped cache of 64 byte lines in front of the vertex buffer.
+  static VertexFetchStats AnalyzeVertexFetch(const unsigned int* indices, size_t indexCount, size_t vertexCount, size_t vertexSize);
+};
@@ -0,0 +1,301 @@
+#include "OffsetAllocator.h"
+
+#include <bit>
+
+#include "renderer.h"
+
+//* Sizes are binned with 3 mantissa bits, so every power of two range is split into 8 bins.
+static const unsigned int MANTISSA_BITS = 3;
+static const unsigned int MANTISSA_VALUE = 1 << MANTISSA_BITS;
+static const unsigned int MANTISSA_MASK = MANTISSA_VALUE - 1;
+
+//* Bin for an allocation request, rounded up so every region in it is guaranteed to fit.
+static unsigned int SizeToBinRoundUp(unsigned int size){
+  unsigned int exp = 0;
+  unsigned int mantissa = 0;
+  if(size < MANTISSA_VALUE){
+    mantissa = size;
+  }else{
+    unsigned int highestSetBit = 31 - std::countl_zero(size);
+    unsigned int mantissaStartBit = highestSetBit - MANTISSA_BITS;
+    exp = mantissaStartBit + 1;
+    mantissa = (size >> mantissaStartBit) & MANTISSA_MASK;
+    unsigned int lowBitsMask = (1u << mantissaStartBit) - 1;
+    if((size & lowBitsMask) != 0){
+      ++mantissa;
+    }
+  }
+  //* + instead of | so a mantissa overflow carries into the exponent.
+  return (exp << MANTISSA_BITS) + mantissa;
+}
+
+//* Bin for a free region, rounded down so the region is at least as big as the bin says.
+static unsigned int SizeToBinRoundDown(unsigned int size){
+  unsigned int exp = 0;
+  unsigned int mantissa = 0;
+  if(size < MANTISSA_VALUE){
+    mantissa = size;
+  }else{
+    unsigned int highestSetBit = 31 - std::countl_zero(size);
+    unsigned int mantissaStartBit = highestSetBit - MANTISSA_BITS;
+    exp = mantissaStartBit + 1;
+    mantissa = (size >> mantissaStartBit) & MANTISSA_MASK;
+  }
+  return (exp << MANTISSA_BITS) | mantissa;
+}
+
+//* Smallest size that lands in bin, the inverse of the two above for sizes on a bin boundary.
+static unsigned long long BinToSize(unsigned int bin){
+  unsigned int exp = bin >> MANTISSA_BITS;
+  unsigned long long mantissa = bin & MANTISSA_MASK;
+  if(exp == 0){
+    return mantissa;
+  }
+  return (mantissa | MANTISSA_VALUE) << (exp - 1);
+}
+
+static unsigned int FindLowestSetBitAfter(unsigned int mask, unsigned int start){
+  if(start >= 32){
+    return OffsetAllocator::NO_SPACE;
+  }
+  unsigned int after = mask & ~((1u << start) - 1);
+  if(after == 0){
+    return OffsetAllocator::NO_SPACE;
+  }
+  return std::countr_zero(after);
+}
+
+unsigned int OffsetAllocator::RoundUpToBinSize(unsigned int size){
+  unsigned long long rounded = BinToSize(SizeToBinRoundUp(size));
+  return rounded < NO_SPACE ? static_cast<unsigned int>(rounded) : NO_SPACE;
+}
+
+OffsetAllocator::OffsetAllocator(unsigned int size){
+  Reset(size);
+}
+
+void OffsetAllocator::Reset(unsigned int size){
+  m_size = size;
+  m_freeStorage = 0;
+  m_freeRegions = 0;
+  m_allocations = 0;
+  m_usedBinsTop = 0;
+  for(unsigned int i = 0; i < NUM_TOP_BINS; ++i){
+    m_usedBins[i] = 0;
+  }
+  for(unsigned int i = 0; i < NUM_LEAF_BINS; ++i){
+    m_binIndices[i] = UNUSED;
+  }
+  m_nodes.clear();
+  m_freeNodes.clear();
+
+  if(size > 0){
+    InsertNodeIntoBin(size, 0);
+  }
+}
+
+unsigned int OffsetAllocator::NewNode(){
+  if(!m_freeNodes.empty()){
+    unsigned int index = m_freeNodes.back();
+    m_freeNodes.pop_back();
+    return index;
+  }
+  m_nodes.emplace_back();
+  return static_cast<unsigned int>(m_nodes.size() - 1);
+}
+
+OffsetAllocation OffsetAllocator::Allocate(unsigned int size){
+  if(size == 0){
+    size = 1;
+  }
+
+  //* Smallest bin where every region is big enough, then the first non empty bin at or after it.
+  unsigned int minBinIndex = SizeToBinRoundUp(size);
+  unsigned int minTopBin = minBinIndex / BINS_PER_LEAF;
+  unsigned int minLeafBin = minBinIndex % BINS_PER_LEAF;
+
+  unsigned int topBin = minTopBin;
+  unsigned int leafBin = NO_SPACE;
+  if(minTopBin < NUM_TOP_BINS && (m_usedBinsTop & (1u << topBin))){
+    leafBin = FindLowestSetBitAfter(m_usedBins[topBin], minLeafBin);
+  }
+  if(leafBin == NO_SPACE){
+    topBin = FindLowestSetBitAfter(m_usedBinsTop, minTopBin + 1);
+    if(topBin == NO_SPACE){
+      return { NO_SPACE, NO_SPACE };
+    }
+    leafBin = std::countr_zero(static_cast<unsigned int>(m_usedBins[topBin]));
+  }
+
+  unsigned int binIndex = topBin * BINS_PER_LEAF + leafBin;
+  unsigned int nodeIndex = m_binIndices[binIndex];
+
+  Node& node = m_nodes[nodeIndex];
+  unsigned int nodeTotalSize = node.dataSize;
+  unsigned int nodeOffset = node.dataOffset;
+  node.dataSize = size;
+  node.used = true;
+
+  //* Pop it off the bin's list.
+  m_binIndices[binIndex] = node.binListNext;
+  if(node.binListNext != UNUSED){
+    m_nodes[node.binListNext].binListPrev = UNUSED;
+  }
+  node.binListNext = UNUSED;
+  m_freeStorage -= nodeTotalSize;
+  --m_freeRegions;
+  ++m_allocations;
+
+  if(m_binIndices[binIndex] == UNUSED){
+    m_usedBins[topBin] &= ~(1u << leafBin);
+    if(m_usedBins[topBin] == 0){
+      m_usedBinsTop &= ~(1u << topBin);
+    }
+  }
+
+  //* Hand whatever is left over back as a new free region right after us.
+  unsigned int remainder = nodeTotalSize - size;
+  if(remainder > 0){
+    //! InsertNodeIntoBin can grow m_nodes, don't hold on to node across it.
+    unsigned int newNodeIndex = InsertNodeIntoBin(remainder, nodeOffset + size);
+    unsigned int neighborNext = m_nodes[nodeIndex].neighborNext;
+    if(neighborNext != UNUSED){
+      m_nodes[neighborNext].neighborPrev = newNodeIndex;
+    }
+    m_nodes[newNodeIndex].neighborPrev = nodeIndex;
+    m_nodes[newNodeIndex].neighborNext = neighborNext;
+    m_nodes[nodeIndex].neighborNext = newNodeIndex;
+  }
+
+  return { nodeOffset, nodeIndex };
+}
+
+void OffsetAllocator::Free(OffsetAllocation allocation){
+  if(allocation.node == NO_SPACE){
+    return;
+  }
+  //* Freeing twice, or a node that isn't at this offset, would corrupt the bins and the neighbor links.
+  bool allocated = allocation.node < m_nodes.size() && m_nodes[allocation.node].used && m_nodes[allocation.node].dataOffset == allocation.offset;
+#ifndef NDEBUG
+  ASSERT(allocated);
+#endif
+  if(!allocated){
+    return;
+  }
+  unsigned int nodeIndex = allocation.node;
+  unsigned int offset = m_nodes[nodeIndex].dataOffset;
+  unsigned int size = m_nodes[nodeIndex].dataSize;
+
+  //* Merge with the free neighbors on either side.
+  unsigned int prev = m_nodes[nodeIndex].neighborPrev;
+  if(prev != UNUSED && !m_nodes[prev].used){
+    offset = m_nodes[prev].dataOffset;
+    size += m_nodes[prev].dataSize;
+    m_nodes[nodeIndex].neighborPrev = m_nodes[prev].neighborPrev;
+    RemoveNodeFromBin(prev);
+  }
+  unsigned int next = m_nodes[nodeIndex].neighborNext;
+  if(next != UNUSED && !m_nodes[next].used){
+    size += m_nodes[next].dataSize;
+    m_nodes[nodeIndex].neighborNext = m_nodes[next].neighborNext;
+    RemoveNodeFromBin(next);
+  }
+
+  unsigned int neighborPrev = m_nodes[nodeIndex].neighborPrev;
+  unsigned int neighborNext = m_nodes[nodeIndex].neighborNext;
+  m_nodes[nodeIndex] = Node();
+  m_freeNodes.push_back(nodeIndex);
+  --m_allocations;
+
+  unsigned int combined = InsertNodeIntoBin(size, offset);
+  if(neighborNext != UNUSED){
+    m_nodes[combined].neighborNext = neighborNext;
+    m_nodes[neighborNext].neighborPrev = combined;
+  }
+  if(neighborPrev != UNUSED){
+    m_nodes[combined].neighborPrev = neighborPrev;
+    m_nodes[neighborPrev].neighborNext = combined;
+  }
+}
+
+unsigned int OffsetAllocator::InsertNodeIntoBin(unsigned int size, unsigned int dataOffset){
+  unsigned int binIndex = SizeToBinRoundDown(size);
+  unsigned int topBin = binIndex / BINS_PER_LEAF;
+  unsigned int leafBin = binIndex % BINS_PER_LEAF;
+
+  if(m_binIndices[binIndex] == UNUSED){
+    m_usedBins[topBin] |= 1u << leafBin;
+    m_usedBinsTop |= 1u << topBin;
+  }
+
+  unsigned int topNodeIndex = m_binIndices[binIndex];
+  unsigned int nodeIndex = NewNode();
+  Node& node = m_nodes[nodeIndex];
+  node = Node();
+  node.dataOffset = dataOffset;
+  node.dataSize = size;
+  node.binListNext = topNodeIndex;
+  if(topNodeIndex != UNUSED){
+    m_nodes[topNodeIndex].binListPrev = nodeIndex;
+  }
+  m_binIndices[binIndex] = nodeIndex;
+
+  m_freeStorage += size;
+  ++m_freeRegions;
+  return nodeIndex;
+}
+
+void OffsetAllocator::RemoveNodeFromBin(unsigned int nodeIndex){
+  Node& node = m_nodes[nodeIndex];
+
+  if(node.binListPrev != UNUSED){
+    //* Somewhere in the middle of the list, just unlink.
+    m_nodes[node.binListPrev].binListNext = node.binListNext;
+    if(node.binListNext != UNUSED){
+      m_nodes[node.binListNext].binListPrev = node.binListPrev;
+    }
+  }else{
+    //* Head of the list, the bin itself points at it.
+    unsigned int binIndex = SizeToBinRoundDown(node.dataSize);
+    unsigned int topBin = binIndex / BINS_PER_LEAF;
+    unsigned int leafBin = binIndex % BINS_PER_LEAF;
+
+    m_binIndices[binIndex] = node.binListNext;
+    if(node.binListNext != UNUSED){
+      m_nodes[node.binListNext].binListPrev = UNUSED;
+    }
+    if(m_binIndices[binIndex] == UNUSED){
+      m_usedBins[topBin] &= ~(1u << leafBin);
+      if(m_usedBins[topBin] == 0){
+        m_usedBinsTop &= ~(1u << topBin);
+      }
+    }
+  }
+
+  m_freeStorage -= node.dataSize;
+  --m_freeRegions;
+  node = Node();
+  m_freeNodes.push_back(nodeIndex);
+}
+
+unsigned int OffsetAllocator::GetAllocationSize(OffsetAllocation allocation) const{
+  if(allocation.node == NO_SPACE){
+    return 0;
+  }
+  return m_nodes[allocation.node].dataSize;
+}
+
+OffsetAllocatorStats OffsetAllocator::GetStats() const{
+  OffsetAllocatorStats stats = { m_freeStorage, 0, m_freeRegions, m_allocations };
+  if(m_usedBinsTop){
+    //* The biggest region is somewhere in the highest non empty bin, walk that one list.
+    unsigned int topBin = 31 - std::countl_zero(m_usedBinsTop);
+    unsigned int leafBin = 31 - std::countl_zero(static_cast<unsigned int>(m_usedBins[topBin]));
+    for(unsigned int i = m_binIndices[topBin * BINS_PER_LEAF + leafBin]; i != UNUSED; i = m_nodes[i].binListNext){
+      if(m_nodes[i].dataSize > stats.largestFree){
+        stats.largestFree = m_nodes[i].dataSize;
+      }
+    }
+  }
+  return stats;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+
+struct OffsetAllocation {
+  unsigned int offset;
+  //* Node index inside the allocator, hand it back to Free().
+  unsigned int node;
+};
+
+struct OffsetAllocatorStats {
+  unsigned int totalFree;
+  unsigned int largestFree;
+  unsigned int freeRegions;
+  unsigned int allocations;
+};
+
+/*
+Two level segregated fit (TLSF) allocator over a range of offsets, it never touches the memory itself.
+Free regions are sorted into 256 bins by a tiny 5.3 floating point encoding of their size, and two levels of
+bitmasks say which bins have anything in them, so Allocate and Free are O(1) (a couple of bit scans).
+Freed regions merge with free neighbors right away.
+Sizes are in whatever unit the caller likes, BufferHeap uses multiples of its granularity.
+*/
+class OffsetAllocator {
+public:
+  static const unsigned int NO_SPACE = 0xFFFFFFFF;
+
+  OffsetAllocator(unsigned int size = 0);
+
+  //* Returns { NO_SPACE, NO_SPACE } when there isn't a free region big enough.
+  OffsetAllocation Allocate(unsigned int size);
+  //* Traps in debug builds on a double free or an allocation from somewhere else, release builds ignore it.
+  void Free(OffsetAllocation allocation);
+  void Reset(unsigned int size);
+
+  unsigned int GetSize() const { return m_size; }
+  unsigned int GetAllocationSize(OffsetAllocation allocation) const;
+  OffsetAllocatorStats GetStats() const;
+
+  //* Allocate rounds requests up to a bin, so a single free region only satisfies size if it's at least this big.
+  //* An allocator made for one allocation of size needs this size. NO_SPACE when it doesn't fit in 32 bits.
+  static unsigned int RoundUpToBinSize(unsigned int size);
+private:
+  static const unsigned int NUM_TOP_BINS = 32;
+  static const unsigned int BINS_PER_LEAF = 8;
+  static const unsigned int NUM_LEAF_BINS = NUM_TOP_BINS * BINS_PER_LEAF;
+  static const unsigned int UNUSED = 0xFFFFFFFF;
+
+  struct Node {
+    unsigned int dataOffset = 0;
+    unsigned int dataSize = 0;
+    unsigned int binListPrev = UNUSED;
+    unsigned int binListNext = UNUSED;
+    unsigned int neighborPrev = UNUSED;
+    unsigned int neighborNext = UNUSED;
+    bool used = false;
+  };
+
+  unsigned int InsertNodeIntoBin(unsigned int size, unsigned int dataOffset);
+  void RemoveNodeFromBin(unsigned int nodeIndex);
+  unsigned int NewNode();
+
+  unsigned int m_size;
+  unsigned int m_freeStorage;
+  unsigned int m_freeRegions;
+  unsigned int m_allocations;
+  unsigned int m_usedBinsTop;
+  unsigned char m_usedBins[NUM_TOP_BINS];
+  unsigned int m_binIndices[NUM_LEAF_BINS];
+  std::vector<Node> m_nodes;
+  std::vector<unsigned int> m_freeNodes;
+};
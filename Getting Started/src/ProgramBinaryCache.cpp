@@ -0,0 +1,227 @@
+#include "ProgramBinaryCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "renderer.h"
+#include "GLExtensions.h"
+#include "FileLoader.h"
+
+//* Bump when the file layout changes so old entries get rejected instead of misread.
+static const unsigned int FILE_VERSION = 1;
+
+struct ProgramBinaryHeader {
+  char magic[4];
+  unsigned int version;
+  unsigned long long key;
+  unsigned int format;
+  unsigned int length;
+  unsigned long long checksum;
+};
+
+static std::string s_Directory = "shader_cache";
+static ProgramBinaryCacheStats s_Stats;
+//* -1 until the first call that needs a context, the driver can't change under a running process.
+static int s_Supported = -1;
+static std::vector<GLint> s_Formats;
+static unsigned long long s_DriverHash = 0;
+static bool s_HaveDriverHash = false;
+
+static unsigned long long Fnv1a(const void* data, size_t size, unsigned long long hash = 14695981039346656037ull){
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for(size_t i = 0; i < size; ++i){
+    hash = (hash ^ bytes[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+static unsigned long long HashString(const char* text, unsigned long long hash){
+  //* The terminator goes in too, so "ab" + "c" and "a" + "bc" don't collide.
+  return text ? Fnv1a(text, strlen(text) + 1, hash) : Fnv1a("", 1, hash);
+}
+
+static unsigned long long DriverHash(){
+  if(!s_HaveDriverHash){
+    unsigned long long hash = 14695981039346656037ull;
+    hash = HashString(reinterpret_cast<const char*>(glGetString(GL_VENDOR)), hash);
+    hash = HashString(reinterpret_cast<const char*>(glGetString(GL_RENDERER)), hash);
+    hash = HashString(reinterpret_cast<const char*>(glGetString(GL_VERSION)), hash);
+    s_DriverHash = hash;
+    s_HaveDriverHash = true;
+  }
+  return s_DriverHash;
+}
+
+static std::string EntryPath(unsigned long long key){
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.bin", key);
+  return (std::filesystem::path(s_Directory) / name).string();
+}
+
+//* Corrupt or refused entries get removed so the next Store can replace them.
+static void Reject(const std::string& path){
+  std::error_code error;
+  std::filesystem::remove(path, error);
+  ++s_Stats.rejected;
+}
+
+void ProgramBinaryCache::SetDirectory(const std::string& directory){
+  s_Directory = directory;
+}
+
+const std::string& ProgramBinaryCache::GetDirectory(){
+  return s_Directory;
+}
+
+bool ProgramBinaryCache::IsSupported(){
+  if(s_Supported < 0){
+    s_Supported = 0;
+    if(GLAD_GL_ARB_get_program_binary){
+      //* Some drivers expose the entry points but no formats, then there's nothing to save.
+      GLint count = 0;
+      GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count));
+      if(count > 0){
+        s_Formats.resize(count);
+        GLCall(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, s_Formats.data()));
+        s_Supported = 1;
+      }
+    }
+  }
+  return s_Supported == 1;
+}
+
+void ProgramBinaryCache::HintRetrievable(unsigned int program){
+  if(IsSupported()){
+    GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+  }
+}
+
+unsigned long long ProgramBinaryCache::MakeKey(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines){
+  unsigned long long hash = DriverHash();
+  hash = Fnv1a(&FILE_VERSION, sizeof(FILE_VERSION), hash);
+  hash = HashString(vertexSource.c_str(), hash);
+  hash = HashString(fragmentSource.c_str(), hash);
+  hash = HashString(defines.c_str(), hash);
+  return hash;
+}
+
+unsigned int ProgramBinaryCache::Load(unsigned long long key){
+  if(!IsSupported()){
+    ++s_Stats.misses;
+    return 0;
+  }
+  std::string path = EntryPath(key);
+  //* A missing entry is an ordinary miss, not worth an error.
+  FileData file = FileLoader::LoadIfExists(path);
+  if(!file.IsValid()){
+    ++s_Stats.misses;
+    return 0;
+  }
+
+  ProgramBinaryHeader header;
+  if(file.GetSize() < sizeof(header)){
+    Reject(path);
+    return 0;
+  }
+  memcpy(&header, file.GetData(), sizeof(header));
+  if(memcmp(header.magic, "PGB1", 4) != 0 || header.version != FILE_VERSION || header.key != key || header.length == 0){
+    Reject(path);
+    return 0;
+  }
+  //* The binary goes to the driver straight out of the loaded file, no copy.
+  const char* binary = file.GetData() + sizeof(header);
+  if(file.GetSize() - sizeof(header) != header.length || Fnv1a(binary, header.length) != header.checksum){
+    Reject(path);
+    return 0;
+  }
+  //* glProgramBinary raises INVALID_ENUM for a format this driver doesn't know, check it ourselves first.
+  if(std::find(s_Formats.begin(), s_Formats.end(), static_cast<GLint>(header.format)) == s_Formats.end()){
+    Reject(path);
+    return 0;
+  }
+
+  unsigned int program = glCreateProgram();
+  GLCall(glProgramBinary(program, header.format, binary, static_cast<GLsizei>(header.length)));
+  //* A driver that doesn't like the binary says so through the link status, not an error.
+  GLint linked = GL_FALSE;
+  GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+  if(!linked){
+    GLCall(glDeleteProgram(program));
+    Reject(path);
+    return 0;
+  }
+  ++s_Stats.hits;
+  return program;
+}
+
+void ProgramBinaryCache::Store(unsigned long long key, unsigned int program){
+  if(!IsSupported()){
+    return;
+  }
+  GLint linked = GL_FALSE;
+  GLint length = 0;
+  GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+  GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+  if(!linked || length <= 0){
+    return;
+  }
+
+  std::vector<char> binary(length);
+  GLenum format = 0;
+  GLCall(glGetProgramBinary(program, length, &length, &format, binary.data()));
+  binary.resize(length);
+
+  ProgramBinaryHeader header;
+  memcpy(header.magic, "PGB1", 4);
+  header.version = FILE_VERSION;
+  header.key = key;
+  header.format = format;
+  header.length = static_cast<unsigned int>(binary.size());
+  header.checksum = Fnv1a(binary.data(), binary.size());
+
+  std::error_code error;
+  std::filesystem::create_directories(s_Directory, error);
+  //* Written next to the entry and renamed over it, so a crash mid write never leaves a half entry behind.
+  std::string path = EntryPath(key);
+  std::string temporary = path + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if(!file){
+      return;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), binary.size());
+    if(!file){
+      file.close();
+      std::filesystem::remove(temporary, error);
+      return;
+    }
+  }
+  std::filesystem::rename(temporary, path, error);
+  if(error){
+    std::filesystem::remove(temporary, error);
+    return;
+  }
+  ++s_Stats.stored;
+}
+
+void ProgramBinaryCache::Clear(){
+  std::error_code error;
+  for(const auto& entry : std::filesystem::directory_iterator(s_Directory, error)){
+    if(entry.path().extension() == ".bin"){
+      std::filesystem::remove(entry.path(), error);
+    }
+  }
+}
+
+const ProgramBinaryCacheStats& ProgramBinaryCache::GetStats(){
+  return s_Stats;
+}
+
+void ProgramBinaryCache::ResetStats(){
+  s_Stats = ProgramBinaryCacheStats();
+}
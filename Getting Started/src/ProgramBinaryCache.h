@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+
+struct ProgramBinaryCacheStats {
+  unsigned int hits = 0;
+  unsigned int misses = 0;
+  //* Entries that were there but unusable: truncated, checksum mismatch, or the driver refused the binary.
+  unsigned int rejected = 0;
+  unsigned int stored = 0;
+};
+
+/*
+Linked programs saved to disk with glGetProgramBinary and loaded back with glProgramBinary, so the next
+launch skips compiling and linking. One file per program, named after the key.
+The key hashes the stage sources, the defines and GL_VENDOR / GL_RENDERER / GL_VERSION, so a driver update
+or an edited shader just misses. Anything that goes wrong on load deletes the entry and returns 0, and the
+caller compiles from source like before.
+Needs ARB_get_program_binary (4.1) and at least one binary format, otherwise every Load misses and Store does nothing.
+GL thread only.
+*/
+class ProgramBinaryCache {
+public:
+  //* Defaults to "shader_cache" next to the working directory. Created on the first Store.
+  static void SetDirectory(const std::string& directory);
+  static const std::string& GetDirectory();
+  static bool IsSupported();
+
+  static unsigned long long MakeKey(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines = "");
+  //* Returns a linked program, or 0 on a miss.
+  static unsigned int Load(unsigned long long key);
+  //* program has to be linked, and should have had GL_PROGRAM_BINARY_RETRIEVABLE_HINT set before linking.
+  static void Store(unsigned long long key, unsigned int program);
+  //* Sets that hint when the cache is supported, some drivers only keep the binary around if it was. Pass it as ShaderStages::Link's beforeLink.
+  static void HintRetrievable(unsigned int program);
+  //* Deletes every entry in the directory.
+  static void Clear();
+
+  static const ProgramBinaryCacheStats& GetStats();
+  static void ResetStats();
+};
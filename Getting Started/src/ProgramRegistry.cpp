@@ -0,0 +1,45 @@
+#include "ProgramRegistry.h"
+
+#include <unordered_map>
+
+#include "ShaderCompiler.h"
+
+//* Node based, so the SharedProgram pointers handed out don't move when the map grows.
+static std::unordered_map<unsigned long long, SharedProgram> s_Programs;
+static ProgramRegistryStats s_Stats;
+
+unsigned long long ProgramRegistry::MakeKey(unsigned long long vertexHash, unsigned long long fragmentHash){
+  //* Order matters, swapping the stages has to give a different program.
+  return vertexHash * 1099511628211ull ^ (fragmentHash + 0x9E3779B97F4A7C15ull + (vertexHash << 6) + (vertexHash >> 2));
+}
+
+SharedProgram* ProgramRegistry::Acquire(unsigned long long key){
+  ++s_Stats.acquires;
+  SharedProgram& shared = s_Programs[key];
+  if(shared.refs == 0){
+    shared.key = key;
+    ++s_Stats.compiles;
+  }
+  ++shared.refs;
+  return &shared;
+}
+
+void ProgramRegistry::Release(SharedProgram* shared){
+  if(!shared || --shared->refs > 0){
+    return;
+  }
+  ShaderCompiler::Release(shared->program);
+  s_Programs.erase(shared->key);
+}
+
+unsigned int ProgramRegistry::GetProgramCount(){
+  return static_cast<unsigned int>(s_Programs.size());
+}
+
+const ProgramRegistryStats& ProgramRegistry::GetStats(){
+  return s_Stats;
+}
+
+void ProgramRegistry::ResetStats(){
+  s_Stats = ProgramRegistryStats();
+}
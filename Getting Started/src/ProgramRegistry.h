@@ -0,0 +1,34 @@
+#pragma once
+
+struct SharedProgram {
+  unsigned long long key = 0;
+  //* 0 right after the first Acquire of a key, the caller compiles and fills it in.
+  unsigned int program = 0;
+  unsigned int refs = 0;
+  //* The Shader whose uniform shadow matches what GL holds for this program. See Shader::ClaimUniforms.
+  const void* uniformOwner = nullptr;
+};
+
+struct ProgramRegistryStats {
+  unsigned int acquires = 0;
+  //* Acquires that found nothing and had to compile. acquires - compiles were shared.
+  unsigned int compiles = 0;
+};
+
+/*
+Every program Shader has alive, keyed by the hash of its preprocessed stage sources. Two Shaders built
+from the same files and defines share one GL program, compiled once, and it's deleted when the last one lets go.
+Pointers from Acquire stay valid until that Release.
+GL thread only.
+*/
+class ProgramRegistry {
+public:
+  static unsigned long long MakeKey(unsigned long long vertexHash, unsigned long long fragmentHash);
+  static SharedProgram* Acquire(unsigned long long key);
+  //* Goes through ShaderCompiler::Release, which waits out a compile still running before deleting.
+  static void Release(SharedProgram* shared);
+
+  static unsigned int GetProgramCount();
+  static const ProgramRegistryStats& GetStats();
+  static void ResetStats();
+};
@@ -0,0 +1,149 @@
+#include "QuadBatch.h"
+
+#include <cmath>
+#include <string>
+
+#include "renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+
+static const unsigned int QUAD_BYTES = 4 * sizeof(BatchVertex);
+
+//* 0 1 2, 2 3 0 for every quad, each quad's corners four further along.
+static std::vector<unsigned int> MakeQuadIndices(){
+  std::vector<unsigned int> indices(QuadBatch::MAX_QUADS * 6);
+  for(unsigned int quad = 0; quad < QuadBatch::MAX_QUADS; ++quad){
+    unsigned int corner = quad * 4;
+    unsigned int* index = &indices[quad * 6];
+    index[0] = corner;
+    index[1] = corner + 1;
+    index[2] = corner + 2;
+    index[3] = corner + 2;
+    index[4] = corner + 3;
+    index[5] = corner;
+  }
+  return indices;
+}
+
+QuadBatch::QuadBatch(unsigned int quadsPerFrame, StreamBufferBackend backend)
+  //* A full batch always fits in a fresh region, plus a vertex of slack for the alignment.
+  : m_Buffer(GL_ARRAY_BUFFER, (quadsPerFrame > MAX_QUADS ? quadsPerFrame : MAX_QUADS) * QUAD_BYTES + sizeof(BatchVertex), 3, backend),
+    m_Indices(MakeQuadIndices().data(), MAX_QUADS * 6),
+    m_Shader("res/shaders/quad.vert", "res/shaders/quad.frag"),
+    m_Vertices(MAX_QUADS * 4) {
+  m_VertexArray.AddBuffer<BatchVertex>(m_Buffer);
+  //* The element buffer binding lives in the VAO, so it's set once here and every draw reuses it.
+  m_VertexArray.Bind();
+  m_Indices.Bind();
+
+  //* Sampler i reads unit i for good. Immediate uploads need the program bound.
+  m_Shader.Bind();
+  for(unsigned int unit = 0; unit < MAX_TEXTURES; ++unit){
+    m_Shader.SetUniform1i("u_Texture" + std::to_string(unit), unit);
+  }
+
+  unsigned char white[4] = { 255, 255, 255, 255 };
+  GLCall(glGenTextures(1, &m_WhiteTexture));
+  GLState::BindTexture(0, GL_TEXTURE_2D, m_WhiteTexture);
+  GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+  GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+  GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white));
+  m_Textures[0] = m_WhiteTexture;
+}
+
+QuadBatch::~QuadBatch(){
+  if(m_WhiteTexture){
+    GLState::OnDeleteTexture(m_WhiteTexture);
+    DeletionQueue::Enqueue(GLObjectKind::Texture, m_WhiteTexture);
+  }
+}
+
+unsigned int QuadBatch::FindSlot(unsigned int texture){
+  if(texture == 0){
+    return 0;
+  }
+  for(unsigned int slot = 1; slot < m_TextureCount; ++slot){
+    if(m_Textures[slot] == texture){
+      return slot;
+    }
+  }
+  if(m_TextureCount == MAX_TEXTURES){
+    return MAX_TEXTURES;
+  }
+  m_Textures[m_TextureCount] = texture;
+  return m_TextureCount++;
+}
+
+void QuadBatch::Submit(const Quad& quad){
+  unsigned int slot = FindSlot(quad.texture);
+  if(slot == MAX_TEXTURES){
+    ++m_Stats.textureFlushes;
+    Flush();
+    slot = FindSlot(quad.texture);
+  }
+
+  //* Corners counter clockwise from the bottom left, the offsets from the center rotated by hand.
+  float x = quad.size[0] * 0.5f;
+  float y = quad.size[1] * 0.5f;
+  float corners[4][2] = { { -x, -y }, { x, -y }, { x, y }, { -x, y } };
+  if(quad.rotation != 0.0f){
+    float c = std::cos(quad.rotation);
+    float s = std::sin(quad.rotation);
+    for(float* corner : corners){
+      float cx = corner[0];
+      corner[0] = cx * c - corner[1] * s;
+      corner[1] = cx * s + corner[1] * c;
+    }
+  }
+  const float uvs[4][2] = { { quad.uv[0], quad.uv[1] }, { quad.uv[2], quad.uv[1] }, { quad.uv[2], quad.uv[3] }, { quad.uv[0], quad.uv[3] } };
+
+  BatchVertex* vertex = &m_Vertices[m_QuadCount * 4];
+  for(unsigned int i = 0; i < 4; ++i){
+    vertex[i].position[0] = quad.position[0] + corners[i][0];
+    vertex[i].position[1] = quad.position[1] + corners[i][1];
+    vertex[i].uv[0] = uvs[i][0];
+    vertex[i].uv[1] = uvs[i][1];
+    vertex[i].color[0] = quad.color[0];
+    vertex[i].color[1] = quad.color[1];
+    vertex[i].color[2] = quad.color[2];
+    vertex[i].color[3] = quad.color[3];
+    vertex[i].slot = slot;
+  }
+  ++m_Stats.quads;
+  if(++m_QuadCount == MAX_QUADS){
+    ++m_Stats.fullFlushes;
+    Flush();
+  }
+}
+
+void QuadBatch::Flush(){
+  if(m_QuadCount == 0){
+    return;
+  }
+  unsigned int size = m_QuadCount * QUAD_BYTES;
+  //* Aligned to the vertex size so the base vertex comes out whole.
+  unsigned int offset = m_Buffer.Write(m_Vertices.data(), size, sizeof(BatchVertex));
+  if(offset == 0xFFFFFFFF){
+    //* More quads this frame than the region was sized for. Fence this region and carry on in the next one,
+    //* that only waits if the GPU is still reading the region from three wraps ago.
+    ++m_Stats.regionWraps;
+    m_Buffer.EndFrame();
+    offset = m_Buffer.Write(m_Vertices.data(), size, sizeof(BatchVertex));
+  }
+
+  m_Shader.Bind();
+  m_VertexArray.Bind();
+  for(unsigned int slot = 0; slot < m_TextureCount; ++slot){
+    GLState::BindTexture(slot, GL_TEXTURE_2D, m_Textures[slot]);
+  }
+  GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, m_QuadCount * 6, m_Indices.GetType(), nullptr, offset / sizeof(BatchVertex)));
+  ++m_Stats.drawCalls;
+
+  m_QuadCount = 0;
+  m_TextureCount = 1;
+}
+
+void QuadBatch::EndFrame(){
+  Flush();
+  m_Buffer.EndFrame();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+
+#include "StreamBuffer.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "VertexLayout.h"
+
+//* One corner of a batched quad. Matches the inputs of res/shaders/quad.vert.
+struct BatchVertex {
+  float position[2];
+  float uv[2];
+  unsigned char color[4];
+  //* Which of the batch's texture units the fragment shader samples.
+  unsigned int slot;
+};
+VERTEX_LAYOUT(BatchVertex, VERTEX_ATTRIB(BatchVertex, position), VERTEX_ATTRIB(BatchVertex, uv),
+  VERTEX_ATTRIB_NORMALIZED(BatchVertex, color), VERTEX_ATTRIB_INTEGER(BatchVertex, slot));
+
+//* A sprite in clip space, rotated about its center.
+struct Quad {
+  float position[2] = {};
+  float size[2] = { 1.0f, 1.0f };
+  //* Radians, counter clockwise.
+  float rotation = 0.0f;
+  unsigned char color[4] = { 255, 255, 255, 255 };
+  //* u0, v0, u1, v1. The corner at -size / 2 gets (u0, v0).
+  float uv[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+  //* GL_TEXTURE_2D name, 0 draws the color alone.
+  unsigned int texture = 0;
+};
+
+struct QuadBatchStats {
+  unsigned int quads = 0;
+  unsigned int drawCalls = 0;
+  //* Why the draws happened. Whatever isn't one of these was an explicit Flush or EndFrame.
+  unsigned int fullFlushes = 0;
+  unsigned int textureFlushes = 0;
+  //* The stream buffer region filled up before the frame did and the batch moved on to the next one early.
+  unsigned int regionWraps = 0;
+};
+
+/*
+Draws any number of quads with a handful of glDrawElementsBaseVertex calls. Submit turns a quad into four
+vertices in a CPU array. A flush copies the array into a StreamBuffer with one write and draws it with an
+index buffer made once for MAX_QUADS quads, so nothing but the vertices goes to the GPU each frame.
+A batch only flushes when it holds MAX_QUADS quads or a quad needs a texture while all MAX_TEXTURES units
+are taken. Unit 0 is a white texture for untextured quads.
+Call EndFrame() once a frame, after the last Submit. GL thread only, and the caller owns blend and depth state.
+*/
+class QuadBatch {
+public:
+  //* 4 * 16384 corners is the most an unsigned short index can reach, so the index buffer stays 16 bit.
+  static const unsigned int MAX_QUADS = 16384;
+  //* GL guarantees 16 texture units to a fragment shader, res/shaders/quad.frag samples exactly that many.
+  static const unsigned int MAX_TEXTURES = 16;
+
+  //* Each stream buffer region fits quadsPerFrame quads. A frame with more moves on to the next region early.
+  QuadBatch(unsigned int quadsPerFrame = 4 * MAX_QUADS, StreamBufferBackend backend = StreamBufferBackend::Auto);
+  ~QuadBatch();
+  QuadBatch(const QuadBatch&) = delete;
+  QuadBatch& operator=(const QuadBatch&) = delete;
+
+  void Submit(const Quad& quad);
+  //* Draws whatever has been submitted since the last flush.
+  void Flush();
+  void EndFrame();
+
+  inline const StreamBuffer& GetBuffer() const { return m_Buffer; }
+  inline const QuadBatchStats& GetStats() const { return m_Stats; }
+  inline void ResetStats() { m_Stats = QuadBatchStats(); }
+private:
+  //* The unit quad.texture is bound to in this batch, or MAX_TEXTURES if every unit is taken by something else.
+  unsigned int FindSlot(unsigned int texture);
+
+  StreamBuffer m_Buffer;
+  VertexArray m_VertexArray;
+  IndexBuffer m_Indices;
+  Shader m_Shader;
+  std::vector<BatchVertex> m_Vertices;
+  unsigned int m_QuadCount = 0;
+  unsigned int m_Textures[MAX_TEXTURES] = {};
+  unsigned int m_TextureCount = 1;
+  unsigned int m_WhiteTexture = 0;
+  QuadBatchStats m_Stats;
+};
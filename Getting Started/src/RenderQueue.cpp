@@ -0,0 +1,173 @@
+#include "RenderQueue.h"
+
+#include <chrono>
+
+#include "renderer.h"
+#include "GLState.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+
+static const unsigned int MAX_SORT_ID = 4095;
+
+static unsigned long long QuantizeDepth(float depth, unsigned int bits){
+  float clamped = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+  unsigned long long max = (1ull << bits) - 1;
+  return static_cast<unsigned long long>(clamped * static_cast<float>(max));
+}
+
+unsigned int RenderQueue::GetSortId(std::vector<unsigned short>& ids, unsigned short& next, unsigned int name){
+  //* 0 is "nothing bound", it sorts first.
+  if(name == 0){
+    return 0;
+  }
+  if(name >= ids.size()){
+    ids.resize(name + 1, 0);
+  }
+  if(ids[name] == 0){
+    ids[name] = next < MAX_SORT_ID ? ++next : MAX_SORT_ID;
+  }
+  return ids[name];
+}
+
+unsigned long long RenderQueue::MakeKey(const DrawPacket& packet){
+  unsigned long long program = GetSortId(m_ProgramIds, m_NextProgramId, packet.shader->GetBoundProgram());
+  unsigned long long vertexArray = GetSortId(m_VertexArrayIds, m_NextVertexArrayId, packet.vertexArray->GetRendererId());
+  unsigned long long texture = GetSortId(m_TextureIds, m_NextTextureId, packet.textures[0]);
+  unsigned long long key = static_cast<unsigned long long>(packet.layer & 0xF) << 60;
+  if(!packet.transparent){
+    return key | program << 47 | vertexArray << 35 | texture << 23 | QuantizeDepth(packet.depth, 23);
+  }
+  //* Far first, so the depth goes in flipped. The texture field is a bit short, ids past it share the last value.
+  unsigned long long farDepth = QuantizeDepth(1.0f - packet.depth, 24);
+  texture = texture > 2047 ? 2047 : texture;
+  return key | 1ull << 59 | farDepth << 35 | program << 23 | vertexArray << 11 | texture;
+}
+
+void RenderQueue::Submit(const DrawPacket& packet){
+  ASSERT(packet.shader && packet.vertexArray && packet.indexBuffer);
+  m_Entries.push_back({ MakeKey(packet), static_cast<unsigned int>(m_Packets.size()) });
+  m_Packets.push_back(packet);
+  m_Sorted = false;
+}
+
+void RenderQueue::Sort(){
+  if(m_Sorted){
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  size_t count = m_Entries.size();
+  m_Scratch.resize(count);
+  m_Stats.sortPasses = 0;
+
+  //* One read of the keys counts all eight bytes at once.
+  unsigned int histograms[8][256] = {};
+  for(const SortEntry& entry : m_Entries){
+    for(unsigned int pass = 0; pass < 8; ++pass){
+      ++histograms[pass][(entry.key >> (pass * 8)) & 0xFF];
+    }
+  }
+
+  //* Least significant byte first. Each pass is stable, so the order the earlier bytes put things in survives.
+  SortEntry* source = m_Entries.data();
+  SortEntry* destination = m_Scratch.data();
+  for(unsigned int pass = 0; pass < 8 && count > 1; ++pass){
+    unsigned int* histogram = histograms[pass];
+    unsigned int shift = pass * 8;
+    //* Every key has the same byte here (layers nobody uses, the top of the depth), the pass wouldn't move anything.
+    if(histogram[(source[0].key >> shift) & 0xFF] == count){
+      continue;
+    }
+    unsigned int offset = 0;
+    for(unsigned int bucket = 0; bucket < 256; ++bucket){
+      unsigned int size = histogram[bucket];
+      histogram[bucket] = offset;
+      offset += size;
+    }
+    for(size_t i = 0; i < count; ++i){
+      destination[histogram[(source[i].key >> shift) & 0xFF]++] = source[i];
+    }
+    SortEntry* swap = source;
+    source = destination;
+    destination = swap;
+    ++m_Stats.sortPasses;
+  }
+  if(source != m_Entries.data()){
+    m_Entries.swap(m_Scratch);
+  }
+
+  m_Sorted = true;
+  m_Stats.sortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned int RenderQueue::CountChanges(bool sorted) const{
+  unsigned int changes = 0;
+  const DrawPacket* previous = nullptr;
+  unsigned int previousProgram = 0;
+  for(size_t i = 0; i < m_Packets.size(); ++i){
+    const DrawPacket& packet = m_Packets[sorted ? m_Entries[i].index : i];
+    unsigned int program = packet.shader->GetBoundProgram();
+    if(!previous){
+      //* The first draw binds everything it uses.
+      changes += 3;
+      for(unsigned int unit = 0; unit < RENDER_QUEUE_TEXTURES; ++unit){
+        changes += packet.textures[unit] != 0;
+      }
+    }else{
+      changes += program != previousProgram;
+      changes += packet.vertexArray != previous->vertexArray;
+      changes += packet.indexBuffer != previous->indexBuffer;
+      for(unsigned int unit = 0; unit < RENDER_QUEUE_TEXTURES; ++unit){
+        changes += packet.textures[unit] != 0 && packet.textures[unit] != previous->textures[unit];
+      }
+    }
+    previous = &packet;
+    previousProgram = program;
+  }
+  return changes;
+}
+
+void RenderQueue::Execute(){
+  Sort();
+  m_Stats.packets = static_cast<unsigned int>(m_Packets.size());
+  m_Stats.changesSubmitted = CountChanges(false);
+  m_Stats.changesSorted = CountChanges(true);
+
+  bool blending = false;
+  for(const SortEntry& entry : m_Entries){
+    const DrawPacket& packet = m_Packets[entry.index];
+    //* Transparent draws sort after the opaque ones of their layer, so this flips at most twice per layer.
+    if(packet.transparent != blending){
+      blending = packet.transparent;
+      if(blending){
+        GLCall(glEnable(GL_BLEND));
+        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+        GLCall(glDepthMask(GL_FALSE));
+      }else{
+        GLCall(glDisable(GL_BLEND));
+        GLCall(glDepthMask(GL_TRUE));
+      }
+    }
+    packet.shader->Bind();
+    packet.vertexArray->Bind();
+    packet.indexBuffer->Bind();
+    for(unsigned int unit = 0; unit < RENDER_QUEUE_TEXTURES; ++unit){
+      if(packet.textures[unit] != 0){
+        GLState::BindTexture(unit, GL_TEXTURE_2D, packet.textures[unit]);
+      }
+    }
+    UniformRing::Bind(packet.uniformBinding, packet.uniforms);
+    GLCall(glDrawElements(GL_TRIANGLES, packet.indexBuffer->GetCount(), packet.indexBuffer->GetType(), nullptr));
+  }
+  if(blending){
+    GLCall(glDisable(GL_BLEND));
+    GLCall(glDepthMask(GL_TRUE));
+  }
+  Clear();
+}
+
+void RenderQueue::Clear(){
+  m_Packets.clear();
+  m_Entries.clear();
+  m_Sorted = false;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+
+#include "UniformRing.h"
+
+class Shader;
+class VertexArray;
+class IndexBuffer;
+
+static const unsigned int RENDER_QUEUE_TEXTURES = 4;
+
+/*
+Everything one draw needs. Nothing is owned, whatever the pointers point at has to live until Execute.
+Draws the whole index buffer with the packet's shader, VAO and textures, and per draw constants bound as a range.
+Plain uniforms set on the shader before Submit are not per draw: draws sharing a program all see the last
+value set by the time Execute runs. Anything that differs between draws goes in uniforms. The exception is a
+ShaderVariants variant that's still compiling, its Bind sets u_Features on the uber shader itself at issue time.
+*/
+struct DrawPacket {
+  const Shader* shader = nullptr;
+  const VertexArray* vertexArray = nullptr;
+  const IndexBuffer* indexBuffer = nullptr;
+  //* GL_TEXTURE_2D names for units 0 to RENDER_QUEUE_TEXTURES - 1. 0 leaves that unit alone.
+  unsigned int textures[RENDER_QUEUE_TEXTURES] = {};
+  //* Usually from a UniformRing. Invalid means the draw has no constants of its own.
+  UniformAllocation uniforms;
+  unsigned int uniformBinding = 0;
+  //* Distance from the camera scaled to 0..1, 0 at the near plane. Only the order matters, it's quantized to 23 bits.
+  float depth = 0.0f;
+  //* Blended, drawn after every opaque draw of its layer, far to near, with depth writes off.
+  bool transparent = false;
+  //* Coarsest order, every draw of layer 0 goes before layer 1 (scene, then UI, say). 0 to 15.
+  unsigned int layer = 0;
+};
+
+//* What the last Execute did. State changes are program, VAO, index buffer and texture switches between neighbouring draws.
+struct RenderQueueStats {
+  unsigned int packets = 0;
+  //* In the order the packets were submitted, what drawing them straight away would have switched.
+  unsigned int changesSubmitted = 0;
+  unsigned int changesSorted = 0;
+  //* Radix passes actually run, a pass whose byte is the same in every key is skipped.
+  unsigned int sortPasses = 0;
+  double sortMs = 0.0;
+};
+
+/*
+Collects a frame's draws and issues them sorted, so draws sharing a program, VAO and textures end up next to
+each other and GLState skips the repeated binds. Every packet gets a 64 bit key:
+  opaque       layer:4 | 0 | program:12 | vertex array:12 | texture:12 | depth:23, near first
+  transparent  layer:4 | 1 | far depth:24 | program:12 | vertex array:12 | texture:11
+Opaque draws group by state first and only go front to back within a group. Transparent ones have to be
+in depth order to blend right, state only breaks ties.
+The keys are radix sorted, eight bits a pass. Submit all frame, Execute once, on the GL thread.
+*/
+class RenderQueue {
+public:
+  RenderQueue() = default;
+  RenderQueue(const RenderQueue&) = delete;
+  RenderQueue& operator=(const RenderQueue&) = delete;
+
+  void Submit(const DrawPacket& packet);
+  //* Sorts if Execute hasn't yet. Separate so the sort can be timed on its own.
+  void Sort();
+  //* Binds and draws every packet in key order, then empties the queue for the next frame.
+  void Execute();
+  //* Drops the packets without drawing them.
+  void Clear();
+
+  inline unsigned int GetPacketCount() const { return static_cast<unsigned int>(m_Packets.size()); }
+  inline const RenderQueueStats& GetStats() const { return m_Stats; }
+private:
+  struct SortEntry {
+    unsigned long long key;
+    unsigned int index;
+  };
+
+  unsigned long long MakeKey(const DrawPacket& packet);
+  //* Small ids handed out in the order objects first show up, so the key fields stay dense whatever the GL names are.
+  unsigned int GetSortId(std::vector<unsigned short>& ids, unsigned short& next, unsigned int name);
+  unsigned int CountChanges(bool sorted) const;
+
+  std::vector<DrawPacket> m_Packets;
+  std::vector<SortEntry> m_Entries;
+  //* Where the radix passes scatter to, kept around so sorting doesn't allocate once the queue has grown.
+  std::vector<SortEntry> m_Scratch;
+  bool m_Sorted = false;
+  //* Indexed by GL name, 0 means not seen yet. Ids never get reused, past the last one objects share it.
+  std::vector<unsigned short> m_ProgramIds;
+  std::vector<unsigned short> m_VertexArrayIds;
+  std::vector<unsigned short> m_TextureIds;
+  unsigned short m_NextProgramId = 0;
+  unsigned short m_NextVertexArrayId = 0;
+  unsigned short m_NextTextureId = 0;
+  RenderQueueStats m_Stats;
+};
@@ -0,0 +1,93 @@
+#include "RenderThread.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "Clock.h"
+
+RenderThread::RenderThread(GLFWwindow* window)
+  : m_Window(window) {
+}
+
+RenderThread::~RenderThread(){
+  Stop();
+}
+
+void RenderThread::Start(std::function<void()> init, std::function<void()> frame, std::function<void()> shutdown){
+  if(IsRunning()){
+    return;
+  }
+  //* Nothing runs yet, so a restart can begin counting from scratch.
+  m_State.store(0, std::memory_order_relaxed);
+  m_Rendered.store(0, std::memory_order_relaxed);
+  m_Stats = RenderThreadStats();
+  //* A context can only be current on one thread at a time.
+  glfwMakeContextCurrent(nullptr);
+  m_Thread = std::thread(&RenderThread::Loop, this, std::move(init), std::move(frame), std::move(shutdown));
+}
+
+void RenderThread::Stop(){
+  if(!IsRunning()){
+    return;
+  }
+  //* Setting the bit changes the value, which also wakes it up in case it's waiting for a frame.
+  m_State.fetch_or(STOP_BIT, std::memory_order_release);
+  m_State.notify_one();
+  m_Thread.join();
+  glfwMakeContextCurrent(m_Window);
+}
+
+void RenderThread::Kick(){
+  m_State.fetch_add(KICK, std::memory_order_release);
+  m_State.notify_one();
+}
+
+void RenderThread::WaitForRender(){
+  unsigned long long kicked = m_State.load(std::memory_order_relaxed) / KICK;
+  unsigned long long rendered = m_Rendered.load(std::memory_order_acquire);
+  while(IsRunning() && rendered != kicked){
+    m_Rendered.wait(rendered, std::memory_order_acquire);
+    rendered = m_Rendered.load(std::memory_order_acquire);
+  }
+}
+
+void RenderThread::Loop(std::function<void()> init, std::function<void()> frame, std::function<void()> shutdown){
+  glfwMakeContextCurrent(m_Window);
+  if(init){
+    init();
+  }
+
+  unsigned long long seen = 0;
+  unsigned long long drawn = 0;
+  while(true){
+    double waitStart = Clock::NowMs();
+    m_State.wait(seen, std::memory_order_acquire);
+    seen = m_State.load(std::memory_order_acquire);
+    unsigned long long kicked = seen / KICK;
+    bool stopping = (seen & STOP_BIT) != 0;
+    double renderStart = Clock::NowMs();
+    m_Stats.idleMs += renderStart - waitStart;
+
+    //* A frame kicked before Stop still gets drawn, nothing else does.
+    if(kicked != drawn){
+      if(frame){
+        frame();
+      }
+      glfwSwapBuffers(m_Window);
+      m_Stats.renderMs += Clock::NowMs() - renderStart;
+      ++m_Stats.frames;
+    }
+
+    drawn = kicked;
+    m_Rendered.store(kicked, std::memory_order_release);
+    m_Rendered.notify_one();
+    if(stopping){
+      break;
+    }
+  }
+
+  if(shutdown){
+    shutdown();
+  }
+  glfwMakeContextCurrent(nullptr);
+}
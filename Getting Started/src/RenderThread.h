@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+struct GLFWwindow;
+
+struct RenderThreadStats {
+  unsigned long long frames = 0;
+  //* Inside the frame callback and glfwSwapBuffers.
+  double renderMs = 0.0;
+  //* Waiting for Kick, i.e. for the simulation to come up with the next frame.
+  double idleMs = 0.0;
+};
+
+/*
+Runs every GL call of the program on a thread of its own. The window's context moves over to it in Start
+and comes back to the calling thread in Stop, so the caller can still clean up afterwards.
+The main thread keeps polling events (GLFW wants that on the main thread) and simulating. Once a frame it
+publishes what to draw, usually through a TripleBuffer, and calls Kick. The render thread then runs the
+frame callback and swaps, while the main thread already simulates the next frame. Calling WaitForRender
+between simulating and publishing keeps the two in step: no packet gets replaced before it's drawn, and
+the simulation is never more than a frame ahead of the render thread.
+Everything GL in between has to happen in the callbacks, including creating and destroying GL objects.
+*/
+class RenderThread {
+public:
+  //* Only remembers the window, no thread runs and the context stays where it is until Start.
+  RenderThread(GLFWwindow* window);
+  //* Stops the thread if it's still running, which makes the window's context current on the calling thread again.
+  ~RenderThread();
+  RenderThread(const RenderThread&) = delete;
+  RenderThread& operator=(const RenderThread&) = delete;
+
+  //* Releases the context from the calling thread. init runs once on the render thread with the context
+  //* current, then frame after every Kick, then shutdown when Stop is called. Any of them can be empty.
+  void Start(std::function<void()> init, std::function<void()> frame, std::function<void()> shutdown);
+  //* Draws a frame that was kicked and not drawn yet, if any, runs shutdown and joins. The context is current here again afterwards.
+  void Stop();
+
+  //* A new frame is ready. Several Kicks before the render thread wakes up still render once.
+  void Kick();
+  //* Blocks until every kicked frame has been drawn and swapped.
+  void WaitForRender();
+
+  inline bool IsRunning() const { return m_Thread.joinable(); }
+  //* Only read it while the thread is stopped, or accept numbers that are slightly off.
+  inline const RenderThreadStats& GetStats() const { return m_Stats; }
+private:
+  void Loop(std::function<void()> init, std::function<void()> frame, std::function<void()> shutdown);
+
+  //* m_State counts kicks in steps of KICK and keeps the stop request in the low bit, so one load sees both.
+  static constexpr unsigned long long STOP_BIT = 1;
+  static constexpr unsigned long long KICK = 2;
+
+  GLFWwindow* m_Window;
+  std::thread m_Thread;
+  //* Frames kicked by the main thread (plus the stop request) and frames the render thread is done with.
+  //* Both sides sleep on them with C++20 atomic wait instead of a mutex and condition variable.
+  std::atomic<unsigned long long> m_State{ 0 };
+  std::atomic<unsigned long long> m_Rendered{ 0 };
+  RenderThreadStats m_Stats;
+};
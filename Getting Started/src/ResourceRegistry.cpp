@@ -0,0 +1,49 @@
+#include "ResourceRegistry.h"
+
+#include "renderer.h"
+
+void BufferTraits::Generate(int count, unsigned int* names){
+  GLCall(glGenBuffers(count, names));
+}
+
+void VertexArrayTraits::Generate(int count, unsigned int* names){
+  GLCall(glGenVertexArrays(count, names));
+}
+
+void TextureTraits::Generate(int count, unsigned int* names){
+  GLCall(glGenTextures(count, names));
+}
+
+void ProgramTraits::Generate(int count, unsigned int* names){
+  for(int i = 0; i < count; ++i){
+    GLCall(names[i] = glCreateProgram());
+  }
+}
+
+//* Function statics so the pools are only made once something asks for them.
+ResourcePool<BufferTraits>& ResourceRegistry::Buffers(){
+  static ResourcePool<BufferTraits> pool;
+  return pool;
+}
+
+ResourcePool<VertexArrayTraits>& ResourceRegistry::VertexArrays(){
+  static ResourcePool<VertexArrayTraits> pool;
+  return pool;
+}
+
+ResourcePool<TextureTraits>& ResourceRegistry::Textures(){
+  static ResourcePool<TextureTraits> pool;
+  return pool;
+}
+
+ResourcePool<ProgramTraits>& ResourceRegistry::Programs(){
+  static ResourcePool<ProgramTraits> pool;
+  return pool;
+}
+
+void ResourceRegistry::Clear(){
+  Buffers().Clear();
+  VertexArrays().Clear();
+  Textures().Clear();
+  Programs().Clear();
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "DeletionQueue.h"
+
+/*
+32 bit handle to a GL object in a ResourcePool: the low 20 bits are the slot, the high 12 bits the slot's
+generation. Destroying an object bumps its slot's generation, so old handles to it stop resolving instead of
+pointing at whatever object reuses the slot. 0 is never a valid handle, and neither is generation 0.
+Traits only exists to make handles to different kinds of object different types.
+*/
+template<typename Traits>
+struct ResourceHandle {
+  static const uint32_t INDEX_BITS = 20;
+  static const uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+  static const uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+  uint32_t id = 0;
+
+  inline uint32_t GetIndex() const { return id & INDEX_MASK; }
+  inline uint32_t GetGeneration() const { return id >> INDEX_BITS; }
+  inline bool IsNull() const { return id == 0; }
+  inline bool operator==(const ResourceHandle& other) const { return id == other.id; }
+  inline bool operator!=(const ResourceHandle& other) const { return id != other.id; }
+
+  static ResourceHandle Make(uint32_t index, uint32_t generation){
+    ResourceHandle handle;
+    handle.id = (generation << INDEX_BITS) | (index & INDEX_MASK);
+    return handle;
+  }
+};
+
+/*
+How each kind of GL object is made, n at a time so the pools can batch glGen*.
+Deleting goes through the DeletionQueue under Kind like every other GL name here, which batches the glDelete*
+per frame and keeps GLState / VertexFormatCache in step.
+Info is whatever small bit of metadata is worth keeping next to the name.
+*/
+struct BufferTraits {
+  static const GLObjectKind Kind = GLObjectKind::Buffer;
+  struct Info {
+    unsigned int target = 0;
+    unsigned int size = 0;
+  };
+  static void Generate(int count, unsigned int* names);
+};
+
+struct VertexArrayTraits {
+  static const GLObjectKind Kind = GLObjectKind::VertexArray;
+  struct Info {};
+  static void Generate(int count, unsigned int* names);
+};
+
+struct TextureTraits {
+  static const GLObjectKind Kind = GLObjectKind::Texture;
+  struct Info {
+    unsigned int target = 0;
+  };
+  static void Generate(int count, unsigned int* names);
+};
+
+//* There's no glGenPrograms, so Generate is a loop of glCreateProgram. Shader code usually Adopts its program instead.
+struct ProgramTraits {
+  static const GLObjectKind Kind = GLObjectKind::Program;
+  struct Info {};
+  static void Generate(int count, unsigned int* names);
+};
+
+/*
+Slot map of GL objects of one kind.
+The names and infos live in dense arrays (no holes, so GetNames() can be walked or handed straight to GL),
+and every slot points at its object's dense index. Destroying swaps the last object into the hole.
+Create has an n-at-a-time version that turns into a single glGen* call. Destroy queues the names on the
+DeletionQueue, which deletes each frame's worth with one glDelete* per kind.
+A slot whose generation runs out is retired rather than wrapped, so a handle can never resolve to a later
+object. A slot only retires after 4095 objects have lived in it, and there are about a million slots.
+Only use it from the thread that owns the context.
+*/
+template<typename Traits>
+class ResourcePool {
+public:
+  using Handle = ResourceHandle<Traits>;
+  using Info = typename Traits::Info;
+
+  //* The destructor doesn't touch GL, the context is usually gone by the time statics die. Clear() before DeletionQueue::Flush().
+  ResourcePool() = default;
+  ~ResourcePool() = default;
+  ResourcePool(const ResourcePool&) = delete;
+  ResourcePool& operator=(const ResourcePool&) = delete;
+
+  Handle Create(const Info& info = Info()){
+    Handle handle;
+    Create(1, &handle, info);
+    return handle;
+  }
+
+  void Create(unsigned int count, Handle* out, const Info& info = Info()){
+    if(count == 0){
+      return;
+    }
+    m_scratch.resize(count);
+    Traits::Generate(static_cast<int>(count), m_scratch.data());
+    for(unsigned int i = 0; i < count; ++i){
+      out[i] = Adopt(m_scratch[i], info);
+    }
+  }
+
+  //* Takes ownership of a name something else already made. If every slot is used up the name is queued for
+  //* deletion and the handle is null.
+  Handle Adopt(unsigned int name, const Info& info = Info()){
+    uint32_t index;
+    if(m_freeHead != NONE){
+      index = m_freeHead;
+      m_freeHead = m_slots[index].dense;
+    }else{
+      index = static_cast<uint32_t>(m_slots.size());
+      if(index > Handle::INDEX_MASK){
+        DeletionQueue::Enqueue(Traits::Kind, name);
+        return Handle();
+      }
+      m_slots.push_back({ 1, NONE });
+    }
+    m_slots[index].dense = static_cast<uint32_t>(m_names.size());
+    m_names.push_back(name);
+    m_infos.push_back(info);
+    m_denseToSlot.push_back(index);
+    return Handle::Make(index, m_slots[index].generation);
+  }
+
+  void Destroy(Handle handle){
+    Destroy(1, &handle);
+  }
+
+  //* Stale handles are skipped.
+  void Destroy(unsigned int count, const Handle* handles){
+    for(unsigned int i = 0; i < count; ++i){
+      if(!IsValid(handles[i])){
+        continue;
+      }
+      DeletionQueue::Enqueue(Traits::Kind, m_names[m_slots[handles[i].GetIndex()].dense]);
+      Remove(handles[i].GetIndex());
+    }
+  }
+
+  void Clear(){
+    for(unsigned int name : m_names){
+      DeletionQueue::Enqueue(Traits::Kind, name);
+    }
+    for(uint32_t slot : m_denseToSlot){
+      Free(slot);
+    }
+    m_names.clear();
+    m_infos.clear();
+    m_denseToSlot.clear();
+  }
+
+  bool IsValid(Handle handle) const{
+    uint32_t index = handle.GetIndex();
+    return !handle.IsNull() && index < m_slots.size() && handle.GetGeneration() != RETIRED &&
+      m_slots[index].generation == handle.GetGeneration();
+  }
+
+  //* Slots that used up every generation and will never be handed out again.
+  inline unsigned int GetRetiredCount() const { return m_retired; }
+
+  //* 0 for null or stale handles, which GL treats as "unbind".
+  unsigned int GetName(Handle handle) const{
+    return IsValid(handle) ? m_names[m_slots[handle.GetIndex()].dense] : 0;
+  }
+
+  Info* GetInfo(Handle handle){
+    return IsValid(handle) ? &m_infos[m_slots[handle.GetIndex()].dense] : nullptr;
+  }
+
+  inline unsigned int GetCount() const { return static_cast<unsigned int>(m_names.size()); }
+  inline const unsigned int* GetNames() const { return m_names.data(); }
+  inline const Info* GetInfos() const { return m_infos.data(); }
+private:
+  static const uint32_t NONE = 0xFFFFFFFF;
+  //* Generation of a slot that is dead for good. Never handed out, so IsValid can't match it.
+  static const uint32_t RETIRED = 0;
+
+  struct Slot {
+    uint32_t generation;
+    //* Dense index while alive, next free slot while on the free list.
+    uint32_t dense;
+  };
+
+  //* Bumps the generation so handles to the old object stop matching. A slot already on its last generation
+  //* is retired instead of wrapping back to 1 and going on the free list.
+  void Free(uint32_t index){
+    if(m_slots[index].generation == Handle::GENERATION_MASK){
+      m_slots[index].generation = RETIRED;
+      m_slots[index].dense = NONE;
+      ++m_retired;
+      return;
+    }
+    m_slots[index].generation += 1;
+    m_slots[index].dense = m_freeHead;
+    m_freeHead = index;
+  }
+
+  void Remove(uint32_t index){
+    uint32_t dense = m_slots[index].dense;
+    uint32_t last = static_cast<uint32_t>(m_names.size() - 1);
+    if(dense != last){
+      m_names[dense] = m_names[last];
+      m_infos[dense] = m_infos[last];
+      m_denseToSlot[dense] = m_denseToSlot[last];
+      m_slots[m_denseToSlot[dense]].dense = dense;
+    }
+    m_names.pop_back();
+    m_infos.pop_back();
+    m_denseToSlot.pop_back();
+
+    Free(index);
+  }
+
+  std::vector<Slot> m_slots;
+  std::vector<unsigned int> m_names;
+  std::vector<Info> m_infos;
+  std::vector<uint32_t> m_denseToSlot;
+  std::vector<unsigned int> m_scratch;
+  uint32_t m_freeHead = NONE;
+  unsigned int m_retired = 0;
+};
+
+using BufferHandle = ResourceHandle<BufferTraits>;
+using VertexArrayHandle = ResourceHandle<VertexArrayTraits>;
+using TextureHandle = ResourceHandle<TextureTraits>;
+using ProgramHandle = ResourceHandle<ProgramTraits>;
+
+//* One pool per kind of object for the current context. Clear() queues everything still alive, call it before DeletionQueue::Flush().
+class ResourceRegistry {
+public:
+  static ResourcePool<BufferTraits>& Buffers();
+  static ResourcePool<VertexArrayTraits>& VertexArrays();
+  static ResourcePool<TextureTraits>& Textures();
+  static ResourcePool<ProgramTraits>& Programs();
+
+  static void Clear();
+};
@@ -1,123 +1,494 @@
 #include "Shader.h"
 
+#include <cstring>
 #include <iostream>
 #include <string>
-#include <sstream>
-#include <fstream>
+#include <thread>
+#include <vector>
 
 #include "renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "GLExtensions.h"
+#include "ProgramBinaryCache.h"
+#include "ShaderCompiler.h"
+#include "ShaderStages.h"
+#include "UniformBlockBindings.h"
+#include "ProgramRegistry.h"
 
-Shader::Shader(const std::string& vertex_filepath, const std::string& fragment_filepath): m_vertex_FilePath(vertex_filepath), m_fragment_FilePath(fragment_filepath), m_RendererId(0) {
-  ShaderProgramSource source = ParseShader(vertex_filepath, fragment_filepath);
-  m_RendererId = CreateShader(source.VertexSource, source.FragmentSource);
+Shader::Shader(const std::string& vertex_filepath, const std::string& fragment_filepath, const std::vector<ShaderDefine>& defines)
+  : m_vertex_FilePath(vertex_filepath), m_fragment_FilePath(fragment_filepath), m_RendererId(0) {
+  ShaderProgramSource source = ParseShader(vertex_filepath, fragment_filepath, defines);
+  m_Program = ProgramRegistry::Acquire(source.Key);
+  if(!m_Program->program){
+    m_Program->program = CreateShader(source.VertexSource, source.FragmentSource);
+  }
+  //* Someone else submitted the same program without waiting. This constructor promises a linked program, so wait.
+  while(ShaderCompiler::GetStatus(m_Program->program) == ProgramStatus::Pending){
+    ShaderCompiler::Poll();
+    std::this_thread::yield();
+  }
+  m_RendererId = m_Program->program;
+  Reflect();
+}
+
+Shader::Shader(const std::string& vertex_filepath, const std::string& fragment_filepath, Shader& fallback, const std::vector<ShaderDefine>& defines)
+  : m_vertex_FilePath(vertex_filepath), m_fragment_FilePath(fragment_filepath), m_RendererId(0), m_Fallback(&fallback), m_Pending(true) {
+  ShaderProgramSource source = ParseShader(vertex_filepath, fragment_filepath, defines);
+  m_Program = ProgramRegistry::Acquire(source.Key);
+  if(!m_Program->program){
+    m_Program->program = ShaderCompiler::Submit(source.VertexSource, source.FragmentSource);
+  }
+  m_RendererId = m_Program->program;
 }
 
 Shader::~Shader(){
-  GLCall(glDeleteProgram(m_RendererId));
+  Release();
+}
+
+Shader::Shader(Shader&& other) noexcept
+  : m_vertex_FilePath(std::move(other.m_vertex_FilePath)), m_fragment_FilePath(std::move(other.m_fragment_FilePath)),
+    m_RendererId(other.m_RendererId), m_UniformCache(std::move(other.m_UniformCache)),
+    m_Uniforms(std::move(other.m_Uniforms)), m_UniformBlocks(std::move(other.m_UniformBlocks)), m_UniformValues(std::move(other.m_UniformValues)),
+    m_UploadMode(other.m_UploadMode), m_DirtyBegin(other.m_DirtyBegin), m_DirtyEnd(other.m_DirtyEnd),
+    m_Program(other.m_Program), m_Fallback(other.m_Fallback), m_FallbackUniform(other.m_FallbackUniform),
+    m_FallbackValue(other.m_FallbackValue), m_Pending(other.m_Pending) {
+  other.m_RendererId = 0;
+  other.m_Program = nullptr;
+  other.m_Fallback = nullptr;
+  other.m_Pending = false;
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept{
+  if(this != &other){
+    Release();
+    m_vertex_FilePath = std::move(other.m_vertex_FilePath);
+    m_fragment_FilePath = std::move(other.m_fragment_FilePath);
+    m_RendererId = other.m_RendererId;
+    m_UniformCache = std::move(other.m_UniformCache);
+    m_Uniforms = std::move(other.m_Uniforms);
+    m_UniformBlocks = std::move(other.m_UniformBlocks);
+    m_UniformValues = std::move(other.m_UniformValues);
+    m_UploadMode = other.m_UploadMode;
+    m_DirtyBegin = other.m_DirtyBegin;
+    m_DirtyEnd = other.m_DirtyEnd;
+    m_Program = other.m_Program;
+    m_Fallback = other.m_Fallback;
+    m_FallbackUniform = other.m_FallbackUniform;
+    m_FallbackValue = other.m_FallbackValue;
+    m_Pending = other.m_Pending;
+    other.m_RendererId = 0;
+    other.m_Program = nullptr;
+    other.m_Fallback = nullptr;
+    other.m_Pending = false;
+  }
+  return *this;
+}
+
+//* A moved from shader holds nothing. The program itself goes once no other Shader shares it.
+void Shader::Release(){
+  if(m_Program){
+    ProgramRegistry::Release(m_Program);
+    m_Program = nullptr;
+    m_RendererId = 0;
+  }
+}
+
+bool Shader::IsReady() const{
+  if(m_Pending && ShaderCompiler::GetStatus(m_RendererId) == ProgramStatus::Ready){
+    m_Pending = false;
+    Reflect();
+  }
+  return !m_Pending;
+}
+
+bool Shader::HasFailed() const{
+  return m_Pending && ShaderCompiler::GetStatus(m_RendererId) == ProgramStatus::Failed;
 }
 
 void Shader::Bind() const{
-  GLCall(glUseProgram(m_RendererId));
+  if(!IsReady()){
+    if(!m_FallbackUniform.IsValid()){
+      m_Fallback->Bind();
+      return;
+    }
+    //* Deferred sets go out in Bind, immediate ones need the program bound already.
+    if(m_Fallback->GetUploadMode() == UniformUploadMode::Deferred){
+      m_Fallback->SetUniform1i(m_FallbackUniform, m_FallbackValue);
+      m_Fallback->Bind();
+    }else{
+      m_Fallback->Bind();
+      m_Fallback->SetUniform1i(m_FallbackUniform, m_FallbackValue);
+    }
+    return;
+  }
+  GLState::BindProgram(m_RendererId);
+  FlushUniforms();
+}
+
+unsigned int Shader::GetBoundProgram() const{
+  return IsReady() ? m_RendererId : m_Fallback->GetBoundProgram();
+}
+
+void Shader::SetFallbackUniform(const std::string& name, int value){
+  if(!m_Fallback){
+    return;
+  }
+  m_FallbackUniform = m_Fallback->GetUniform(name);
+  m_FallbackValue = value;
 }
 
 void Shader::Unbind() const{
-  GLCall(glUseProgram(0));
+  GLState::BindProgram(0);
 }
 
-void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3){
-  GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+UniformHandle Shader::GetUniform(const std::string& name){
+  //* Asked first, a shader that just finished linking fills its table in here.
+  bool ready = IsReady();
+  for(size_t i = 0; i < m_Uniforms.size(); ++i){
+    if(m_Uniforms[i].name == name){
+      return { static_cast<int>(i) };
+    }
+  }
+  if(!ready){
+    m_Uniforms.push_back({ name, -1, 0, 0 });
+    m_UniformValues.emplace_back();
+    return { static_cast<int>(m_Uniforms.size() - 1) };
+  }
+  std::cout << "WARNING: uniform " << name << " doesn't exist" << std::endl;
+  return {};
+}
+
+unsigned int Shader::GetUniformBlockIndex(const std::string& name) const{
+  for(const ShaderUniformBlock& block : m_UniformBlocks){
+    if(block.name == name){
+      return block.index;
+    }
+  }
+  return GL_INVALID_INDEX;
+}
+
+#ifndef NDEBUG
+//* Ints also go into bools and samplers, so for GL_INT anything that isn't a float type is fine.
+static bool UniformTypeMatches(unsigned int uniformType, unsigned int setterType){
+  if(uniformType == setterType){
+    return true;
+  }
+  if(setterType != GL_INT){
+    return false;
+  }
+  switch(uniformType){
+    case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+    case GL_FLOAT_MAT2: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+    case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT3x2:
+    case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT4x3:
+      return false;
+    default:
+      return true;
+  }
 }
+#endif
+
+static UniformUploadStats s_UploadStats;
 
-unsigned int Shader::GetUniformLocation(const std::string& name){
-  if(m_UniformLocationCache.find(name) != m_UniformLocationCache.end()){
-    return m_UniformLocationCache[name];
+void Shader::SetValue(UniformHandle uniform, unsigned int setterType, const void* data, unsigned int size){
+  if(!uniform.IsValid() || m_Uniforms[uniform.slot].location == -1){
+    return;
   }
-  if(m_UniformLocationCache[name] == -1){
-    std::cout << "WARNING: uniform " << name << "doesn't exist";
+#ifndef NDEBUG
+  ASSERT(UniformTypeMatches(m_Uniforms[uniform.slot].type, setterType));
+#endif
+  ClaimUniforms();
+  UniformValue& value = m_UniformValues[uniform.slot];
+  if(value.known && memcmp(value.bits, data, size) == 0){
+    ++s_UploadStats.skips;
+    return;
   }
-  unsigned int location = glGetUniformLocation(m_RendererId, name.c_str());
+  //* Compared as bits, so -0.0f vs 0.0f counts as a change and a NaN equals itself.
+  memcpy(value.bits, data, size);
+  value.setterType = setterType;
+  value.known = true;
 
-  m_UniformLocationCache[name] = location;
-  return location;
+  if(m_UploadMode == UniformUploadMode::Immediate){
+    Upload(uniform.slot);
+    return;
+  }
+  if(value.dirty){
+    ++s_UploadStats.merged;
+    return;
+  }
+  value.dirty = true;
+  unsigned int slot = uniform.slot;
+  if(m_DirtyBegin == m_DirtyEnd){
+    m_DirtyBegin = slot;
+    m_DirtyEnd = slot + 1;
+  }else{
+    m_DirtyBegin = slot < m_DirtyBegin ? slot : m_DirtyBegin;
+    m_DirtyEnd = slot + 1 > m_DirtyEnd ? slot + 1 : m_DirtyEnd;
+  }
 }
 
-ShaderProgramSource Shader::ParseShader(const std::string& vertex_file, const std::string& fragment_file){
-  std::ifstream vert_stream(vertex_file);
-  std::string line1;
-  std::stringstream vert_shader;
+void Shader::HoldValue(UniformHandle uniform, unsigned int setterType, const void* data, unsigned int size){
+  if(!uniform.IsValid()){
+    return;
+  }
+  UniformValue& value = m_UniformValues[uniform.slot];
+  memcpy(value.bits, data, size);
+  value.setterType = setterType;
+  value.dirty = true;
+}
 
-  while(getline(vert_stream, line1)){
-    vert_shader << line1 << '\n';
+void Shader::Upload(unsigned int slot) const{
+  ClaimUniforms();
+  UniformValue& value = m_UniformValues[slot];
+  int location = m_Uniforms[slot].location;
+  switch(value.setterType){
+    case GL_INT:
+      GLCall(glUniform1iv(location, 1, reinterpret_cast<const GLint*>(value.bits)));
+      break;
+    case GL_FLOAT:
+      GLCall(glUniform1fv(location, 1, reinterpret_cast<const GLfloat*>(value.bits)));
+      break;
+    case GL_FLOAT_VEC4:
+      GLCall(glUniform4fv(location, 1, reinterpret_cast<const GLfloat*>(value.bits)));
+      break;
   }
-  
-  std::ifstream frag_stream(fragment_file);
-  std::string line2;
-  std::stringstream frag_shader;
+  value.dirty = false;
+  ++s_UploadStats.uploads;
+}
 
-  while(getline(frag_stream, line2)){
-    frag_shader << line2 << '\n';
+void Shader::FlushUniforms() const{
+  for(unsigned int slot = m_DirtyBegin; slot < m_DirtyEnd; ++slot){
+    if(m_UniformValues[slot].dirty){
+      Upload(slot);
+    }
   }
+  m_DirtyBegin = m_DirtyEnd = 0;
+}
 
-  return { vert_shader.str(), frag_shader.str() };
+/*
+Shaders built from the same sources share one program, and with it one set of uniform values in GL. Only the
+last Shader to upload can trust its shadow, any other one forgets what it knew before it compares or uploads.
+Dirty values stay dirty, they still go out on the next flush.
+*/
+void Shader::ClaimUniforms() const{
+  if(m_Program->uniformOwner == this){
+    return;
+  }
+  for(UniformValue& value : m_UniformValues){
+    value.known = value.dirty;
+  }
+  m_Program->uniformOwner = this;
+}
+
+void Shader::SetUploadMode(UniformUploadMode mode){
+  m_UploadMode = mode;
+}
+
+void Shader::InvalidateUniforms(){
+  for(UniformValue& value : m_UniformValues){
+    value.known = false;
+  }
+}
+
+const UniformUploadStats& Shader::GetUploadStats(){
+  return s_UploadStats;
+}
+
+void Shader::ResetUploadStats(){
+  s_UploadStats = UniformUploadStats();
 }
 
 /*
-Function to Compile a shader that takes in the type of shader and the source name as a string.
-Also source string MUST be alive.
-If you have a function that returns a string, should make it an l-value.
+While the real program is compiling, the value goes to the fallback by name and is held for the real program.
+That's the slow path, but it only lasts until the compile is done.
 */
-unsigned int Shader::CompileShader(unsigned int type, const std::string& source){
-  unsigned int id = glCreateShader(type);
-  const char* src = source.c_str();
-  
-  /*
-    glShaderSource sets the source code in shader to the source code in the array of strings specified by string. 
-    This function takes in the id or the shader type, then the number of shaders, then a double pointer to the source
-    It also takes in a double pointer to length which specifies an array of string lengths.
-  */
-  GLCall(glShaderSource(id, 1, &src, nullptr));
-  GLCall(glCompileShader(id));
-
-  GLint success;
-  GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &success));
-  if(!success) {
-    GLint length;
-    GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
-    char* message = (char*)alloca(length * sizeof(char));
-    
-    GLCall(glGetShaderInfoLog(id, length, &length, message));
-    std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader: " << std::endl;
-    std::cout << message << std::endl;
-
-    GLCall(glDeleteShader(id));
-    return 0;
-  }
-
-  return id;
+void Shader::SetUniform1i(UniformHandle uniform, int v0){
+  if(!IsReady()){
+    if(uniform.IsValid()){
+      m_Fallback->SetUniform1i(m_Uniforms[uniform.slot].name, v0);
+    }
+    HoldValue(uniform, GL_INT, &v0, sizeof(v0));
+    return;
+  }
+  SetValue(uniform, GL_INT, &v0, sizeof(v0));
+}
+
+void Shader::SetUniform1f(UniformHandle uniform, float v0){
+  if(!IsReady()){
+    if(uniform.IsValid()){
+      m_Fallback->SetUniform1f(m_Uniforms[uniform.slot].name, v0);
+    }
+    HoldValue(uniform, GL_FLOAT, &v0, sizeof(v0));
+    return;
+  }
+  SetValue(uniform, GL_FLOAT, &v0, sizeof(v0));
+}
+
+void Shader::SetUniform4f(UniformHandle uniform, float v0, float v1, float v2, float v3){
+  if(!IsReady()){
+    if(uniform.IsValid()){
+      m_Fallback->SetUniform4f(m_Uniforms[uniform.slot].name, v0, v1, v2, v3);
+    }
+    float values[4] = { v0, v1, v2, v3 };
+    HoldValue(uniform, GL_FLOAT_VEC4, values, sizeof(values));
+    return;
+  }
+  float values[4] = { v0, v1, v2, v3 };
+  SetValue(uniform, GL_FLOAT_VEC4, values, sizeof(values));
+}
+
+void Shader::SetUniform1i(const std::string& name, int v0){
+  SetUniform1i(GetCachedUniform(name), v0);
+}
+
+void Shader::SetUniform1f(const std::string& name, float v0){
+  SetUniform1f(GetCachedUniform(name), v0);
+}
+
+void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3){
+  SetUniform4f(GetCachedUniform(name), v0, v1, v2, v3);
+}
+
+//* One hash lookup on a hit. A miss goes through GetUniform, which warns once for a name the program doesn't have.
+UniformHandle Shader::GetCachedUniform(const std::string& name){
+  auto cached = m_UniformCache.find(name);
+  if(cached != m_UniformCache.end()){
+    return cached->second;
+  }
+  UniformHandle uniform = GetUniform(name);
+  m_UniformCache.emplace(name, uniform);
+  return uniform;
+}
+
+void Shader::Reflect() const{
+  GLint count = 0;
+  GLint maxLength = 0;
+  GLCall(glGetProgramiv(m_RendererId, GL_ACTIVE_UNIFORMS, &count));
+  GLCall(glGetProgramiv(m_RendererId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+  std::vector<char> name(maxLength > 0 ? maxLength : 1);
+
+  for(GLint i = 0; i < count; ++i){
+    GLuint index = i;
+    //* Uniforms inside a block have no location, their values come from the bound buffer.
+    GLint block = -1;
+    GLCall(glGetActiveUniformsiv(m_RendererId, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block));
+    if(block != -1){
+      continue;
+    }
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    GLCall(glGetActiveUniform(m_RendererId, index, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data()));
+    std::string uniformName(name.data(), length);
+    if(uniformName.compare(0, 3, "gl_") == 0){
+      continue;
+    }
+    if(uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0){
+      uniformName.resize(uniformName.size() - 3);
+    }
+    ShaderUniform uniform{ uniformName, glGetUniformLocation(m_RendererId, uniformName.c_str()), type, size };
+
+    //* Handles given out before link point at these slots, so fill them in place instead of appending.
+    bool held = false;
+    for(ShaderUniform& entry : m_Uniforms){
+      if(entry.name == uniform.name){
+        entry = uniform;
+        held = true;
+        break;
+      }
+    }
+    if(!held){
+      m_Uniforms.push_back(uniform);
+    }
+  }
+  //* A freshly linked program starts from its own defaults, nothing shadowed applies to it. Values held while
+  //* it compiled stay dirty instead, the first flush sends them. Held slots come first, so indices still line up.
+  std::vector<UniformValue> held = std::move(m_UniformValues);
+  m_UniformValues.assign(m_Uniforms.size(), UniformValue());
+  m_DirtyBegin = m_DirtyEnd = 0;
+  for(unsigned int slot = 0; slot < held.size(); ++slot){
+    if(!held[slot].dirty || m_Uniforms[slot].location == -1){
+      continue;
+    }
+#ifndef NDEBUG
+    ASSERT(UniformTypeMatches(m_Uniforms[slot].type, held[slot].setterType));
+#endif
+    m_UniformValues[slot] = held[slot];
+    m_UniformValues[slot].known = false;
+    if(m_DirtyBegin == m_DirtyEnd){
+      m_DirtyBegin = slot;
+    }
+    m_DirtyEnd = slot + 1;
+  }
+  for(const ShaderUniform& entry : m_Uniforms){
+    if(entry.type == 0){
+      std::cout << "WARNING: uniform " << entry.name << " doesn't exist" << std::endl;
+    }
+  }
+
+  GLint blockCount = 0;
+  GLint maxBlockLength = 0;
+  GLCall(glGetProgramiv(m_RendererId, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount));
+  GLCall(glGetProgramiv(m_RendererId, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockLength));
+  std::vector<char> blockName(maxBlockLength > 0 ? maxBlockLength : 1);
+  m_UniformBlocks.clear();
+  for(GLint i = 0; i < blockCount; ++i){
+    GLsizei length = 0;
+    GLint dataSize = 0;
+    GLCall(glGetActiveUniformBlockName(m_RendererId, i, static_cast<GLsizei>(blockName.size()), &length, blockName.data()));
+    GLCall(glGetActiveUniformBlockiv(m_RendererId, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize));
+    std::string block(blockName.data(), length);
+    unsigned int binding = UniformBlockBindings::GetBinding(block);
+    if(binding != UniformBlockBindings::InvalidBinding){
+      GLCall(glUniformBlockBinding(m_RendererId, i, binding));
+    }
+    m_UniformBlocks.push_back({ block, static_cast<unsigned int>(i), dataSize, binding });
+  }
+}
+
+ShaderProgramSource Shader::ParseShader(const std::string& vertex_file, const std::string& fragment_file, const std::vector<ShaderDefine>& defines){
+  PreprocessedShader vertex = ShaderPreprocessor::Process(vertex_file, defines);
+  PreprocessedShader fragment = ShaderPreprocessor::Process(fragment_file, defines);
+  return { std::move(vertex.source), std::move(fragment.source), ProgramRegistry::MakeKey(vertex.hash, fragment.hash) };
 }
 
 /*
-Creates the  shader using the CompileShader function.
+Creates the shader program, compiling and linking through ShaderStages.
 */
 unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader){
+  //* A binary saved by an earlier run skips compiling and linking completely.
+  unsigned long long key = ProgramBinaryCache::MakeKey(vertexShader, fragmentShader);
+  unsigned int cached = ProgramBinaryCache::Load(key);
+  if(cached){
+    return cached;
+  }
+
   //* Need to provide shader source code w our shader text and need to return something for that shader so we can bind it and then use it.
   //* Need to create our program
   unsigned int program = glCreateProgram();
-  //* Create vertex shader
-  unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-  //* Create fragment shader
-  unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+  //* Create the vertex and fragment shader
+  unsigned int stages[2] = {
+    ShaderStages::Compile(GL_VERTEX_SHADER, vertexShader),
+    ShaderStages::Compile(GL_FRAGMENT_SHADER, fragmentShader)
+  };
+  std::string log;
+  ShaderStages::CheckCompile(stages[0], "vertex shader", log);
+  ShaderStages::CheckCompile(stages[1], "fragment shader", log);
 
   //* We now need to attach these 2 shaders into our program.
   //* Can think of it like having 2 different files and attaching them to our main program.
-  GLCall(glAttachShader(program, vs));
-  GLCall(glAttachShader(program, fs));
-  GLCall(glLinkProgram(program));
+  //* The hint tells the driver we'll ask for the binary, some only keep it around when it is set before linking.
+  ShaderStages::Link(program, stages, 2, ProgramBinaryCache::HintRetrievable);
   GLCall(glValidateProgram(program));
+  ShaderStages::CheckLink(program, "program", log);
 
   //* Since the shaders have been attached to the program, we don't need the memory overhead anymore and can just delete them.
-  GLCall(glDeleteShader(vs));
-  GLCall(glDeleteShader(fs));
+  ShaderStages::DeleteStages(program, stages, 2);
+  std::cout << log;
+
+  //* Does nothing if the link failed, so a broken shader never ends up in the cache.
+  ProgramBinaryCache::Store(key, program);
 
   //* Return the program.
   return program;
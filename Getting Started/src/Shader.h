@@ -2,29 +2,172 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#include "ShaderPreprocessor.h"
+
+struct SharedProgram;
 
 struct ShaderProgramSource {
   std::string VertexSource;
   std::string FragmentSource;
+  //* ProgramRegistry key for the two sources together.
+  unsigned long long Key;
+};
+
+//* One active uniform as glGetActiveUniform reports it. Arrays are stored once under their name without "[0]".
+struct ShaderUniform {
+  std::string name;
+  int location;
+  unsigned int type;
+  int count;
+};
+
+struct ShaderUniformBlock {
+  std::string name;
+  unsigned int index;
+  int dataSize;
+  //* Assigned by UniformBlockBindings after link, the same for this block name in every program.
+  //* UniformBlockBindings::InvalidBinding once the binding points ran out, then the block is left unbound.
+  unsigned int binding;
+};
+
+/*
+An index into one shader's uniform table, resolved once with Shader::GetUniform and kept around.
+Setting through a handle is an array index and a glUniform call, no string, no hashing.
+Only means something to the shader that handed it out.
+*/
+struct UniformHandle {
+  int slot = -1;
+  inline bool IsValid() const { return slot >= 0; }
+};
+
+enum class UniformUploadMode {
+  //* The glUniform call happens inside the setter, unless the value is the one GL already has. The program has to be bound.
+  Immediate,
+  //* Setters only write the shadow. Bind() uploads whatever changed since the last Bind, so sets don't need the program bound.
+  Deferred,
+};
+
+//* Totals over every shader since the last ResetUploadStats. Reset once a frame to get per frame numbers.
+struct UniformUploadStats {
+  unsigned int uploads = 0;
+  //* Sets of the value the shadow already held, no GL call.
+  unsigned int skips = 0;
+  //* Deferred sets overwritten by another set before the flush, so only the last one was uploaded.
+  unsigned int merged = 0;
 };
 
 class Shader {
 public:
-  Shader(const std::string& vertex_filepath, const std::string& fragment_filepath);
+  //* Both files go through ShaderPreprocessor with defines. Same files and defines as a live Shader means the same program, no compile.
+  Shader(const std::string& vertex_filepath, const std::string& fragment_filepath, const std::vector<ShaderDefine>& defines = {});
+  /*
+  Compiles through ShaderCompiler instead of blocking. Until the program is ready, Bind() binds fallback and
+  uniforms go to fallback too, so the render loop keeps drawing something. fallback has to outlive this shader.
+  Uniforms set in the meantime are also held, the first Bind after link uploads the last value of each.
+  If the compile fails it stays on fallback for good.
+  */
+  Shader(const std::string& vertex_filepath, const std::string& fragment_filepath, Shader& fallback, const std::vector<ShaderDefine>& defines = {});
   ~Shader();
+  //* Holds one ProgramRegistry reference, a copy would give it back twice. Moving keeps a pending compile and its held uniforms.
+  Shader(const Shader&) = delete;
+  Shader& operator=(const Shader&) = delete;
+  Shader(Shader&& other) noexcept;
+  Shader& operator=(Shader&& other) noexcept;
 
   void Bind() const;
   void Unbind() const;
+  //* Always true for shaders built without a fallback.
+  bool IsReady() const;
+  //* The background compile failed, this shader draws with its fallback for good.
+  bool HasFailed() const;
+  //* The program Bind() would bind right now, the fallback's while this one is still compiling.
+  unsigned int GetBoundProgram() const;
+  /*
+  While this shader is compiling, every Bind that falls back also sets name to value on the fallback. That's
+  how a variant makes the uber shader draw like it, and it happens at Bind, so draws issued later and out of
+  order (RenderQueue) still get their own value. No effect once the program is ready.
+  */
+  void SetFallbackUniform(const std::string& name, int value);
+
+  /*
+  Looks name up in the table filled after link. A uniform the program doesn't have gets a warning and an
+  invalid handle, setting it does nothing, same as location -1 in GL.
+  On a shader still compiling, the name is held in the table and resolved once the program is ready.
+  */
+  UniformHandle GetUniform(const std::string& name);
+  inline const std::vector<ShaderUniform>& GetUniforms() const { return m_Uniforms; }
+  inline const std::vector<ShaderUniformBlock>& GetUniformBlocks() const { return m_UniformBlocks; }
+  //* GL_INVALID_INDEX when the program has no block by that name.
+  unsigned int GetUniformBlockIndex(const std::string& name) const;
 
   // Set uniforms
+  //? The handle versions are what per frame code should use. The name versions resolve the name on every call.
+  void SetUniform1i(UniformHandle uniform, int v0);
+  void SetUniform1f(UniformHandle uniform, float v0);
+  void SetUniform4f(UniformHandle uniform, float v0, float v1, float v2, float v3);
+  void SetUniform1i(const std::string& name, int v0);
+  void SetUniform1f(const std::string& name, float v0);
   void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
+
+  /*
+  Every set is compared against a CPU copy of the value and dropped if nothing changed. That only holds while
+  this Shader is the one setting the program's uniforms, after a raw glUniform call use InvalidateUniforms.
+  */
+  void SetUploadMode(UniformUploadMode mode);
+  inline UniformUploadMode GetUploadMode() const { return m_UploadMode; }
+  //* Forgets the shadowed values, the next set of each uniform goes to GL whatever it is.
+  void InvalidateUniforms();
+
+  static const UniformUploadStats& GetUploadStats();
+  static void ResetUploadStats();
 private:
-  ShaderProgramSource ParseShader(const std::string& vertex_file, const std::string& fragment_file);
-  unsigned int CompileShader(unsigned int type, const std::string& source);
+  //* Last value set through a handle, plus which setter it came from so a flush knows which glUniform to call.
+  struct UniformValue {
+    unsigned int bits[4] = {};
+    unsigned int setterType = 0;
+    bool known = false;
+    bool dirty = false;
+  };
+
+  void Release();
+  ShaderProgramSource ParseShader(const std::string& vertex_file, const std::string& fragment_file, const std::vector<ShaderDefine>& defines);
   unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-  unsigned int GetUniformLocation(const std::string& name);
+  //* Name to handle, one hash lookup per call. A name the program doesn't have is cached as an invalid handle.
+  UniformHandle GetCachedUniform(const std::string& name);
+  //* Fills m_Uniforms and m_UniformBlocks from the linked program, keeping the slots of names asked for earlier.
+  //* Also points every block at its binding from UniformBlockBindings.
+  void Reflect() const;
+  //* Compares against the shadow and uploads, marks dirty or drops the set depending on the mode.
+  //* Invalid handles and names the program turned out not to have do nothing. Debug builds check the GL type.
+  void SetValue(UniformHandle uniform, unsigned int setterType, const void* data, unsigned int size);
+  //* SetValue for a shader still compiling: only records the value, dirty, for Reflect to keep.
+  void HoldValue(UniformHandle uniform, unsigned int setterType, const void* data, unsigned int size);
+  void Upload(unsigned int slot) const;
+  //* Uploads the dirty slots between m_DirtyBegin and m_DirtyEnd. The program has to be bound.
+  void FlushUniforms() const;
+  //* Makes this Shader the one whose shadow GL matches, see the comment in Shader.cpp.
+  void ClaimUniforms() const;
   std::string m_vertex_FilePath;
   std::string m_fragment_FilePath;
   unsigned int m_RendererId;
-  std::unordered_map<std::string, int> m_UniformLocationCache;
+  std::unordered_map<std::string, UniformHandle> m_UniformCache;
+  //* Filled by Reflect, which for a shader with a fallback happens inside IsReady the first time it sees the link done.
+  mutable std::vector<ShaderUniform> m_Uniforms;
+  mutable std::vector<ShaderUniformBlock> m_UniformBlocks;
+  //* Parallel to m_Uniforms, one value per slot.
+  mutable std::vector<UniformValue> m_UniformValues;
+  UniformUploadMode m_UploadMode = UniformUploadMode::Immediate;
+  //* Empty when begin == end. Only the slots in between get looked at by a flush.
+  mutable unsigned int m_DirtyBegin = 0;
+  mutable unsigned int m_DirtyEnd = 0;
+  //* Shared with every Shader built from the same preprocessed sources.
+  SharedProgram* m_Program = nullptr;
+  Shader* m_Fallback = nullptr;
+  //* Resolved on m_Fallback, set by every Bind that falls back.
+  UniformHandle m_FallbackUniform;
+  int m_FallbackValue = 0;
+  //* Cleared the first time IsReady sees the compile finish, after that no more status lookups.
+  mutable bool m_Pending = false;
 };
\ No newline at end of file
@@ -0,0 +1,301 @@
+#include "ShaderCompiler.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "renderer.h"
+#include "GLExtensions.h"
+#include "DeletionQueue.h"
+#include "ProgramBinaryCache.h"
+#include "ShaderStages.h"
+
+struct CompileJob {
+  unsigned int program = 0;
+  unsigned long long key = 0;
+  //* Vertex and fragment stage objects, created on whichever thread compiles them.
+  unsigned int stages[2] = {};
+  //* Worker threads need the text, the other backends hand it to GL at submit time.
+  ProgramSource source;
+  //* Written by the worker before done is set, read by the GL thread after it sees done.
+  bool linked = false;
+  std::string log;
+  std::atomic<bool> done{false};
+  //* Released while still compiling, delete it as soon as it finishes.
+  bool released = false;
+};
+
+static ShaderCompilerBackend s_Backend = ShaderCompilerBackend::Synchronous;
+//* Submitted and not finished yet, GL thread only.
+static std::vector<std::unique_ptr<CompileJob>> s_Jobs;
+static std::unordered_map<unsigned int, ProgramStatus> s_Status;
+
+static std::vector<std::thread> s_Workers;
+static std::vector<GLFWwindow*> s_WorkerWindows;
+static std::mutex s_QueueMutex;
+static std::condition_variable s_QueueReady;
+static std::deque<CompileJob*> s_Queue;
+static bool s_Stopping = false;
+
+//* Compiling and linking only start the work, asking for GL_COMPILE_STATUS is what would block.
+static void CompileStages(CompileJob& job, const ProgramSource& source){
+  job.stages[0] = ShaderStages::Compile(GL_VERTEX_SHADER, source.vertex);
+  job.stages[1] = ShaderStages::Compile(GL_FRAGMENT_SHADER, source.fragment);
+}
+
+static void LinkStages(CompileJob& job){
+  ShaderStages::Link(job.program, job.stages, 2, ProgramBinaryCache::HintRetrievable);
+}
+
+//* Only called once the link is known to be done, so none of these queries wait. Frees the stage objects.
+static bool CollectResult(CompileJob& job){
+  ShaderStages::CheckCompile(job.stages[0], "vertex shader", job.log);
+  ShaderStages::CheckCompile(job.stages[1], "fragment shader", job.log);
+  bool linked = ShaderStages::CheckLink(job.program, "program", job.log);
+  ShaderStages::DeleteStages(job.program, job.stages, 2);
+  job.stages[0] = job.stages[1] = 0;
+  return linked;
+}
+
+//* GL thread side of a finished job.
+static void Finish(CompileJob& job){
+  if(!job.log.empty()){
+    std::cout << job.log;
+  }
+  if(job.released){
+    s_Status.erase(job.program);
+    DeletionQueue::Enqueue(GLObjectKind::Program, job.program);
+    return;
+  }
+  s_Status[job.program] = job.linked ? ProgramStatus::Ready : ProgramStatus::Failed;
+  if(job.linked){
+    ProgramBinaryCache::Store(job.key, job.program);
+  }
+}
+
+static void WorkerLoop(GLFWwindow* window){
+  glfwMakeContextCurrent(window);
+  for(;;){
+    CompileJob* job;
+    {
+      std::unique_lock<std::mutex> lock(s_QueueMutex);
+      s_QueueReady.wait(lock, []{ return s_Stopping || !s_Queue.empty(); });
+      if(s_Stopping){
+        break;
+      }
+      job = s_Queue.front();
+      s_Queue.pop_front();
+    }
+    //* Blocking is fine here, that's what the thread is for.
+    CompileStages(*job, job->source);
+    LinkStages(*job);
+    job->linked = CollectResult(*job);
+    //* The program has to be complete before another context touches it.
+    GLCall(glFinish());
+    job->done.store(true, std::memory_order_release);
+  }
+  glfwMakeContextCurrent(nullptr);
+}
+
+void ShaderCompiler::Init(GLFWwindow* shared, unsigned int workerCount){
+  if(GLAD_GL_KHR_parallel_shader_compile){
+    //* 0xFFFFFFFF lets the driver pick how many threads to use.
+    GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+    s_Backend = ShaderCompilerBackend::ParallelCompile;
+    return;
+  }
+  if(!shared || workerCount == 0){
+    s_Backend = ShaderCompilerBackend::Synchronous;
+    return;
+  }
+
+  //* Windows have to be made on the main thread, only making them current happens on the workers.
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  for(unsigned int i = 0; i < workerCount; ++i){
+    GLFWwindow* window = glfwCreateWindow(1, 1, "shader compiler", NULL, shared);
+    if(window == NULL){
+      break;
+    }
+    s_WorkerWindows.push_back(window);
+  }
+  glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+  if(s_WorkerWindows.empty()){
+    s_Backend = ShaderCompilerBackend::Synchronous;
+    return;
+  }
+
+  s_Stopping = false;
+  for(GLFWwindow* window : s_WorkerWindows){
+    s_Workers.emplace_back(WorkerLoop, window);
+  }
+  s_Backend = ShaderCompilerBackend::WorkerThreads;
+}
+
+void ShaderCompiler::Shutdown(){
+  {
+    std::lock_guard<std::mutex> lock(s_QueueMutex);
+    s_Stopping = true;
+    s_Queue.clear();
+  }
+  s_QueueReady.notify_all();
+  for(std::thread& worker : s_Workers){
+    worker.join();
+  }
+  s_Workers.clear();
+  for(GLFWwindow* window : s_WorkerWindows){
+    glfwDestroyWindow(window);
+  }
+  s_WorkerWindows.clear();
+
+  //* Nothing is compiling anymore. Unfinished programs count as failed, their owners still Release them.
+  for(const std::unique_ptr<CompileJob>& job : s_Jobs){
+    if(job->done.load(std::memory_order_acquire)){
+      Finish(*job);
+      continue;
+    }
+    for(unsigned int stage : job->stages){
+      if(stage){
+        GLCall(glDeleteShader(stage));
+      }
+    }
+    if(job->released){
+      s_Status.erase(job->program);
+      DeletionQueue::Enqueue(GLObjectKind::Program, job->program);
+    }else{
+      s_Status[job->program] = ProgramStatus::Failed;
+    }
+  }
+  s_Jobs.clear();
+  s_Backend = ShaderCompilerBackend::Synchronous;
+}
+
+void ShaderCompiler::SubmitBatch(const ProgramSource* sources, unsigned int count, unsigned int* programs){
+  size_t first = s_Jobs.size();
+
+  //* Compiles first: with parallel compile each call just queues work on the driver's threads.
+  for(unsigned int i = 0; i < count; ++i){
+    unsigned long long key = ProgramBinaryCache::MakeKey(sources[i].vertex, sources[i].fragment);
+    unsigned int cached = ProgramBinaryCache::Load(key);
+    if(cached){
+      programs[i] = cached;
+      s_Status[cached] = ProgramStatus::Ready;
+      continue;
+    }
+
+    std::unique_ptr<CompileJob> job = std::make_unique<CompileJob>();
+    job->program = glCreateProgram();
+    job->key = key;
+    if(s_Backend == ShaderCompilerBackend::WorkerThreads){
+      job->source = sources[i];
+    }else{
+      CompileStages(*job, sources[i]);
+    }
+    programs[i] = job->program;
+    s_Status[job->program] = ProgramStatus::Pending;
+    s_Jobs.push_back(std::move(job));
+  }
+
+  //* Then every link.
+  if(s_Backend == ShaderCompilerBackend::WorkerThreads){
+    {
+      std::lock_guard<std::mutex> lock(s_QueueMutex);
+      for(size_t i = first; i < s_Jobs.size(); ++i){
+        s_Queue.push_back(s_Jobs[i].get());
+      }
+    }
+    s_QueueReady.notify_all();
+    return;
+  }
+  for(size_t i = first; i < s_Jobs.size(); ++i){
+    LinkStages(*s_Jobs[i]);
+  }
+  if(s_Backend == ShaderCompilerBackend::Synchronous){
+    for(size_t i = first; i < s_Jobs.size(); ++i){
+      s_Jobs[i]->linked = CollectResult(*s_Jobs[i]);
+      Finish(*s_Jobs[i]);
+    }
+    s_Jobs.resize(first);
+  }
+}
+
+unsigned int ShaderCompiler::Submit(const std::string& vertexSource, const std::string& fragmentSource){
+  ProgramSource source{ vertexSource, fragmentSource };
+  unsigned int program = 0;
+  SubmitBatch(&source, 1, &program);
+  return program;
+}
+
+void ShaderCompiler::Poll(){
+  for(size_t i = 0; i < s_Jobs.size();){
+    CompileJob& job = *s_Jobs[i];
+    bool finished;
+    if(s_Backend == ShaderCompilerBackend::WorkerThreads){
+      finished = job.done.load(std::memory_order_acquire);
+    }else{
+      GLint complete = GL_FALSE;
+      GLCall(glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &complete));
+      finished = complete == GL_TRUE;
+      if(finished){
+        job.linked = CollectResult(job);
+      }
+    }
+    if(!finished){
+      ++i;
+      continue;
+    }
+    Finish(job);
+    //* Order doesn't matter, swap the last one in.
+    s_Jobs[i] = std::move(s_Jobs.back());
+    s_Jobs.pop_back();
+  }
+}
+
+ProgramStatus ShaderCompiler::GetStatus(unsigned int program){
+  auto it = s_Status.find(program);
+  return it != s_Status.end() ? it->second : ProgramStatus::Ready;
+}
+
+void ShaderCompiler::Release(unsigned int program){
+  if(program == 0){
+    return;
+  }
+  auto it = s_Status.find(program);
+  if(it != s_Status.end() && it->second == ProgramStatus::Pending){
+    for(const std::unique_ptr<CompileJob>& job : s_Jobs){
+      if(job->program == program){
+        job->released = true;
+      }
+    }
+    return;
+  }
+  if(it != s_Status.end()){
+    s_Status.erase(it);
+  }
+  DeletionQueue::Enqueue(GLObjectKind::Program, program);
+}
+
+unsigned int ShaderCompiler::GetPendingCount(){
+  return static_cast<unsigned int>(s_Jobs.size());
+}
+
+ShaderCompilerBackend ShaderCompiler::GetBackend(){
+  return s_Backend;
+}
+
+const char* ShaderCompiler::GetBackendName(){
+  switch(s_Backend){
+    case ShaderCompilerBackend::ParallelCompile: return "KHR_parallel_shader_compile";
+    case ShaderCompilerBackend::WorkerThreads: return "shared context workers";
+    case ShaderCompilerBackend::Synchronous: return "synchronous";
+  }
+  return "unknown";
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+
+struct GLFWwindow;
+
+enum class ProgramStatus {
+  Pending,
+  Ready,
+  Failed,
+};
+
+enum class ShaderCompilerBackend {
+  //* glCompileShader / glLinkProgram return right away and GL_COMPLETION_STATUS_KHR says when they're done.
+  ParallelCompile,
+  //* Hidden windows sharing objects with the main context compile and link on their own threads.
+  WorkerThreads,
+  //* Neither of the above, Submit compiles and links before it returns.
+  Synchronous,
+};
+
+struct ProgramSource {
+  std::string vertex;
+  std::string fragment;
+};
+
+/*
+Compiles programs without waiting on them. Submit hands back a program name straight away (or one from
+ProgramBinaryCache) and Poll, once a frame, checks what finished without ever blocking on the driver.
+Until GetStatus says Ready, draw with something else. Shader's fallback constructor does that for you.
+Init and everything else runs on the GL thread. Shutdown before the main context goes away.
+*/
+class ShaderCompiler {
+public:
+  //* shared is the main window. workerCount is only used without KHR_parallel_shader_compile, 0 means compile synchronously.
+  static void Init(GLFWwindow* shared, unsigned int workerCount = 2);
+  static void Shutdown();
+
+  //* Issues every compile first and every link after, so the driver has all of them in flight at once.
+  static void SubmitBatch(const ProgramSource* sources, unsigned int count, unsigned int* programs);
+  static unsigned int Submit(const std::string& vertexSource, const std::string& fragmentSource);
+
+  //* Checks every pending program once, never waits. Finished ones get their logs printed and go into ProgramBinaryCache.
+  static void Poll();
+  //* Programs the compiler never saw count as Ready.
+  static ProgramStatus GetStatus(unsigned int program);
+  //* Use instead of deleting a submitted program. A pending one is deleted once its compile is done with it.
+  static void Release(unsigned int program);
+
+  static unsigned int GetPendingCount();
+  static ShaderCompilerBackend GetBackend();
+  static const char* GetBackendName();
+};
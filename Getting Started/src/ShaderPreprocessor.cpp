@@ -0,0 +1,177 @@
+#include "ShaderPreprocessor.h"
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+#include "FileLoader.h"
+
+//* A file split at its #include lines. text is everything up to the include, include is empty for the last chunk.
+struct ShaderChunk {
+  std::string text;
+  std::string include;
+  //* Line number right after the #include, where #line resumes once the included file is done.
+  unsigned int resumeLine = 0;
+};
+
+struct ShaderFile {
+  std::filesystem::file_time_type writeTime;
+  std::vector<ShaderChunk> chunks;
+};
+
+static std::unordered_map<std::string, ShaderFile> s_Files;
+static ShaderPreprocessorStats s_Stats;
+
+static unsigned long long Fnv1a(const std::string& text){
+  unsigned long long hash = 14695981039346656037ull;
+  for(unsigned char c : text){
+    hash = (hash ^ c) * 1099511628211ull;
+  }
+  return hash;
+}
+
+//* The path between the quotes (or angle brackets) if line is an #include, empty otherwise.
+static std::string_view ParseInclude(std::string_view line){
+  size_t start = line.find_first_not_of(" \t");
+  if(start == std::string_view::npos || line.compare(start, 8, "#include") != 0){
+    return {};
+  }
+  size_t open = line.find_first_of("\"<", start + 8);
+  if(open == std::string_view::npos){
+    return {};
+  }
+  size_t close = line.find(line[open] == '"' ? '"' : '>', open + 1);
+  return close == std::string_view::npos ? std::string_view() : line.substr(open + 1, close - open - 1);
+}
+
+static const ShaderFile* LoadFile(const std::string& path){
+  std::error_code error;
+  std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, error);
+  if(error){
+    std::cout << "ERROR: can't load file " << path << ": " << error.message() << std::endl;
+    return nullptr;
+  }
+  auto cached = s_Files.find(path);
+  if(cached != s_Files.end() && cached->second.writeTime == writeTime){
+    ++s_Stats.cacheHits;
+    return &cached->second;
+  }
+
+  FileData data = FileLoader::Load(path);
+  if(!data.IsValid()){
+    return nullptr;
+  }
+  ShaderFile file;
+  file.writeTime = writeTime;
+  //* Walk the lines in place and copy whole runs of them between includes, not one line at a time.
+  std::string_view text = data.GetView();
+  ShaderChunk chunk;
+  size_t chunkStart = 0;
+  size_t lineStart = 0;
+  unsigned int lineNumber = 0;
+  while(lineStart < text.size()){
+    size_t lineEnd = text.find('\n', lineStart);
+    size_t next = lineEnd == std::string_view::npos ? text.size() : lineEnd + 1;
+    ++lineNumber;
+    std::string_view include = ParseInclude(text.substr(lineStart, next - lineStart));
+    if(!include.empty()){
+      chunk.text.assign(text.data() + chunkStart, lineStart - chunkStart);
+      chunk.include = std::string(include);
+      chunk.resumeLine = lineNumber + 1;
+      file.chunks.push_back(std::move(chunk));
+      chunk = ShaderChunk();
+      chunkStart = next;
+    }
+    lineStart = next;
+  }
+  chunk.text.assign(text.data() + chunkStart, text.size() - chunkStart);
+  //* A last line without a newline would run into whatever gets pasted after this file.
+  if(!chunk.text.empty() && chunk.text.back() != '\n'){
+    chunk.text += '\n';
+  }
+  file.chunks.push_back(std::move(chunk));
+  ++s_Stats.fileReads;
+  return &(s_Files[path] = std::move(file));
+}
+
+static void Expand(const std::string& path, PreprocessedShader& out, std::vector<std::string>& stack){
+  const ShaderFile* file = LoadFile(path);
+  if(!file){
+    return;
+  }
+  unsigned int index = static_cast<unsigned int>(out.files.size());
+  out.files.push_back(path);
+  stack.push_back(path);
+
+  std::filesystem::path directory = std::filesystem::path(path).parent_path();
+  for(const ShaderChunk& chunk : file->chunks){
+    out.source += chunk.text;
+    if(chunk.include.empty()){
+      continue;
+    }
+    std::string included = (directory / chunk.include).lexically_normal().generic_string();
+    bool cycle = false;
+    for(const std::string& open : stack){
+      cycle = cycle || open == included;
+    }
+    if(cycle){
+      std::cout << "WARNING: " << path << " includes " << included << " which is already being included, skipped" << std::endl;
+    }
+    bool seen = cycle;
+    for(const std::string& done : out.files){
+      seen = seen || done == included;
+    }
+    if(!seen){
+      out.source += "#line 1 " + std::to_string(out.files.size()) + "\n";
+      Expand(included, out, stack);
+    }
+    out.source += "#line " + std::to_string(chunk.resumeLine) + " " + std::to_string(index) + "\n";
+  }
+  stack.pop_back();
+}
+
+PreprocessedShader ShaderPreprocessor::Process(const std::string& path, const std::vector<ShaderDefine>& defines){
+  PreprocessedShader out;
+  std::vector<std::string> stack;
+  Expand(std::filesystem::path(path).lexically_normal().generic_string(), out, stack);
+
+  if(!defines.empty()){
+    //* #version has to stay the first thing in the shader, the defines go straight after it.
+    size_t version = out.source.find("#version");
+    size_t insert = 0;
+    unsigned int line = 1;
+    if(version != std::string::npos){
+      size_t end = out.source.find('\n', version);
+      insert = end == std::string::npos ? out.source.size() : end + 1;
+      for(size_t i = 0; i < insert; ++i){
+        line += out.source[i] == '\n';
+      }
+    }
+    std::ostringstream block;
+    for(const ShaderDefine& define : defines){
+      block << "#define " << define.name;
+      if(!define.value.empty()){
+        block << ' ' << define.value;
+      }
+      block << '\n';
+    }
+    block << "#line " << line << " 0\n";
+    out.source.insert(insert, block.str());
+  }
+  out.hash = Fnv1a(out.source);
+  return out;
+}
+
+void ShaderPreprocessor::ClearCache(){
+  s_Files.clear();
+}
+
+const ShaderPreprocessorStats& ShaderPreprocessor::GetStats(){
+  return s_Stats;
+}
+
+void ShaderPreprocessor::ResetStats(){
+  s_Stats = ShaderPreprocessorStats();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//* Becomes "#define name value" right after the #version line. value can be empty.
+struct ShaderDefine {
+  std::string name;
+  std::string value;
+};
+
+struct PreprocessedShader {
+  std::string source;
+  //* FNV-1a of source, so the same files with the same defines always hash the same.
+  unsigned long long hash = 0;
+  //* Every file that went in, the top one first. The second number in a compile error's "0(12)" indexes into this.
+  std::vector<std::string> files;
+};
+
+struct ShaderPreprocessorStats {
+  unsigned int fileReads = 0;
+  //* Includes served from the cache because the file hadn't changed on disk.
+  unsigned int cacheHits = 0;
+};
+
+/*
+Turns a GLSL file into something glShaderSource can take:
+  #include "path"   relative to the including file, pasted in with #line directives around it so errors
+                    point at the right file and line. Each file goes in once per shader, later includes of
+                    it are dropped, so shared files don't need guards. Cycles get a warning and are cut.
+  defines           injected after #version, for building permutations of one file.
+Each file is read and scanned for includes once, then cached until its modification time changes.
+GL thread or not, it doesn't touch GL, but it isn't thread safe.
+*/
+class ShaderPreprocessor {
+public:
+  static PreprocessedShader Process(const std::string& path, const std::vector<ShaderDefine>& defines = {});
+  //* Forgets every cached file, the next Process reads everything from disk.
+  static void ClearCache();
+
+  static const ShaderPreprocessorStats& GetStats();
+  static void ResetStats();
+};
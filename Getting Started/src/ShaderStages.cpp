@@ -0,0 +1,87 @@
+#include "ShaderStages.h"
+
+#include <iostream>
+
+#include "renderer.h"
+
+unsigned int ShaderStages::Compile(unsigned int type, const std::string& source){
+  unsigned int shader = glCreateShader(type);
+  const char* text = source.c_str();
+  //* The length saves the driver a strlen over the whole preprocessed source.
+  GLint length = static_cast<GLint>(source.size());
+  GLCall(glShaderSource(shader, 1, &text, &length));
+  GLCall(glCompileShader(shader));
+  return shader;
+}
+
+bool ShaderStages::CheckCompile(unsigned int shader, const std::string& name, std::string& log){
+  GLint success = GL_FALSE;
+  GLCall(glGetShaderiv(shader, GL_COMPILE_STATUS, &success));
+  if(success){
+    return true;
+  }
+  GLint length = 0;
+  GLCall(glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length));
+  std::string message(length > 0 ? length : 1, '\0');
+  GLCall(glGetShaderInfoLog(shader, static_cast<GLsizei>(message.size()), nullptr, message.data()));
+  log += "Failed to compile " + name + ":\n" + message.c_str() + '\n';
+  return false;
+}
+
+void ShaderStages::Link(unsigned int program, const unsigned int* shaders, unsigned int count, const std::function<void(unsigned int)>& beforeLink){
+  for(unsigned int i = 0; i < count; ++i){
+    GLCall(glAttachShader(program, shaders[i]));
+  }
+  if(beforeLink){
+    beforeLink(program);
+  }
+  GLCall(glLinkProgram(program));
+}
+
+bool ShaderStages::CheckLink(unsigned int program, const std::string& name, std::string& log){
+  GLint linked = GL_FALSE;
+  GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+  if(linked){
+    return true;
+  }
+  GLint length = 0;
+  GLCall(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+  std::string message(length > 0 ? length : 1, '\0');
+  GLCall(glGetProgramInfoLog(program, static_cast<GLsizei>(message.size()), nullptr, message.data()));
+  log += "Failed to link " + name + ":\n" + message.c_str() + '\n';
+  return false;
+}
+
+void ShaderStages::DeleteStages(unsigned int program, const unsigned int* shaders, unsigned int count){
+  for(unsigned int i = 0; i < count; ++i){
+    if(program){
+      GLCall(glDetachShader(program, shaders[i]));
+    }
+    GLCall(glDeleteShader(shaders[i]));
+  }
+}
+
+unsigned int ShaderStages::Build(const std::vector<ShaderStageSource>& stages, const std::string& name, const std::function<void(unsigned int)>& beforeLink){
+  std::vector<unsigned int> shaders;
+  std::string log;
+  bool compiled = true;
+  for(const ShaderStageSource& stage : stages){
+    shaders.push_back(Compile(stage.type, stage.source));
+    compiled = CheckCompile(shaders.back(), stage.name, log) && compiled;
+  }
+  if(!compiled){
+    DeleteStages(0, shaders.data(), static_cast<unsigned int>(shaders.size()));
+    std::cout << log;
+    return 0;
+  }
+
+  unsigned int program = glCreateProgram();
+  Link(program, shaders.data(), static_cast<unsigned int>(shaders.size()), beforeLink);
+  DeleteStages(program, shaders.data(), static_cast<unsigned int>(shaders.size()));
+  if(!CheckLink(program, name, log)){
+    std::cout << log;
+    GLCall(glDeleteProgram(program));
+    return 0;
+  }
+  return program;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+struct ShaderStageSource {
+  unsigned int type;
+  std::string source;
+  //* What the log calls it, "vertex shader" or the file it came from.
+  std::string name;
+};
+
+/*
+The compile, link and info log steps every program in here goes through: Shader, ShaderCompiler's jobs,
+ComputeShader and InstanceCuller's transform feedback program.
+Compile and Link only start the work. Nothing asks GL for a status until CheckCompile / CheckLink, so a
+background compile can start a job and come back for the result once GL_COMPLETION_STATUS_KHR says so.
+*/
+class ShaderStages {
+public:
+  static unsigned int Compile(unsigned int type, const std::string& source);
+  //* Appends "Failed to compile <name>:" and the info log to log if it didn't compile.
+  static bool CheckCompile(unsigned int shader, const std::string& name, std::string& log);
+  //* Attaches every stage and links. beforeLink gets the program first, for the settings that only count
+  //* when made before the link (transform feedback varyings, the binary retrievable hint).
+  static void Link(unsigned int program, const unsigned int* shaders, unsigned int count, const std::function<void(unsigned int)>& beforeLink = {});
+  static bool CheckLink(unsigned int program, const std::string& name, std::string& log);
+  //* Detaches and deletes the stage objects, a linked program keeps what it needs from them.
+  static void DeleteStages(unsigned int program, const unsigned int* shaders, unsigned int count);
+
+  //* All of the above in a row, for programs built on the spot. Prints the log and returns 0 if anything failed.
+  static unsigned int Build(const std::vector<ShaderStageSource>& stages, const std::string& name, const std::function<void(unsigned int)>& beforeLink = {});
+};
@@ -0,0 +1,78 @@
+#include "ShaderVariants.h"
+
+#include "Clock.h"
+
+static ShaderVariantStats s_Stats;
+
+//* Bit i becomes ((u_Features & (1 << i)) != 0), the uber shader reads the key at runtime.
+static std::vector<ShaderDefine> MakeUberDefines(const std::vector<std::string>& features){
+  std::vector<ShaderDefine> defines = { { "UBER_SHADER", "" } };
+  for(size_t i = 0; i < features.size(); ++i){
+    defines.push_back({ features[i], "((u_Features & " + std::to_string(1u << i) + ") != 0)" });
+  }
+  return defines;
+}
+
+ShaderVariants::ShaderVariants(const std::string& vertex_filepath, const std::string& fragment_filepath, const std::vector<std::string>& features)
+  : m_vertex_FilePath(vertex_filepath), m_fragment_FilePath(fragment_filepath), m_Features(features),
+    m_Uber(vertex_filepath, fragment_filepath, MakeUberDefines(features)) {
+}
+
+std::vector<ShaderDefine> ShaderVariants::MakeDefines(unsigned int key) const{
+  std::vector<ShaderDefine> defines;
+  for(size_t i = 0; i < m_Features.size(); ++i){
+    defines.push_back({ m_Features[i], key & (1u << i) ? "true" : "false" });
+  }
+  return defines;
+}
+
+ShaderVariants::Variant& ShaderVariants::GetVariant(unsigned int key){
+  auto found = m_Variants.find(key);
+  if(found != m_Variants.end()){
+    return found->second;
+  }
+  Variant& variant = m_Variants[key];
+  variant.shader = std::make_unique<Shader>(m_vertex_FilePath, m_fragment_FilePath, m_Uber, MakeDefines(key));
+  //* Until it's linked, binding the variant binds the uber shader with this key.
+  variant.shader->SetFallbackUniform("u_Features", static_cast<int>(key));
+  variant.requestedAt = Clock::NowMs();
+  return variant;
+}
+
+Shader& ShaderVariants::Bind(unsigned int key){
+  ++s_Stats.requests;
+  Variant& variant = GetVariant(key);
+  if(!variant.ready && variant.shader->IsReady()){
+    variant.ready = true;
+    ++s_Stats.swapped;
+    s_Stats.fallbackMs += Clock::NowMs() - variant.requestedAt;
+  }
+  if(variant.ready){
+    ++s_Stats.hits;
+  }else{
+    ++s_Stats.fallbacks;
+  }
+  variant.shader->Bind();
+  return *variant.shader;
+}
+
+void ShaderVariants::Prewarm(unsigned int key){
+  GetVariant(key);
+}
+
+unsigned int ShaderVariants::GetPendingCount() const{
+  unsigned int pending = 0;
+  for(const auto& variant : m_Variants){
+    const Shader& shader = *variant.second.shader;
+    pending += !variant.second.ready && !shader.IsReady() && !shader.HasFailed();
+  }
+  return pending;
+}
+
+const ShaderVariantStats& ShaderVariants::GetStats(){
+  return s_Stats;
+}
+
+void ShaderVariants::ResetStats(){
+  s_Stats = ShaderVariantStats();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+
+struct ShaderVariantStats {
+  //* Bind calls, one per draw that asked for a variant.
+  unsigned int requests = 0;
+  //* Requests the specialized variant was ready for.
+  unsigned int hits = 0;
+  //* Requests drawn with the uber shader while the variant compiled.
+  unsigned int fallbacks = 0;
+  //* Variants that finished and took over from the uber shader.
+  unsigned int swapped = 0;
+  //* Sum over swapped variants of the time between the first request and the swap.
+  double fallbackMs = 0.0;
+
+  inline float GetHitRate() const { return requests ? static_cast<float>(hits) / requests : 0.0f; }
+};
+
+/*
+Specialized permutations of one shader, compiled in the background the first time a draw asks for them.
+Bit i of a variant key switches on features[i]. The shader tests features as booleans, if(FEATURE_X), and
+includes "variants.glsl":
+  variant        every feature is #define'd to true or false, so the driver folds the branches away
+  uber shader    every feature is a test of the u_Features bitmask, so one program draws any key
+The uber shader is compiled up front. Until a variant's link finishes, Bind(key) binds the uber shader
+with u_Features = key, and the first Bind after the link swaps the variant in. Nothing waits on the compiler.
+Call ShaderCompiler::Poll once a frame. Without ShaderCompiler::Init, variants compile on first use instead.
+*/
+class ShaderVariants {
+public:
+  ShaderVariants(const std::string& vertex_filepath, const std::string& fragment_filepath, const std::vector<std::string>& features);
+  ShaderVariants(const ShaderVariants&) = delete;
+  ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+  /*
+  Binds whatever draws key right now and returns the variant's Shader. Set uniforms through it, while it's
+  still compiling they go to the uber shader. The returned Shader can go into a DrawPacket: binding it again
+  at issue time sets u_Features again, so the queue's reordering can't mix up keys. Other uniforms are still
+  per program, see DrawPacket.
+  */
+  Shader& Bind(unsigned int key);
+  //* Queues the compile without drawing, for keys we know are coming.
+  void Prewarm(unsigned int key);
+
+  inline Shader& GetUberShader() { return m_Uber; }
+  //* Variants still compiling. Failed ones aren't counted, they stay on the uber shader.
+  unsigned int GetPendingCount() const;
+  inline unsigned int GetVariantCount() const { return static_cast<unsigned int>(m_Variants.size()); }
+
+  static const ShaderVariantStats& GetStats();
+  static void ResetStats();
+private:
+  struct Variant {
+    std::unique_ptr<Shader> shader;
+    double requestedAt = 0.0;
+    bool ready = false;
+  };
+  Variant& GetVariant(unsigned int key);
+  std::vector<ShaderDefine> MakeDefines(unsigned int key) const;
+
+  std::string m_vertex_FilePath;
+  std::string m_fragment_FilePath;
+  std::vector<std::string> m_Features;
+  Shader m_Uber;
+  std::unordered_map<unsigned int, Variant> m_Variants;
+};
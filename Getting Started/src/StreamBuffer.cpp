@@ -0,0 +1,186 @@
+#include "StreamBuffer.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "renderer.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "Clock.h"
+
+StreamBuffer::StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount, StreamBufferBackend backend)
+  : m_rendererId(0), m_target(target), m_regionSize(regionSize), m_regionCount(regionCount), m_backend(backend),
+    m_region(0), m_head(0), m_persistent(nullptr), m_mapped(false), m_fences() {
+  if(m_backend == StreamBufferBackend::Auto){
+    m_backend = GLAD_GL_ARB_buffer_storage ? StreamBufferBackend::PersistentMapped : StreamBufferBackend::Unsynchronized;
+  }
+  if(m_backend == StreamBufferBackend::PersistentMapped && !GLAD_GL_ARB_buffer_storage){
+    m_backend = StreamBufferBackend::Unsynchronized;
+  }
+  //* Orphaning gets a fresh allocation every frame from the driver, so there's nothing to ring through.
+  if(m_backend == StreamBufferBackend::Orphaning){
+    m_regionCount = 1;
+  }
+  if(m_regionCount == 0){
+    m_regionCount = 1;
+  }
+  if(m_regionCount > MAX_REGIONS){
+    m_regionCount = MAX_REGIONS;
+  }
+
+  GLsizeiptr total = static_cast<GLsizeiptr>(m_regionSize) * m_regionCount;
+
+  GLCall(glGenBuffers(1, &m_rendererId));
+  //* Do all the setup through the copy write target, binding an element buffer here would end up in whatever VAO is bound.
+  GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_rendererId);
+
+  if(m_backend == StreamBufferBackend::PersistentMapped){
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLCall(glBufferStorage(GL_COPY_WRITE_BUFFER, total, nullptr, flags));
+    //* Checked by hand, a driver refusing the persistent map isn't a bug on our side, we just can't use it.
+    GLClearError();
+    GLCallBare(m_persistent = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total, flags)));
+    GLenum error = glGetError();
+    if(!m_persistent){
+      std::cout << "StreamBuffer: persistent map failed (GL error " << error << "), mapping per write instead" << std::endl;
+      //* glBufferStorage made the storage immutable, so it takes a new buffer to get glBufferData storage.
+      DeletionQueue::Enqueue(GLObjectKind::Buffer, m_rendererId);
+      GLCall(glGenBuffers(1, &m_rendererId));
+      GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_rendererId);
+      m_backend = StreamBufferBackend::Unsynchronized;
+    }
+  }
+  if(m_backend != StreamBufferBackend::PersistentMapped){
+    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, total, nullptr, GL_STREAM_DRAW));
+  }
+}
+
+StreamBuffer::~StreamBuffer(){
+  for(unsigned int i = 0; i < m_regionCount; ++i){
+    if(m_fences[i]){
+      GLCall(glDeleteSync(m_fences[i]));
+    }
+  }
+  if(m_persistent){
+    GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_rendererId);
+    GLCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+  }
+  DeletionQueue::Enqueue(GLObjectKind::Buffer, m_rendererId);
+}
+
+/*
+Makes sure the GPU is done reading a region before we write into it again.
+Polls first so the common case (fence long signaled) costs one call, then flushes and blocks.
+*/
+void StreamBuffer::WaitForRegion(unsigned int region){
+  GLsync fence = m_fences[region];
+  if(!fence){
+    return;
+  }
+  GLenum result;
+  GLCall(result = glClientWaitSync(fence, 0, 0));
+  if(result == GL_TIMEOUT_EXPIRED){
+    double start = Clock::NowMs();
+    ++m_stats.fenceWaits;
+    do {
+      GLCall(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000));
+    } while(result == GL_TIMEOUT_EXPIRED);
+    m_stats.stallMs += Clock::NowMs() - start;
+  }
+  GLCall(glDeleteSync(fence));
+  m_fences[region] = nullptr;
+}
+
+void* StreamBuffer::Map(unsigned int size, unsigned int& offset, unsigned int alignment){
+  //* Align the offset into the whole buffer, not the head. Regions start at region * regionSize, which
+  //* doesn't have to be a multiple of alignment.
+  GLintptr base = static_cast<GLintptr>(m_region) * m_regionSize;
+  GLintptr start = base + m_head;
+  if(alignment > 1){
+    start = (start + alignment - 1) / alignment * alignment;
+  }
+  //* 64 bit so a huge size can't wrap around and pass.
+  unsigned long long head = static_cast<unsigned long long>(start - base);
+  if(head + size > m_regionSize || m_mapped){
+    return nullptr;
+  }
+
+  //* The head and stats only move once there's a pointer to hand back, a failed Map leaves the region as it was.
+  if(m_backend == StreamBufferBackend::PersistentMapped){
+    if(!m_persistent){
+      return nullptr;
+    }
+    offset = static_cast<unsigned int>(start);
+    m_head = static_cast<unsigned int>(head + size);
+    m_stats.bytesWritten += size;
+    return m_persistent + start;
+  }
+
+  double begin = Clock::NowMs();
+  GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_rendererId);
+  GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+  if(m_backend == StreamBufferBackend::Orphaning && head == 0){
+    //* First write of the frame, let go of last frame's storage. After this nothing on the GPU can see the
+    //* new storage, so mapping it unsynchronized is safe.
+    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, m_regionSize, nullptr, GL_STREAM_DRAW));
+  }
+  void* ptr;
+  GLCall(ptr = glMapBufferRange(GL_COPY_WRITE_BUFFER, start, size, access));
+  m_stats.stallMs += Clock::NowMs() - begin;
+  m_mapped = ptr != nullptr;
+  if(m_mapped){
+    offset = static_cast<unsigned int>(start);
+    m_head = static_cast<unsigned int>(head + size);
+    m_stats.bytesWritten += size;
+  }
+  return ptr;
+}
+
+void StreamBuffer::Unmap(){
+  if(!m_mapped){
+    return;
+  }
+  GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_rendererId);
+  GLCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+  m_mapped = false;
+}
+
+unsigned int StreamBuffer::Write(const void* data, unsigned int size, unsigned int alignment){
+  unsigned int offset;
+  void* ptr = Map(size, offset, alignment);
+  if(!ptr){
+    return 0xFFFFFFFF;
+  }
+  memcpy(ptr, data, size);
+  Unmap();
+  return offset;
+}
+
+void StreamBuffer::EndFrame(){
+  Unmap();
+  if(m_backend != StreamBufferBackend::Orphaning){
+    GLCall(m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+  }
+  m_region = (m_region + 1) % m_regionCount;
+  m_head = 0;
+  WaitForRegion(m_region);
+}
+
+void StreamBuffer::Bind() const{
+  GLState::BindBuffer(m_target, m_rendererId);
+}
+
+void StreamBuffer::Unbind() const{
+  GLState::BindBuffer(m_target, 0);
+}
+
+const char* StreamBuffer::GetBackendName(StreamBufferBackend backend){
+  switch(backend){
+    case StreamBufferBackend::Auto: return "auto";
+    case StreamBufferBackend::PersistentMapped: return "persistent mapped";
+    case StreamBufferBackend::Orphaning: return "orphaning";
+    case StreamBufferBackend::Unsynchronized: return "unsynchronized";
+  }
+  return "unknown";
+}
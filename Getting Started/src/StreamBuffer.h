@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glad/glad.h>
+
+enum class StreamBufferBackend {
+  //* Picks PersistentMapped when ARB_buffer_storage is there, Unsynchronized otherwise.
+  Auto,
+  //* glBufferStorage + one persistent coherent map for the lifetime of the buffer.
+  PersistentMapped,
+  //* glBufferData(NULL) at the start of every frame so the driver hands us fresh storage.
+  Orphaning,
+  //* glMapBufferRange(GL_MAP_UNSYNCHRONIZED_BIT) into a region the fences say the GPU is done with.
+  Unsynchronized,
+};
+
+struct StreamBufferStats {
+  unsigned long long bytesWritten = 0;
+  //* Time spent waiting on fences plus time spent inside map / orphan calls, where the driver can block.
+  double stallMs = 0.0;
+  unsigned int fenceWaits = 0;
+};
+
+/*
+Vertex or index data that changes every frame.
+The storage is split into regionCount regions of regionSize bytes, one per frame in flight. Each frame writes
+linearly into its region, and EndFrame() drops a fence on it before moving to the next one, so we only ever
+wait on the GPU if it's regionCount frames behind.
+Offsets returned by Map / Write are byte offsets into the whole buffer, use them as the draw's base offset
+(or base vertex = offset / stride) since the region moves every frame.
+*/
+class StreamBuffer {
+public:
+  StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount = 3, StreamBufferBackend backend = StreamBufferBackend::Auto);
+  ~StreamBuffer();
+  StreamBuffer(const StreamBuffer&) = delete;
+  StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+  //* Returns somewhere to write size bytes this frame, or nullptr if the region is full or mapping failed.
+  //* A nullptr uses up nothing, the head and stats only move on success.
+  //* The offset into the whole buffer is aligned to alignment, pass the vertex stride so the base vertex comes out exact.
+  void* Map(unsigned int size, unsigned int& offset, unsigned int alignment = 4);
+  void Unmap();
+  //* Map, memcpy, Unmap. Returns the offset or 0xFFFFFFFF if it doesn't fit.
+  unsigned int Write(const void* data, unsigned int size, unsigned int alignment = 4);
+  void EndFrame();
+
+  void Bind() const;
+  void Unbind() const;
+
+  inline unsigned int GetRendererId() const { return m_rendererId; }
+  inline StreamBufferBackend GetBackend() const { return m_backend; }
+  inline unsigned int GetRegionSize() const { return m_regionSize; }
+  inline unsigned int GetRemaining() const { return m_regionSize - m_head; }
+  inline const StreamBufferStats& GetStats() const { return m_stats; }
+  static const char* GetBackendName(StreamBufferBackend backend);
+private:
+  void WaitForRegion(unsigned int region);
+
+  static const unsigned int MAX_REGIONS = 8;
+
+  unsigned int m_rendererId;
+  unsigned int m_target;
+  unsigned int m_regionSize;
+  unsigned int m_regionCount;
+  StreamBufferBackend m_backend;
+  unsigned int m_region;
+  unsigned int m_head;
+  //* Only used by PersistentMapped, the whole buffer stays mapped here.
+  unsigned char* m_persistent;
+  bool m_mapped;
+  GLsync m_fences[MAX_REGIONS];
+  StreamBufferStats m_stats;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+
+/*
+Hands values from one writer thread to one reader thread without locks and without either side ever
+waiting on the other. Three copies of T: the writer fills one, the reader looks at one, and the third sits
+in the middle holding the newest published value. Publish and Acquire each swap their copy with the middle
+one in a single atomic exchange. A value the reader never got to is simply overwritten by a newer one.
+The writer gets back whichever copy was in the middle, so it has to fill in every field again, not just
+what changed. Once published a copy belongs to the reader until the next Acquire, so treat it as immutable.
+*/
+template<typename T>
+class TripleBuffer {
+public:
+  TripleBuffer() = default;
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  //* Writer side. Fill this in, then Publish.
+  inline T& GetWriteBuffer() { return m_Buffers[m_Write]; }
+  void Publish(){
+    //* Release so the reader sees the writes to the copy, acquire so we don't touch the copy we get back
+    //* before the reader is done with it.
+    m_Write = m_Middle.exchange(m_Write | NEW_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+  }
+
+  //* Reader side. Takes the newest published value if there's one the reader hasn't seen, false otherwise.
+  bool Acquire(){
+    if(!(m_Middle.load(std::memory_order_relaxed) & NEW_BIT)){
+      return false;
+    }
+    m_Read = m_Middle.exchange(m_Read, std::memory_order_acq_rel) & INDEX_MASK;
+    return true;
+  }
+  //* The value from the last successful Acquire, default constructed before that.
+  inline const T& GetReadBuffer() const { return m_Buffers[m_Read]; }
+private:
+  static const unsigned int INDEX_MASK = 3;
+  //* Set by Publish on the index it leaves in the middle, cleared when Acquire takes it.
+  static const unsigned int NEW_BIT = 4;
+
+  T m_Buffers[3] = {};
+  unsigned int m_Write = 0;
+  unsigned int m_Read = 1;
+  //* Own cache line, so the two threads' copies don't bounce with it.
+  alignas(64) std::atomic<unsigned int> m_Middle{ 2 };
+};
@@ -0,0 +1,44 @@
+#include "UniformBlockBindings.h"
+
+#include <iostream>
+#include <unordered_map>
+
+#include "renderer.h"
+
+static std::unordered_map<std::string, unsigned int> s_Bindings;
+//* 0 until the first time it's needed, queried once.
+static unsigned int s_MaxBindings = 0;
+
+unsigned int UniformBlockBindings::GetBinding(const std::string& blockName){
+  auto found = s_Bindings.find(blockName);
+  if(found != s_Bindings.end()){
+    return found->second;
+  }
+  unsigned int binding = static_cast<unsigned int>(s_Bindings.size());
+  if(binding >= GetMaxBindings()){
+    std::cout << "WARNING: uniform block " << blockName << " would need binding " << binding << ", past the " << GetMaxBindings() << " GL has. It stays unbound" << std::endl;
+    //* Still stored, so the warning shows up once per name.
+    binding = InvalidBinding;
+  }
+  s_Bindings.emplace(blockName, binding);
+  return binding;
+}
+
+unsigned int UniformBlockBindings::GetBindingCount(){
+  unsigned int count = static_cast<unsigned int>(s_Bindings.size());
+  return count < GetMaxBindings() ? count : GetMaxBindings();
+}
+
+unsigned int UniformBlockBindings::GetMaxBindings(){
+  if(s_MaxBindings == 0){
+    GLint max = 0;
+    GLCall(glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &max));
+    //* 3.3 guarantees 36.
+    s_MaxBindings = max > 0 ? static_cast<unsigned int>(max) : 36;
+  }
+  return s_MaxBindings;
+}
+
+void UniformBlockBindings::Reset(){
+  s_Bindings.clear();
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+/*
+Hands out uniform buffer binding points by block name, so every program that declares "FrameConstants"
+reads it from the same binding. Shader asks for one per active block after link and points the block at it
+with glUniformBlockBinding, which 3.3 needs since layout(binding = N) only came in 4.2.
+Bind a buffer range to GetBinding(name) once and every shader using that block sees it.
+GL thread only.
+*/
+class UniformBlockBindings {
+public:
+  //* Same value as GL_INVALID_INDEX, without pulling GL into this header.
+  static constexpr unsigned int InvalidBinding = 0xFFFFFFFFu;
+
+  //* The first name gets 0, the next new one 1, and so on. A name past GL_MAX_UNIFORM_BUFFER_BINDINGS warns once
+  //* and gets InvalidBinding, callers skip binding it instead of handing GL an index it rejects.
+  static unsigned int GetBinding(const std::string& blockName);
+  static unsigned int GetBindingCount();
+  static unsigned int GetMaxBindings();
+  //* Forgets every name. Programs already linked keep pointing at their old bindings.
+  static void Reset();
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+#include <glad/glad.h>
+
+enum class UniformPacking {
+  //* Uniform blocks on any GL with UBOs. Arrays and structs round up to vec4.
+  Std140,
+  //* Shader storage blocks (4.3). Arrays of scalars and vec2 pack tight.
+  Std430,
+};
+
+//* GLSL vector and matrix types for block structs. Plain floats, the layout checks decide where they may sit.
+struct Vec2 { float v[2]; };
+struct Vec3 { float v[3]; };
+struct Vec4 { float v[4]; };
+struct IVec4 { int v[4]; };
+struct UVec4 { unsigned int v[4]; };
+//* Column major, four vec4 columns, the same in both packings.
+struct Mat4 { float m[16]; };
+
+/*
+Base alignment and size of each GLSL type, the rules from the GL spec's "Standard Uniform Block Layout".
+No vec3 arrays on purpose: their 16 byte stride never matches a C++ Vec3[], use Vec4.
+*/
+template<typename T> struct UniformTypeOf;
+template<> struct UniformTypeOf<float>        { static constexpr unsigned int value = GL_FLOAT,             alignment = 4,  size = 4; };
+template<> struct UniformTypeOf<int>          { static constexpr unsigned int value = GL_INT,               alignment = 4,  size = 4; };
+template<> struct UniformTypeOf<unsigned int> { static constexpr unsigned int value = GL_UNSIGNED_INT,      alignment = 4,  size = 4; };
+template<> struct UniformTypeOf<Vec2>         { static constexpr unsigned int value = GL_FLOAT_VEC2,        alignment = 8,  size = 8; };
+template<> struct UniformTypeOf<Vec3>         { static constexpr unsigned int value = GL_FLOAT_VEC3,        alignment = 16, size = 12; };
+template<> struct UniformTypeOf<Vec4>         { static constexpr unsigned int value = GL_FLOAT_VEC4,        alignment = 16, size = 16; };
+template<> struct UniformTypeOf<IVec4>        { static constexpr unsigned int value = GL_INT_VEC4,          alignment = 16, size = 16; };
+template<> struct UniformTypeOf<UVec4>        { static constexpr unsigned int value = GL_UNSIGNED_INT_VEC4, alignment = 16, size = 16; };
+template<> struct UniformTypeOf<Mat4>         { static constexpr unsigned int value = GL_FLOAT_MAT4,        alignment = 16, size = 64; };
+
+constexpr unsigned int AlignUniformOffset(unsigned int offset, unsigned int alignment){
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+//* One member of a block struct: where C++ put it and what GLSL needs to know to work out where std140/430 puts it.
+struct UniformMember {
+  unsigned int type;
+  unsigned int offset;
+  //* 0 for a plain member, the element count for an array.
+  unsigned int arrayCount;
+  //* sizeof one C++ element, has to equal the packing's array stride.
+  unsigned int elementSize;
+  unsigned int alignment;
+  unsigned int size;
+
+  constexpr unsigned int GetAlignment(UniformPacking packing) const{
+    return arrayCount && packing == UniformPacking::Std140 ? AlignUniformOffset(alignment, 16) : alignment;
+  }
+  constexpr unsigned int GetStride(UniformPacking packing) const{
+    return AlignUniformOffset(size, GetAlignment(packing));
+  }
+  constexpr unsigned int GetSize(UniformPacking packing) const{
+    return arrayCount ? GetStride(packing) * arrayCount : size;
+  }
+};
+
+template<typename Member>
+constexpr UniformMember MakeUniformMember(size_t offset){
+  using Element = std::remove_extent_t<Member>;
+  using Type = UniformTypeOf<Element>;
+  static_assert(std::rank_v<Member> <= 1, "Only one dimensional arrays in uniform blocks");
+  static_assert(!(std::rank_v<Member> == 1 && std::is_same_v<Element, Vec3>), "vec3 arrays have a 16 byte stride, use Vec4");
+  return { Type::value, static_cast<unsigned int>(offset), static_cast<unsigned int>(std::extent_v<Member>),
+    static_cast<unsigned int>(sizeof(Element)), Type::alignment, Type::size };
+}
+
+/*
+Offsets a block struct's members get under std140 or std430, computed at compile time and compared against
+the offsets the C++ compiler chose. When they agree the struct can be memcpy'd straight into the buffer.
+*/
+template<size_t N>
+struct UniformLayout {
+  std::array<UniformMember, N> members;
+  UniformPacking packing;
+  unsigned int structSize;
+
+  //* Index of the first member C++ put somewhere else than GLSL will look, N if there's none.
+  constexpr size_t FindMismatch() const{
+    unsigned int offset = 0;
+    for(size_t i = 0; i < N; ++i){
+      const UniformMember& member = members[i];
+      offset = AlignUniformOffset(offset, member.GetAlignment(packing));
+      if(member.offset != offset){
+        return i;
+      }
+      if(member.arrayCount && member.elementSize != member.GetStride(packing)){
+        return i;
+      }
+      offset += member.GetSize(packing);
+    }
+    return N;
+  }
+
+  //* What GL_UNIFORM_BLOCK_DATA_SIZE reports for the same block, std140 rounds the block up to a vec4.
+  constexpr unsigned int GetSize() const{
+    unsigned int offset = 0;
+    unsigned int alignment = packing == UniformPacking::Std140 ? 16 : 4;
+    for(const UniformMember& member : members){
+      offset = AlignUniformOffset(offset, member.GetAlignment(packing)) + member.GetSize(packing);
+      alignment = member.GetAlignment(packing) > alignment ? member.GetAlignment(packing) : alignment;
+    }
+    return AlignUniformOffset(offset, alignment);
+  }
+
+  constexpr bool IsValid() const{
+    return FindMismatch() == N && GetSize() <= structSize;
+  }
+};
+
+template<typename Block, typename... Members>
+constexpr UniformLayout<sizeof...(Members)> MakeUniformLayout(UniformPacking packing, Members... members){
+  static_assert(std::is_standard_layout_v<Block>, "Uniform block structs need a standard layout for offsetof");
+  return { { members... }, packing, static_cast<unsigned int>(sizeof(Block)) };
+}
+
+//* Specialized by UNIFORM_BLOCK, has a static constexpr Layout member.
+template<typename Block> struct UniformBlockOf;
+
+#define UNIFORM_MEMBER(Block, member) MakeUniformMember<decltype(Block::member)>(offsetof(Block, member))
+
+/*
+Declares a C++ struct as the CPU side of a GLSL block, members in declaration order:
+  struct DrawConstants { Vec4 offset; Vec4 color; float scale; float pad[3]; };
+  UNIFORM_BLOCK(DrawConstants, Std140, UNIFORM_MEMBER(DrawConstants, offset), UNIFORM_MEMBER(DrawConstants, color),
+    UNIFORM_MEMBER(DrawConstants, scale));
+Goes at namespace scope after the struct. If the compiler laid a member out differently than the packing
+wants (a float before a Vec4 without padding, say) or the struct is short of the block's size, it fails to compile.
+*/
+#define UNIFORM_BLOCK(Block, Packing, ...) \
+  template<> struct UniformBlockOf<Block> { \
+    static constexpr auto Layout = MakeUniformLayout<Block>(UniformPacking::Packing, __VA_ARGS__); \
+  }; \
+  static_assert(UniformBlockOf<Block>::Layout.FindMismatch() == UniformBlockOf<Block>::Layout.members.size(), #Block ": a member isn't where " #Packing " puts it, add padding before it"); \
+  static_assert(UniformBlockOf<Block>::Layout.IsValid(), #Block ": struct is smaller than the " #Packing " block, pad the end")
@@ -0,0 +1,55 @@
+#include "UniformRing.h"
+
+#include <cstring>
+
+#include "renderer.h"
+#include "GLState.h"
+#include "UniformBlockBindings.h"
+
+static unsigned int GetOffsetAlignment(){
+  GLint alignment = 0;
+  GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+  return alignment > 0 ? static_cast<unsigned int>(alignment) : 256;
+}
+
+//* StreamBuffer aligns each offset itself. Rounding the region up keeps region starts aligned, so none of the asked for size goes to padding.
+UniformRing::UniformRing(unsigned int regionSize, unsigned int regionCount, StreamBufferBackend backend)
+  : m_alignment(GetOffsetAlignment()),
+    m_buffer(GL_UNIFORM_BUFFER, AlignUniformOffset(regionSize, m_alignment), regionCount, backend) {
+}
+
+UniformAllocation UniformRing::Write(const void* data, unsigned int size){
+  UniformAllocation allocation;
+  void* ptr = Map(size, allocation);
+  if(!ptr){
+    return allocation;
+  }
+  memcpy(ptr, data, size);
+  Unmap();
+  return allocation;
+}
+
+void* UniformRing::Map(unsigned int size, UniformAllocation& allocation){
+  unsigned int offset = 0;
+  void* ptr = m_buffer.Map(size, offset, m_alignment);
+  allocation = UniformAllocation();
+  if(ptr){
+    allocation = { m_buffer.GetRendererId(), offset, size };
+  }
+  return ptr;
+}
+
+void UniformRing::Unmap(){
+  m_buffer.Unmap();
+}
+
+void UniformRing::EndFrame(){
+  m_buffer.EndFrame();
+}
+
+void UniformRing::Bind(unsigned int binding, const UniformAllocation& allocation){
+  if(!allocation.IsValid() || binding == UniformBlockBindings::InvalidBinding){
+    return;
+  }
+  GLState::BindBufferRange(GL_UNIFORM_BUFFER, binding, allocation.buffer, allocation.offset, allocation.size);
+}
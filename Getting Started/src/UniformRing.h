@@ -0,0 +1,48 @@
+#pragma once
+
+#include "StreamBuffer.h"
+#include "UniformLayout.h"
+
+//* A range of the ring holding one block's worth of constants. size 0 means the write didn't fit.
+struct UniformAllocation {
+  unsigned int buffer = 0;
+  unsigned int offset = 0;
+  unsigned int size = 0;
+
+  inline bool IsValid() const { return size != 0; }
+};
+
+/*
+Per frame uniform block data on top of a StreamBuffer. Each draw's constants are written at the next
+GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT boundary and bound with one glBindBufferRange, instead of a glUniform call
+per value. Frame wide blocks are written once and bound once. Call EndFrame() once per frame like the stream buffer.
+With the persistent mapped backend a write is a memcpy. The others map per write, so use Map/Unmap to write
+a frame's worth of constants in one go there.
+*/
+class UniformRing {
+public:
+  UniformRing(unsigned int regionSize, unsigned int regionCount = 3, StreamBufferBackend backend = StreamBufferBackend::Auto);
+  UniformRing(const UniformRing&) = delete;
+  UniformRing& operator=(const UniformRing&) = delete;
+
+  UniformAllocation Write(const void* data, unsigned int size);
+  //* Only takes structs declared with UNIFORM_BLOCK, so what gets copied is already laid out the way GLSL reads it.
+  template<typename Block>
+  UniformAllocation Write(const Block& block){
+    static_assert(UniformBlockOf<Block>::Layout.IsValid(), "Uniform ring writes need a UNIFORM_BLOCK struct");
+    return Write(&block, sizeof(Block));
+  }
+  //* Room for size bytes, or nullptr if this frame's region is full. Unmap before drawing with it.
+  void* Map(unsigned int size, UniformAllocation& allocation);
+  void Unmap();
+  void EndFrame();
+
+  //* binding usually comes from UniformBlockBindings::GetBinding. Invalid allocations and bindings are ignored.
+  static void Bind(unsigned int binding, const UniformAllocation& allocation);
+
+  inline unsigned int GetAlignment() const { return m_alignment; }
+  inline const StreamBuffer& GetBuffer() const { return m_buffer; }
+private:
+  unsigned int m_alignment;
+  StreamBuffer m_buffer;
+};
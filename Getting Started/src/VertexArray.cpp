@@ -1,43 +1,120 @@
 #include "VertexArray.h"
 #include "renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
 
 
 VertexArray::VertexArray(){
   GLCall(glGenVertexArrays(1, &m_renderer_id)); 
 }
 VertexArray::~VertexArray(){
-  GLCall(glDeleteVertexArrays(1, &m_renderer_id)); 
+  Release();
+}
+
+VertexArray::VertexArray(VertexArray&& other) noexcept: m_renderer_id(other.m_renderer_id), m_attributeCount(other.m_attributeCount) {
+  other.m_renderer_id = 0;
+  other.m_attributeCount = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept{
+  if(this != &other){
+    Release();
+    m_renderer_id = other.m_renderer_id;
+    m_attributeCount = other.m_attributeCount;
+    other.m_renderer_id = 0;
+    other.m_attributeCount = 0;
+  }
+  return *this;
+}
+
+//* A moved from VAO has id 0 and has nothing to delete.
+void VertexArray::Release(){
+  if(m_renderer_id){
+    DeletionQueue::Enqueue(GLObjectKind::VertexArray, m_renderer_id);
+    m_renderer_id = 0;
+  }
 }
 
 void VertexArray::Bind() const{
-  GLCall(glBindVertexArray(m_renderer_id));
+  GLState::BindVertexArray(m_renderer_id);
 }
 
 void VertexArray::Unbind() const{
-  GLCall(glBindVertexArray(0));
+  GLState::BindVertexArray(0);
 }
 
-void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout){
+void VertexArray::BindSource(const VertexBuffer& vb){
   Bind();
   vb.Bind();
+}
+
+void VertexArray::BindSource(const StreamBuffer& sb){
+  Bind();
+  sb.Bind();
+}
+
+void VertexArray::BindSource(const BufferAllocation& allocation){
+  Bind();
+  GLState::BindBuffer(GL_ARRAY_BUFFER, allocation.buffer);
+}
+
+void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor){
+  BindSource(vb);
+  SetLayout(layout, divisor);
+}
+
+void VertexArray::AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout, unsigned int divisor){
+  BindSource(sb);
+  SetLayout(layout, divisor);
+}
+
+void VertexArray::AddBuffer(const BufferAllocation& allocation, const VertexBufferLayout& layout, unsigned int divisor){
+  BindSource(allocation);
+  SetLayout(layout, divisor);
+}
 
+void VertexArray::SetLayout(const VertexBufferLayout& layout, unsigned int divisor){
   const auto& elements = layout.GetElements();
 
   unsigned int offset = 0;
 
   for(unsigned int i = 0; i < elements.size(); ++i){
     const auto& element = elements[i];
+    unsigned int index = m_attributeCount + i;
     
     //* Now we need to enable the vertex attribute
     //* Need to call glEnableVertexArray... to enable it so we can use it and so it can show
-    GLCall(glEnableVertexAttribArray(i));
+    GLCall(glEnableVertexAttribArray(index));
 
     //* This gets the attirbute of the buffer. It will take in the index(where to start the modified values)
     //* Then it will take the size or the number of things per vertex, then the type, then if we want it normalized
     //* normalized is basically if we have a 0-255 value and it needs to be turned into a 0-1f.
     //* Then the offset between each vertex which is 2 * sizeof(float) in this case.
     //? Then finally, the pointer is the offset to the other coordinates not posistion
-    glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), reinterpret_cast<const void*>(static_cast<uintptr_t>(offset)));
-    offset += element.count * element.GetSize(element.type);
+    SetAttribute(index, element.type, element.count, element.normalized, element.integer, layout.GetStride(), offset, divisor);
+    offset += element.GetByteSize();
   }
-}
\ No newline at end of file
+  m_attributeCount += static_cast<unsigned int>(elements.size());
+}
+
+//* Offsets and stride were worked out by VERTEX_LAYOUT, so this is just the GL calls.
+void VertexArray::SetLayout(const VertexAttribute* attributes, unsigned int count, unsigned int stride, unsigned int divisor){
+  for(unsigned int i = 0; i < count; ++i){
+    const VertexAttribute& attribute = attributes[i];
+    unsigned int index = m_attributeCount + i;
+    GLCall(glEnableVertexAttribArray(index));
+    SetAttribute(index, attribute.type, attribute.count, attribute.normalized, attribute.integer, stride, attribute.offset, divisor);
+  }
+  m_attributeCount += count;
+}
+
+//* glVertexAttribPointer turns integers into floats even with normalized off, ivec / uvec inputs need the I version.
+void VertexArray::SetAttribute(unsigned int index, unsigned int type, unsigned int count, unsigned char normalized, unsigned char integer, unsigned int stride, unsigned int offset, unsigned int divisor){
+  const void* pointer = reinterpret_cast<const void*>(static_cast<uintptr_t>(offset));
+  if(integer){
+    GLCall(glVertexAttribIPointer(index, count, type, stride, pointer));
+  }else{
+    GLCall(glVertexAttribPointer(index, count, type, normalized, stride, pointer));
+  }
+  GLCall(glVertexAttribDivisor(index, divisor));
+}
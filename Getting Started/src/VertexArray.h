@@ -1,16 +1,55 @@
 #pragma once
 
 #include "VertexBuffer.h"
+#include "StreamBuffer.h"
+#include "BufferHeap.h"
 #include "VertexBufferLayout.h"
+#include "VertexLayout.h"
 
 class VertexArray {
 public:
   VertexArray();
   ~VertexArray();
+  //* Move-only. The attribute count goes with the VAO, a moved-from array has neither.
+  VertexArray(const VertexArray&) = delete;
+  VertexArray& operator=(const VertexArray&) = delete;
+  VertexArray(VertexArray&& other) noexcept;
+  VertexArray& operator=(VertexArray&& other) noexcept;
   
-  void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+  /*
+  Every AddBuffer appends its attributes after the ones already there, so a mesh buffer followed by an
+  instance buffer gets locations 0..n-1 for the mesh and n.. for the instance data.
+  divisor 0 steps once per vertex, 1 once per instance, N once every N instances.
+  */
+  void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor = 0);
+  //* Attributes point at the start of the stream buffer, draw with base vertex = offset / stride.
+  void AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout, unsigned int divisor = 0);
+  //* Attributes point at the start of the allocation's heap block, not the allocation itself, so one VAO
+  //* serves every mesh in that block. Pick the mesh with base vertex = allocation.offset / stride.
+  void AddBuffer(const BufferAllocation& allocation, const VertexBufferLayout& layout, unsigned int divisor = 0);
+
+  //* Same as above with the layout declared by VERTEX_LAYOUT(Vertex, ...), e.g. va.AddBuffer<QuadVertex>(vb).
+  template<typename Vertex, typename Source>
+  void AddBuffer(const Source& source, unsigned int divisor = 0){
+    const auto& layout = VertexLayoutOf<Vertex>::Layout;
+    BindSource(source);
+    SetLayout(layout.attributes.data(), static_cast<unsigned int>(layout.attributes.size()), layout.stride, divisor);
+  }
+
+  //* How many attribute locations the buffers added so far use, the next AddBuffer starts here.
+  inline unsigned int GetAttributeCount() const { return m_attributeCount; }
+  inline unsigned int GetRendererId() const { return m_renderer_id; }
   void Bind() const;
   void Unbind() const;
 private:
+  void Release();
+  //* Binds the VAO and then the buffer the attributes will read from.
+  void BindSource(const VertexBuffer& vb);
+  void BindSource(const StreamBuffer& sb);
+  void BindSource(const BufferAllocation& allocation);
+  void SetLayout(const VertexBufferLayout& layout, unsigned int divisor);
+  void SetLayout(const VertexAttribute* attributes, unsigned int count, unsigned int stride, unsigned int divisor);
+  void SetAttribute(unsigned int index, unsigned int type, unsigned int count, unsigned char normalized, unsigned char integer, unsigned int stride, unsigned int offset, unsigned int divisor);
   unsigned int m_renderer_id;
+  unsigned int m_attributeCount = 0;
 };
\ No newline at end of file
@@ -1,25 +1,49 @@
 #include "VertexBuffer.h"
 
 #include "renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size){
   //* Open GL will make a singular buffer
   GLCall(glGenBuffers(1, &m_rendererId));
   //* creates a buffer of memory which says that it's an array and pass in the id of the buffer as well
-  GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_rendererId));
+  GLState::BindBuffer(GL_ARRAY_BUFFER, m_rendererId);
   //* This will be us resizing the buffer and starting to use it
   GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
 }
 
 VertexBuffer::~VertexBuffer(){
-  GLCall(glDeleteBuffers(1, &m_rendererId));
+  Release();
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept: m_rendererId(other.m_rendererId) {
+  other.m_rendererId = 0;
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept{
+  if(this != &other){
+    Release();
+    m_rendererId = other.m_rendererId;
+    other.m_rendererId = 0;
+  }
+  return *this;
+}
+
+//* A moved from buffer has id 0 and has nothing to delete.
+//* The glDeleteBuffers happens later in DeletionQueue::EndFrame once the GPU is done with it.
+void VertexBuffer::Release(){
+  if(m_rendererId){
+    DeletionQueue::Enqueue(GLObjectKind::Buffer, m_rendererId);
+    m_rendererId = 0;
+  }
 }
 
 
 void VertexBuffer::Bind() const{
-  GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_rendererId));
+  GLState::BindBuffer(GL_ARRAY_BUFFER, m_rendererId);
 }
 
 void VertexBuffer::Unbind() const{
-  GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+  GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
 }
\ No newline at end of file
@@ -1,10 +1,19 @@
+#pragma once
+
 class VertexBuffer {
 private:
+  void Release();
   unsigned int m_rendererId;
 public:
   VertexBuffer(const void* data, unsigned int size);
   ~VertexBuffer();
+  //* The destructor hands the buffer to the DeletionQueue, so there can only be one owner.
+  VertexBuffer(const VertexBuffer&) = delete;
+  VertexBuffer& operator=(const VertexBuffer&) = delete;
+  VertexBuffer(VertexBuffer&& other) noexcept;
+  VertexBuffer& operator=(VertexBuffer&& other) noexcept;
 
   void Bind() const;
   void Unbind() const;
+  inline unsigned int GetRendererId() const { return m_rendererId; }
 };
\ No newline at end of file
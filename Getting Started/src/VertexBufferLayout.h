@@ -2,22 +2,41 @@
 
 #include <vector>
 #include "renderer.h"
+#include "VertexFormats.h"
 
 struct VertexBufferElement {
   unsigned int type;
   unsigned int count;
   unsigned char normalized;
+  //* Set up with glVertexAttribIPointer instead of glVertexAttribPointer.
+  unsigned char integer;
   static unsigned int GetSize(unsigned int type){
     switch(type){
       case GL_FLOAT: return 4;
       case GL_UNSIGNED_INT: return 4;
+      case GL_INT: return 4;
+      case GL_HALF_FLOAT: return 2;
+      case GL_SHORT: return 2;
+      case GL_UNSIGNED_SHORT: return 2;
       case GL_UNSIGNED_BYTE: return 1;
+      case GL_BYTE: return 1;
     }
     ASSERT(false);
     return 0;
   }
+  //* Bytes per vertex. The packed formats fit all four components into a single word.
+  inline unsigned int GetByteSize() const {
+    if(type == GL_INT_2_10_10_10_REV || type == GL_UNSIGNED_INT_2_10_10_10_REV){
+      return 4;
+    }
+    return GetSize(type) * count;
+  }
 };
 
+/*
+Runtime layout built with Push<T>. Prefer VERTEX_LAYOUT from VertexLayout.h when the vertex is a struct,
+that one is worked out at compile time.
+*/
 class VertexBufferLayout {
 private:
   std::vector<VertexBufferElement> m_elements;
@@ -30,26 +49,53 @@ public:
       static_assert(std::is_same<T, float>::value, "Unsupported type passed to VertexBufferLayout::Push");
   }
 
-  template<>
-  void Push<float>(unsigned int count){
-    m_elements.push_back({ GL_FLOAT, count, GL_FALSE });
-    m_stride += VertexBufferElement::GetSize(GL_FLOAT) * count;
-  } 
-
-  template<>
-  void Push<unsigned int>(unsigned int count){
-    m_elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
-    m_stride += VertexBufferElement::GetSize(GL_UNSIGNED_INT) * count;
+  //* ivec / uvec shader inputs. Push<unsigned int> would hand the shader floats instead.
+  template<typename T>
+  void PushInteger(unsigned int count){
+    static_assert(IsIntegerAttribType<T>, "PushInteger needs an integer type");
+    AddElement({ GLTypeOf<T>::value, count, GL_FALSE, GL_TRUE });
   }
 
-  template<>
-  void Push<unsigned char>(unsigned int count){
-    m_elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-    m_stride += VertexBufferElement::GetSize(GL_UNSIGNED_BYTE) * count;
+  inline const std::vector<VertexBufferElement>& GetElements() const { return m_elements; }
+  inline unsigned int GetStride() const { return m_stride; }
+
+private:
+  void AddElement(const VertexBufferElement& element){
+    m_elements.push_back(element);
+    m_stride += element.GetByteSize();
   }
 
+};
 
-  inline const std::vector<VertexBufferElement> GetElements() const { return m_elements; }
-  inline unsigned int GetStride() const { return m_stride; }
+//* Explicit specializations have to live at namespace scope, GCC rejects them inside the class.
+template<>
+inline void VertexBufferLayout::Push<float>(unsigned int count){
+  AddElement({ GL_FLOAT, count, GL_FALSE, GL_FALSE });
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned int>(unsigned int count){
+  AddElement({ GL_UNSIGNED_INT, count, GL_FALSE, GL_FALSE });
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned char>(unsigned int count){
+  AddElement({ GL_UNSIGNED_BYTE, count, GL_TRUE, GL_FALSE });
+}
+
+template<>
+inline void VertexBufferLayout::Push<Half>(unsigned int count){
+  AddElement({ GL_HALF_FLOAT, count, GL_FALSE, GL_FALSE });
+}
+
+template<>
+inline void VertexBufferLayout::Push<Snorm16>(unsigned int count){
+  AddElement({ GL_SHORT, count, GL_TRUE, GL_FALSE });
+}
 
-};
\ No newline at end of file
+//* count is the number of packed words, which is always 1: one word is a whole vec4.
+template<>
+inline void VertexBufferLayout::Push<Packed1010102>(unsigned int count){
+  ASSERT(count == 1);
+  AddElement({ GL_INT_2_10_10_10_REV, 4, GL_TRUE, GL_FALSE });
+}
@@ -0,0 +1,171 @@
+#include "VertexFormatCache.h"
+
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "renderer.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+
+struct CachedFormat {
+  std::vector<VertexAttribute> attributes;
+  unsigned int stride;
+  //* Only used with ARB_vertex_attrib_binding, the fallback VAOs live in s_FallbackArrays.
+  unsigned int vertexArray;
+};
+
+static std::vector<CachedFormat> s_Formats;
+static std::unordered_multimap<unsigned long long, unsigned int> s_FormatsByHash;
+//* (format, buffer, offset) -> VAO, for contexts without separate attribute formats.
+static std::map<std::tuple<unsigned int, unsigned int, unsigned int>, unsigned int> s_FallbackArrays;
+
+//* FNV-1a, field by field so the padding inside VertexAttribute never ends up in the hash.
+static unsigned long long HashFormat(const VertexAttribute* attributes, unsigned int count, unsigned int stride){
+  unsigned long long hash = 14695981039346656037ull;
+  auto mix = [&hash](unsigned int value){
+    hash = (hash ^ value) * 1099511628211ull;
+  };
+  mix(stride);
+  for(unsigned int i = 0; i < count; ++i){
+    mix(attributes[i].type);
+    mix(attributes[i].count);
+    mix(attributes[i].normalized);
+    mix(attributes[i].integer);
+    mix(attributes[i].offset);
+  }
+  return hash;
+}
+
+static bool SameFormat(const CachedFormat& format, const VertexAttribute* attributes, unsigned int count, unsigned int stride){
+  if(format.stride != stride || format.attributes.size() != count){
+    return false;
+  }
+  for(unsigned int i = 0; i < count; ++i){
+    const VertexAttribute& a = format.attributes[i];
+    const VertexAttribute& b = attributes[i];
+    if(a.type != b.type || a.count != b.count || a.normalized != b.normalized || a.integer != b.integer || a.offset != b.offset){
+      return false;
+    }
+  }
+  return true;
+}
+
+bool VertexFormatCache::UsesAttribBinding(){
+  return GLAD_GL_ARB_vertex_attrib_binding != 0;
+}
+
+VertexFormat VertexFormatCache::GetFormat(const VertexBufferLayout& layout){
+  const auto& elements = layout.GetElements();
+  std::vector<VertexAttribute> attributes;
+  attributes.reserve(elements.size());
+  unsigned int offset = 0;
+  for(const VertexBufferElement& element : elements){
+    attributes.push_back({ element.type, element.count, element.normalized, element.integer, offset, element.GetByteSize() });
+    offset += element.GetByteSize();
+  }
+  return GetFormat(attributes.data(), static_cast<unsigned int>(attributes.size()), layout.GetStride());
+}
+
+VertexFormat VertexFormatCache::GetFormat(const VertexAttribute* attributes, unsigned int count, unsigned int stride){
+  unsigned long long hash = HashFormat(attributes, count, stride);
+  auto range = s_FormatsByHash.equal_range(hash);
+  for(auto it = range.first; it != range.second; ++it){
+    if(SameFormat(s_Formats[it->second], attributes, count, stride)){
+      return { it->second, stride };
+    }
+  }
+
+  CachedFormat format{ std::vector<VertexAttribute>(attributes, attributes + count), stride, 0 };
+  if(UsesAttribBinding()){
+    //* The formats never change after this, only the buffer on binding 0 does.
+    GLCall(glGenVertexArrays(1, &format.vertexArray));
+    GLState::BindVertexArray(format.vertexArray);
+    for(unsigned int i = 0; i < count; ++i){
+      const VertexAttribute& attribute = attributes[i];
+      GLCall(glEnableVertexAttribArray(i));
+      if(attribute.integer){
+        GLCall(glVertexAttribIFormat(i, attribute.count, attribute.type, attribute.offset));
+      }else{
+        GLCall(glVertexAttribFormat(i, attribute.count, attribute.type, attribute.normalized, attribute.offset));
+      }
+      GLCall(glVertexAttribBinding(i, 0));
+    }
+  }
+
+  unsigned int id = static_cast<unsigned int>(s_Formats.size());
+  s_Formats.push_back(std::move(format));
+  s_FormatsByHash.emplace(hash, id);
+  return { id, stride };
+}
+
+//* The old path: a VAO whose attribute pointers have the buffer and offset baked in.
+static unsigned int CreateFallbackArray(const CachedFormat& format, unsigned int buffer, unsigned int offset){
+  unsigned int vao;
+  GLCall(glGenVertexArrays(1, &vao));
+  GLState::BindVertexArray(vao);
+  GLState::BindBuffer(GL_ARRAY_BUFFER, buffer);
+  for(unsigned int i = 0; i < format.attributes.size(); ++i){
+    const VertexAttribute& attribute = format.attributes[i];
+    const void* pointer = reinterpret_cast<const void*>(static_cast<uintptr_t>(offset + attribute.offset));
+    GLCall(glEnableVertexAttribArray(i));
+    if(attribute.integer){
+      GLCall(glVertexAttribIPointer(i, attribute.count, attribute.type, format.stride, pointer));
+    }else{
+      GLCall(glVertexAttribPointer(i, attribute.count, attribute.type, attribute.normalized, format.stride, pointer));
+    }
+  }
+  return vao;
+}
+
+void VertexFormatCache::Bind(VertexFormat format, unsigned int buffer, unsigned int offset){
+  ASSERT(format.id < s_Formats.size());
+  const CachedFormat& cached = s_Formats[format.id];
+
+  if(UsesAttribBinding()){
+    GLState::BindVertexArray(cached.vertexArray);
+    GLState::BindVertexBuffer(0, buffer, offset, cached.stride);
+    return;
+  }
+
+  auto key = std::make_tuple(format.id, buffer, offset);
+  auto it = s_FallbackArrays.find(key);
+  if(it == s_FallbackArrays.end()){
+    it = s_FallbackArrays.emplace(key, CreateFallbackArray(cached, buffer, offset)).first;
+    return;
+  }
+  GLState::BindVertexArray(it->second);
+}
+
+void VertexFormatCache::OnDeleteBuffer(unsigned int buffer){
+  for(auto it = s_FallbackArrays.begin(); it != s_FallbackArrays.end();){
+    if(std::get<1>(it->first) == buffer){
+      DeletionQueue::Enqueue(GLObjectKind::VertexArray, it->second);
+      it = s_FallbackArrays.erase(it);
+    }else{
+      ++it;
+    }
+  }
+}
+
+void VertexFormatCache::Clear(){
+  for(const CachedFormat& format : s_Formats){
+    DeletionQueue::Enqueue(GLObjectKind::VertexArray, format.vertexArray);
+  }
+  for(const auto& fallback : s_FallbackArrays){
+    DeletionQueue::Enqueue(GLObjectKind::VertexArray, fallback.second);
+  }
+  s_Formats.clear();
+  s_FormatsByHash.clear();
+  s_FallbackArrays.clear();
+}
+
+unsigned int VertexFormatCache::GetFormatCount(){
+  return static_cast<unsigned int>(s_Formats.size());
+}
+
+unsigned int VertexFormatCache::GetVertexArrayCount(){
+  return UsesAttribBinding() ? GetFormatCount() : static_cast<unsigned int>(s_FallbackArrays.size());
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "VertexLayout.h"
+#include "VertexBufferLayout.h"
+
+//* A layout registered with VertexFormatCache. Cheap to copy, keep it next to the mesh.
+struct VertexFormat {
+  unsigned int id = 0xFFFFFFFF;
+  unsigned int stride = 0;
+
+  inline bool IsValid() const { return id != 0xFFFFFFFF; }
+};
+
+/*
+One VAO per unique vertex layout instead of one per mesh.
+With ARB_vertex_attrib_binding (4.3) the attribute formats are set once on the format's VAO with
+glVertexAttribFormat / glVertexAttribBinding, and switching meshes is just a glBindVertexBuffer on binding 0.
+Meshes sharing a buffer (a BufferHeap block) then cost no VAO or buffer switch at all.
+On 3.3 the buffer is baked into the attribute pointers, so it falls back to one glVertexAttribPointer VAO
+per (format, buffer, offset), which is still one per heap block rather than one per mesh.
+GL thread only. Call Clear() before the context goes away.
+*/
+class VertexFormatCache {
+public:
+  //* Hashes the layout and returns the existing format if an identical one was registered before.
+  static VertexFormat GetFormat(const VertexBufferLayout& layout);
+  static VertexFormat GetFormat(const VertexAttribute* attributes, unsigned int count, unsigned int stride);
+  template<typename Vertex>
+  static VertexFormat GetFormat(){
+    const auto& layout = VertexLayoutOf<Vertex>::Layout;
+    return GetFormat(layout.attributes.data(), static_cast<unsigned int>(layout.attributes.size()), layout.stride);
+  }
+
+  //* Binds the VAO for format with buffer as its vertex source. offset is in bytes.
+  static void Bind(VertexFormat format, unsigned int buffer, unsigned int offset = 0);
+
+  //* Drops the 3.3 fallback VAOs that still reference buffer. The deletion paths call this next to GLState::OnDeleteBuffer.
+  static void OnDeleteBuffer(unsigned int buffer);
+  //* Queues every VAO for deletion and forgets all formats.
+  static void Clear();
+
+  //* False on 3.3 contexts, where Bind takes the fallback path.
+  static bool UsesAttribBinding();
+  static unsigned int GetFormatCount();
+  static unsigned int GetVertexArrayCount();
+};
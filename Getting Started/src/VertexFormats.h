@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glad/glad.h>
+
+/*
+Storage types for quantized vertex data, fill them with VertexQuantizer.
+They're plain wrappers so a vertex struct can say what's in it, e.g.
+  struct PackedVertex { Half position[4]; Packed1010102 normal; Half uv[2]; };   // 16 bytes instead of 32
+*/
+
+//* IEEE 754 binary16. Positions within a few thousand units and UVs are fine, precision drops fast after 2048.
+struct Half {
+  uint16_t bits;
+};
+
+//* -1..1 float stored as -32767..32767, the shader gets it back as a float.
+struct Snorm16 {
+  int16_t value;
+};
+
+//* Three signed 10 bit components and a 2 bit w in one word (GL_INT_2_10_10_10_REV), x in the low bits.
+//* Made for unit normals and tangents, w can hold the bitangent sign.
+struct Packed1010102 {
+  uint32_t bits;
+};
+
+/*
+C++ component type -> GL type. components is how many shader components one value holds,
+normalized is whether GL has to scale it back to -1..1 / 0..1. Anything not listed here fails to compile.
+*/
+template<typename T> struct GLTypeOf { static_assert(sizeof(T) == 0, "Unsupported vertex attribute type"); };
+template<> struct GLTypeOf<float> { static constexpr unsigned int value = GL_FLOAT; static constexpr unsigned int components = 1; static constexpr bool normalized = false; };
+template<> struct GLTypeOf<int> { static constexpr unsigned int value = GL_INT; static constexpr unsigned int components = 1; static constexpr bool normalized = false; };
+template<> struct GLTypeOf<unsigned int> { static constexpr unsigned int value = GL_UNSIGNED_INT; static constexpr unsigned int components = 1; static constexpr bool normalized = false; };
+template<> struct GLTypeOf<short> { static constexpr unsigned int value = GL_SHORT; static constexpr unsigned int components = 1; static constexpr bool normalized = false; };
+template<> struct GLTypeOf<unsigned short> { static constexpr unsigned int value = GL_UNSIGNED_SHORT; static constexpr unsigned int components = 1; static constexpr bool normalized = false; };
+template<> struct GLTypeOf<signed char> { static constexpr unsigned int value = GL_BYTE; static constexpr unsigned int components = 1; static constexpr bool normalized = false; };
+template<> struct GLTypeOf<unsigned char> { static constexpr unsigned int value = GL_UNSIGNED_BYTE; static constexpr unsigned int components = 1; static constexpr bool normalized = false; };
+template<> struct GLTypeOf<Half> { static constexpr unsigned int value = GL_HALF_FLOAT; static constexpr unsigned int components = 1; static constexpr bool normalized = false; };
+template<> struct GLTypeOf<Snorm16> { static constexpr unsigned int value = GL_SHORT; static constexpr unsigned int components = 1; static constexpr bool normalized = true; };
+template<> struct GLTypeOf<Packed1010102> { static constexpr unsigned int value = GL_INT_2_10_10_10_REV; static constexpr unsigned int components = 4; static constexpr bool normalized = true; };
+
+//* Types glVertexAttribIPointer accepts, the shader reads them as int / uint without any conversion.
+template<typename T> inline constexpr bool IsIntegerAttribType = false;
+template<> inline constexpr bool IsIntegerAttribType<int> = true;
+template<> inline constexpr bool IsIntegerAttribType<unsigned int> = true;
+template<> inline constexpr bool IsIntegerAttribType<short> = true;
+template<> inline constexpr bool IsIntegerAttribType<unsigned short> = true;
+template<> inline constexpr bool IsIntegerAttribType<signed char> = true;
+template<> inline constexpr bool IsIntegerAttribType<unsigned char> = true;
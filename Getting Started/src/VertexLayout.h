@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+#include <glad/glad.h>
+
+#include "VertexFormats.h"
+
+//* One attribute of a vertex struct, everything VertexArray needs for glVertexAttribPointer.
+struct VertexAttribute {
+  unsigned int type;
+  unsigned int count;
+  unsigned char normalized;
+  //* Goes through glVertexAttribIPointer, so the shader gets the integers as they are.
+  unsigned char integer;
+  unsigned int offset;
+  unsigned int size;
+};
+
+//* float position[3] is 3 floats, float weight is 1, Packed1010102 normal is 4 packed into one word.
+template<typename Member, bool Normalized, bool Integer>
+constexpr VertexAttribute MakeVertexAttribute(size_t offset){
+  using Component = std::remove_all_extents_t<Member>;
+  using Type = GLTypeOf<Component>;
+  constexpr unsigned int count = static_cast<unsigned int>(sizeof(Member) / sizeof(Component)) * Type::components;
+  static_assert(count >= 1 && count <= 4, "Vertex attributes have 1 to 4 components");
+  static_assert(!Integer || IsIntegerAttribType<Component>, "Integer attributes need an integer member type");
+  static_assert(!(Integer && Normalized), "Integer attributes can't be normalized");
+  constexpr bool normalized = Normalized || Type::normalized;
+  return { Type::value, count, static_cast<unsigned char>(normalized ? GL_TRUE : GL_FALSE), static_cast<unsigned char>(Integer ? GL_TRUE : GL_FALSE), static_cast<unsigned int>(offset), static_cast<unsigned int>(sizeof(Member)) };
+}
+
+/*
+The whole layout of a vertex struct, worked out at compile time. No vector and no GetSize switch,
+VertexArray::AddBuffer<Vertex> just walks the array.
+*/
+template<size_t N>
+struct VertexLayout {
+  std::array<VertexAttribute, N> attributes;
+  unsigned int stride;
+
+  //* Attributes are in order, don't overlap and stay inside the struct.
+  constexpr bool IsValid() const{
+    unsigned int end = 0;
+    for(const VertexAttribute& attribute : attributes){
+      if(attribute.offset < end){
+        return false;
+      }
+      end = attribute.offset + attribute.size;
+    }
+    return end <= stride;
+  }
+
+  //* Every byte of the struct belongs to an attribute, so nothing got forgotten and there's no hidden padding.
+  constexpr bool IsPacked() const{
+    unsigned int total = 0;
+    for(const VertexAttribute& attribute : attributes){
+      total += attribute.size;
+    }
+    return total == stride;
+  }
+};
+
+template<typename Vertex, typename... Attributes>
+constexpr VertexLayout<sizeof...(Attributes)> MakeVertexLayout(Attributes... attributes){
+  static_assert(std::is_standard_layout_v<Vertex>, "Vertex structs need a standard layout for offsetof");
+  return { { attributes... }, static_cast<unsigned int>(sizeof(Vertex)) };
+}
+
+//* Specialized by VERTEX_LAYOUT, has a static constexpr Layout member.
+template<typename Vertex> struct VertexLayoutOf;
+
+#define VERTEX_ATTRIB(Vertex, member) MakeVertexAttribute<decltype(Vertex::member), false, false>(offsetof(Vertex, member))
+//* Integer data that the shader should see as 0-1 (or -1-1) floats, e.g. unsigned char color[4].
+//* Snorm16 and Packed1010102 are always normalized, VERTEX_ATTRIB is enough for those.
+#define VERTEX_ATTRIB_NORMALIZED(Vertex, member) MakeVertexAttribute<decltype(Vertex::member), true, false>(offsetof(Vertex, member))
+//* For ivec / uvec inputs like bone indices or material ids.
+#define VERTEX_ATTRIB_INTEGER(Vertex, member) MakeVertexAttribute<decltype(Vertex::member), false, true>(offsetof(Vertex, member))
+
+/*
+Declares the attributes of a vertex struct once, in shader location order:
+  struct QuadVertex { float position[2]; unsigned char color[4]; };
+  VERTEX_LAYOUT(QuadVertex, VERTEX_ATTRIB(QuadVertex, position), VERTEX_ATTRIB_NORMALIZED(QuadVertex, color));
+Goes at namespace scope after the struct. Overlapping attributes or bytes that no attribute covers fail to compile.
+*/
+#define VERTEX_LAYOUT(Vertex, ...) \
+  template<> struct VertexLayoutOf<Vertex> { \
+    static constexpr auto Layout = MakeVertexLayout<Vertex>(__VA_ARGS__); \
+  }; \
+  static_assert(VertexLayoutOf<Vertex>::Layout.IsValid(), #Vertex ": vertex attributes overlap or run past the end of the struct"); \
+  static_assert(VertexLayoutOf<Vertex>::Layout.IsPacked(), #Vertex ": vertex attributes don't cover the whole struct, add the missing member or explicit padding")
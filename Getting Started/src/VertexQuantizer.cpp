@@ -0,0 +1,141 @@
+#include "VertexQuantizer.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__F16C__)
+  #include <immintrin.h>
+  #define QUANTIZE_SIMD_F16C
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+  #define QUANTIZE_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  #include <arm_neon.h>
+  #define QUANTIZE_SIMD_NEON
+#endif
+
+static inline unsigned int FloatBits(float value){
+  unsigned int bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static inline float BitsFloat(unsigned int bits){
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/*
+Scalar float -> half with round to nearest even (the "fast3" version from Fabian Giesen's half conversion notes).
+Denormals come out right by letting the FPU do the shift: adding a magic number lines the
+mantissa up so the low bits are the half denormal.
+*/
+Half VertexQuantizer::ToHalf(float value){
+  const unsigned int f32Infinity = 255u << 23;
+  const unsigned int f16Max = (127u + 16u) << 23;
+  const unsigned int denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+  unsigned int f = FloatBits(value);
+  unsigned int sign = f & 0x80000000u;
+  f ^= sign;
+
+  unsigned int out;
+  if(f >= f16Max){
+    //* NaN stays a (quiet) NaN, everything else overflows to infinity.
+    out = f > f32Infinity ? 0x7E00u : 0x7C00u;
+  }else if(f < (113u << 23)){
+    out = FloatBits(BitsFloat(f) + BitsFloat(denormMagic)) - denormMagic;
+  }else{
+    unsigned int mantissaOdd = (f >> 13) & 1u;
+    f += (static_cast<unsigned int>(15 - 127) << 23) + 0xFFFu;
+    f += mantissaOdd;
+    out = f >> 13;
+  }
+  return { static_cast<uint16_t>(out | (sign >> 16)) };
+}
+
+float VertexQuantizer::FromHalf(Half value){
+  unsigned int sign = static_cast<unsigned int>(value.bits & 0x8000u) << 16;
+  unsigned int exponent = (value.bits >> 10) & 0x1Fu;
+  unsigned int mantissa = value.bits & 0x3FFu;
+
+  if(exponent == 0){
+    //* Zero or denormal, mantissa * 2^-24.
+    float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+    return BitsFloat(FloatBits(magnitude) | sign);
+  }
+  if(exponent == 31){
+    return BitsFloat(sign | 0x7F800000u | (mantissa << 13));
+  }
+  return BitsFloat(sign | ((exponent + 112u) << 23) | (mantissa << 13));
+}
+
+void VertexQuantizer::ToHalf(Half* dst, const float* src, size_t count){
+  size_t i = 0;
+#if defined(QUANTIZE_SIMD_F16C)
+  for(; i + 8 <= count; i += 8){
+    __m128i lo = _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+    __m128i hi = _mm_cvtps_ph(_mm_loadu_ps(src + i + 4), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi64(lo, hi));
+  }
+#elif defined(QUANTIZE_SIMD_NEON)
+  for(; i + 4 <= count; i += 4){
+    vst1_u16(reinterpret_cast<uint16_t*>(dst + i), vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+  }
+#endif
+  for(; i < count; ++i){
+    dst[i] = ToHalf(src[i]);
+  }
+}
+
+//* value is already multiplied by 32767, same order of operations as the SIMD loops so they round the same.
+static inline int16_t QuantizeSnorm16(float value){
+  value = value > 32767.0f ? 32767.0f : (value < -32767.0f ? -32767.0f : value);
+  return static_cast<int16_t>(std::lrint(value));
+}
+
+void VertexQuantizer::ToSnorm16(Snorm16* dst, const float* src, size_t count, float scale){
+  size_t i = 0;
+  const float factor = scale * 32767.0f;
+#if defined(QUANTIZE_SIMD_SSE2)
+  //* Clamp to +-32767 so -32768 never shows up (GL maps it to -1 too, but then -1 has two encodings).
+  const __m128 wideFactor = _mm_set1_ps(factor);
+  const __m128 high = _mm_set1_ps(32767.0f);
+  const __m128 low = _mm_set1_ps(-32767.0f);
+  for(; i + 8 <= count; i += 8){
+    __m128 a = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(src + i), wideFactor), high), low);
+    __m128 b = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), wideFactor), high), low);
+    //* cvtps rounds to nearest even like lrint below, packs can't saturate after the clamp.
+    __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+  }
+#elif defined(QUANTIZE_SIMD_NEON)
+  const float32x4_t high = vdupq_n_f32(32767.0f);
+  const float32x4_t low = vdupq_n_f32(-32767.0f);
+  for(; i + 8 <= count; i += 8){
+    float32x4_t a = vmaxq_f32(vminq_f32(vmulq_n_f32(vld1q_f32(src + i), factor), high), low);
+    float32x4_t b = vmaxq_f32(vminq_f32(vmulq_n_f32(vld1q_f32(src + i + 4), factor), high), low);
+    int16x8_t packed = vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b)));
+    vst1q_s16(reinterpret_cast<int16_t*>(dst + i), packed);
+  }
+#endif
+  for(; i < count; ++i){
+    dst[i] = { QuantizeSnorm16(src[i] * factor) };
+  }
+}
+
+static inline unsigned int QuantizeSnorm10(float value){
+  value = value > 1.0f ? 1.0f : (value < -1.0f ? -1.0f : value);
+  return static_cast<unsigned int>(std::lrint(value * 511.0f)) & 0x3FFu;
+}
+
+//* Scalar on purpose: it's one word per vertex and the xyz triples would need a transpose to go wide.
+void VertexQuantizer::ToPacked1010102(Packed1010102* dst, const float* normals, size_t vertexCount, int w){
+  unsigned int wBits = static_cast<unsigned int>(w) & 0x3u;
+  for(size_t i = 0; i < vertexCount; ++i){
+    const float* n = normals + i * 3;
+    dst[i] = { QuantizeSnorm10(n[0]) | (QuantizeSnorm10(n[1]) << 10) | (QuantizeSnorm10(n[2]) << 20) | (wBits << 30) };
+  }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+#include "VertexFormats.h"
+
+/*
+Converts float vertex streams into the smaller formats in VertexFormats.h at import time.
+A float position + normal + uv vertex is 32 bytes, Half[4] + Packed1010102 + Half[2] is 16.
+Every function works on count tightly packed floats (so 3 * vertexCount for positions) and writes
+count values to dst, interleave them into the vertex struct afterwards.
+Half uses F16C when the compiler has it (-mf16c), NEON on ARM, otherwise scalar. Snorm16 uses SSE2 / NEON.
+*/
+class VertexQuantizer {
+public:
+  //* Rounds to nearest even, values too big for a half become infinity.
+  static void ToHalf(Half* dst, const float* src, size_t count);
+  //* src is multiplied by scale first, so positions can be mapped into -1..1 with 1 / extent and
+  //* scaled back in the vertex shader. Anything outside -1..1 after that is clamped.
+  static void ToSnorm16(Snorm16* dst, const float* src, size_t count, float scale = 1.0f);
+  //* normals are xyz triples, w is the 2 bit field: -1, 0 or 1, e.g. the bitangent sign.
+  static void ToPacked1010102(Packed1010102* dst, const float* normals, size_t vertexCount, int w = 0);
+
+  static Half ToHalf(float value);
+  static float FromHalf(Half value);
+};
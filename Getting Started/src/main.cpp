@@ -6,11 +6,88 @@
 #include <string>
 #include <sstream>
 #include <csignal>
+#include <memory>
 
 #include "renderer.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "ResourceRegistry.h"
 #include "IndexBuffer.h"
 #include "VertexArray.h"
 #include "Shader.h"
+#include "ShaderCompiler.h"
+#include "ShaderVariants.h"
+#include "RenderQueue.h"
+#include "VertexLayout.h"
+#include "RenderThread.h"
+#include "TripleBuffer.h"
+
+//* One vertex of the quad. Matches layout(location = 0) in vertex.vert.
+struct Vertex2D {
+  float position[2];
+};
+VERTEX_LAYOUT(Vertex2D, VERTEX_ATTRIB(Vertex2D, position));
+
+//* What the simulation hands the render thread for one frame. Plain values only, nothing that points back
+//* into simulation state, so the render thread can keep drawing it while the next one is being built.
+struct FramePacket {
+  float r;
+  unsigned int frame;
+};
+
+//* Everything GL the loop draws with. Made in the render thread's init and dropped in its shutdown.
+struct Scene {
+  //* These are the vertices in the positions of the triangle(s)
+  Vertex2D positions[4] = {
+    { -0.5f, -0.5f },
+    {  0.5f, -0.5f },
+    {  0.5f,  0.5f },
+    { -0.5f,  0.5f },
+  };
+
+  //* This is now an index buffer
+  //* Specifies the indices of the vertices in the positions array that make up each triangle. The first
+  //* Triangle is made up of vertices 0, 1, and 2 and the second is of 3, 2, 0 and we don't need to re-define a vertex
+  //! ALL INDEX BUFFERS MUST BE UNSIGNED INTS NOT REGULAR INTS
+  //* IndexBuffer narrows them to bytes / shorts on upload when they fit.
+  unsigned int indices[6]{
+    0, 1, 2,
+    3, 2, 0
+  };
+
+  //* This creates a vertex array object and it encapsulates the state of all the attributes.
+  //* This includes the buffers they are sourced from, the attribute configurations such as data
+  //* type and number of components and the associated array buffer bindings.
+  //* Every bind goes through GLState, so no raw glBindVertexArray here or the shadow state goes stale.
+  VertexArray va;
+
+  //* Make a vertex buffer and don't need to bind it because it's automatically bound in the constructor.
+  VertexBuffer vb{ positions, sizeof(positions) };
+
+  //* Generates an index buffer
+  IndexBuffer ib{ indices, 6 };
+
+  //* Bit i of a key turns on feature i. Only the uber shader is compiled here, each key the loop reaches
+  //* draws with it until its own variant finishes compiling.
+  ShaderVariants variants{ "res/shaders/vertex.vert", "res/shaders/variant.frag",
+    { "FEATURE_INVERT", "FEATURE_GRAYSCALE", "FEATURE_CHECKER", "FEATURE_BANDS" } };
+  //* One handle per variant, resolved the first time its key comes up. A variant still compiling resolves it once linked.
+  UniformHandle u_Color[16];
+
+  //* Draws go in here and get issued sorted at the end of the frame.
+  RenderQueue queue;
+
+  Scene(){
+    //* The layout comes from VERTEX_LAYOUT above, worked out at compile time.
+    va.AddBuffer<Vertex2D>(vb);
+
+    //* We just need to bind these things below
+    va.Unbind();
+    vb.Unbind();
+    ib.Unbind();
+  }
+};
 
 int main()
 {
@@ -31,6 +108,10 @@ int main()
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
   #endif
 
+  //* Release builds don't check glGetError after every call, so ask for a debug context to get KHR_debug messages instead.
+  //* Debug builds want it too, for the performance and portability warnings glGetError never reports.
+  glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+
   //* This creates a window object, and the first two arguments are width and height while the third is the name
   //* and the fourth is if we want it to be fullscreen while the last we don't care about.
   GLFWwindow* window = glfwCreateWindow(500,500,"New Window",NULL,NULL);
@@ -44,81 +125,107 @@ int main()
   glfwMakeContextCurrent(window);
 
   gladLoadGL();
+  //* Anything newer than 3.3 (debug output etc.) isn't in our glad, so load it ourselves.
+  GLLoadExtensions((GLADloadproc)glfwGetProcAddress);
 
-  //* The area of the window that we want OpenGL to render in.
-  //* bottom left corner of our window, coordinates 0,0 to the top right corner of our window: 500,500
-  glViewport(0,0,500,500);
+  //* Tracked call sites are only right if the callback runs inside the GLCall that caused the message.
+  #ifdef GL_TRACK_CALL_SITES
+    bool debugOutput = GLDebugInit(true);
+  #else
+    bool debugOutput = GLDebugInit();
+  #endif
+  if(!debugOutput){
+    std::cout << "KHR_debug not available, falling back to one glGetError per frame\n";
+  }
 
-  glClearColor(0.4f,0.2f,0.7f,1.0f);
+  //* Shaders built from here on compile in the background while the loop keeps drawing.
+  //* Its worker windows have to be made here on the main thread, before the context moves to the render thread.
+  ShaderCompiler::Init(window);
 
-  //* does buffer stuff, will learn more about later.
-  glClear(GL_COLOR_BUFFER_BIT);
-  glfwSwapBuffers(window);
+  //* Everything GL from here to Stop runs on the render thread, in the three callbacks below. This thread
+  //* keeps polling events and simulating, one frame ahead of what's being drawn.
+  RenderThread renderThread(window);
+  //* The simulation publishes a FramePacket every frame, the render thread draws the newest one.
+  TripleBuffer<FramePacket> packets;
+  //* Created and destroyed on the render thread, like every GL object.
+  std::unique_ptr<Scene> scene;
 
-  //* These are the vertices in the positions of the triangle(s)
-  float positions[] = {
-    -0.5f, -0.5f,
-     0.5f, -0.5f,
-     0.5f,  0.5f,
-    -0.5f,  0.5f,
-  };
+  auto init = [&](){
+    //* The area of the window that we want OpenGL to render in.
+    //* bottom left corner of our window, coordinates 0,0 to the top right corner of our window: 500,500
+    glViewport(0,0,500,500);
 
-  //* This is now an index buffer
-  //* Specifies the indices of the vertices in the positions array that make up each triangle. The first
-  //* Triangle is made up of vertices 0, 1, and 2 and the second is of 3, 2, 0 and we don't need to re-define a vertex
-  //! ALL INDEX BUFFERS MUST BE UNSIGNED INTS NOT REGULAR INTS
-  unsigned int indices[]{
-    0, 1, 2,
-    3, 2, 0
+    glClearColor(0.4f,0.2f,0.7f,1.0f);
+
+    //* does buffer stuff, will learn more about later.
+    glClear(GL_COLOR_BUFFER_BIT);
+    glfwSwapBuffers(window);
+
+    scene = std::make_unique<Scene>();
   };
 
-  //* This creates a vertex array object and it encapsulates the state of all the attributes.
-  //* This includes the buffers they are sourced from, the attribute configurations such as data
-  //* type and number of components and the associated array buffer bindings.
-  //? Also don't know if I only need this for apple or if I need this for my desktop too.
-  unsigned int vao;
-  GLCall(glGenVertexArrays(1, &vao));
-  GLCall(glBindVertexArray(vao));
+  auto render = [&](){
+    //* Nothing new published means the simulation is behind, the last packet gets drawn again.
+    packets.Acquire();
+    const FramePacket& packet = packets.GetReadBuffer();
 
-  VertexArray va;
+    /* render heare */
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
 
-  //* Make a vertex buffer and don't need to bind it because it's automatically bound in the constructor.
-  VertexBuffer vb(positions, 4 * 2 * sizeof(float));  
+    //* A new feature combination every two seconds or so.
+    unsigned int key = packet.frame / 120 % 16;
+    Shader& shader = scene->variants.Bind(key);
+    if(!scene->u_Color[key].IsValid()){
+      scene->u_Color[key] = shader.GetUniform("u_Color");
+    }
+    shader.SetUniform4f(scene->u_Color[key], packet.r, 0.9f,1-packet.r,1.0f);
+    
+    //* The queue binds the VAO and index buffer and draws with glDrawElements, using the index type the buffer picked.
+    DrawPacket quad;
+    quad.shader = &shader;
+    quad.vertexArray = &scene->va;
+    quad.indexBuffer = &scene->ib;
+    scene->queue.Submit(quad);
+    scene->queue.Execute();
 
-  VertexBufferLayout layout;
-  layout.Push<float>(2);
-  va.AddBuffer(vb, layout);
+    //* Picks up finished compiles, the next Bind of their key swaps them in.
+    ShaderCompiler::Poll();
 
-  //* Generates an index buffer
-  IndexBuffer ib(indices, 6);
+    //* Report anything the driver complained about this frame.
+    GLDebugFlush();
 
-  Shader shader("res/shaders/vertex.vert", "res/shaders/fragment.frag");
-  shader.Bind();
-  shader.SetUniform4f("u_Color", 0.8f, 0.2f, 0.5f, 1.0f);
+    //* Actually delete whatever GL objects were dropped a few frames ago and the GPU is done with.
+    DeletionQueue::EndFrame();
+    //? The render thread swaps front and back buffers after this.
+  };
+
+  auto shutdown = [&](){
+    const RenderQueueStats& queueStats = scene->queue.GetStats();
+    std::cout << "Render queue: " << queueStats.packets << " draws last frame, " << queueStats.changesSubmitted << " state changes as submitted, "
+      << queueStats.changesSorted << " sorted\n";
+    std::cout << "Shader variants: " << scene->variants.GetPendingCount() << " still compiling\n";
+    //* The scene's GL names go into the DeletionQueue, flushed below once the context is back on this thread.
+    scene.reset();
+  };
+
+  renderThread.Start(init, render, shutdown);
 
   float r = 0.0;
+  unsigned int frame = 0;
   float increment = 0.01f; 
-
-  //* We just need to bind these things below
-  va.Unbind();
-  vb.Unbind();
-  ib.Unbind();
-  shader.Unbind();
+  double simulateMs = 0.0;
 
   //* This checks at the start of each loop if GLFW has instructed the window to close
   while(!glfwWindowShouldClose(window))
   {
-    /* render heare */
-    GLCall(glClear(GL_COLOR_BUFFER_BIT));
-
-    shader.Bind();
-    shader.SetUniform4f("u_Color", r, 0.9f,1-r,1.0f);
-    
-    va.Bind();
-    ib.Bind();
+    //* Process events to the window and shi
+    glfwPollEvents();
 
-    //* We change it to glDrawElements to use an index buffer
-    GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
+    double start = glfwGetTime();
+    //* Every field gets written, the buffer we're handed may hold any older frame.
+    FramePacket& packet = packets.GetWriteBuffer();
+    packet.r = r;
+    packet.frame = frame;
 
     if(r > 1.0f){
       increment = -0.01f;
@@ -127,16 +234,38 @@ int main()
     }
 
     r += increment;
+    ++frame;
+    simulateMs += (glfwGetTime() - start) * 1000.0;
 
-    //? Swap front and back bufers
-    GLCall(glfwSwapBuffers(window));
-
-    //* Process events to the window and shi
-    GLCall(glfwPollEvents());
+    //* Everything above ran while the render thread drew the last packet. Once it's done this one can't
+    //* replace it unseen.
+    renderThread.WaitForRender();
+    packets.Publish();
+    renderThread.Kick();
   }
 
+  //* Joins the render thread, the context is current on this thread again afterwards.
+  renderThread.Stop();
+
+  const RenderThreadStats& threadStats = renderThread.GetStats();
+  //* The window can be closed before the first frame is drawn.
+  double drawnFrames = threadStats.frames ? static_cast<double>(threadStats.frames) : 1.0;
+  std::cout << "Render thread: " << threadStats.frames << " frames, " << threadStats.renderMs / drawnFrames << " ms rendering and "
+    << threadStats.idleMs / drawnFrames << " ms waiting for the simulation per frame, simulation " << simulateMs / (frame ? frame : 1) << " ms per frame\n";
+  const GLStateStats& stats = GLState::GetStats();
+  std::cout << "GL state cache: " << stats.GetIssued() << " binds issued, " << stats.GetSkipped() << " redundant binds skipped\n";
+  const ShaderVariantStats& variantStats = ShaderVariants::GetStats();
+  std::cout << "Shader variants: " << variantStats.GetHitRate() * 100.0f << "% of draws specialized, " << variantStats.fallbacks << " on the uber shader, "
+    << variantStats.fallbackMs << " ms waited in total\n";
+
+  ShaderCompiler::Shutdown();
+
+  //* Last chance to delete queued objects while the context is still alive. The registry queues whatever it still owns first.
+  ResourceRegistry::Clear();
+  DeletionQueue::Flush();
+
   //* Destroy the window
   glfwDestroyWindow(window);
   glfwTerminate();
   return 0;
-}
\ No newline at end of file
+}
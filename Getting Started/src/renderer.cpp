@@ -2,6 +2,13 @@
 
 #include <iostream>
 
+#include "GLState.h"
+#include "GLExtensions.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "VertexFormatCache.h"
+
 void GLClearError(){
   while(glGetError() != GL_NO_ERROR);
 }
@@ -12,4 +19,51 @@ bool GLLogCall(const char* fn, const char* file, int line){
     return false;
   }
   return true;
-}
\ No newline at end of file
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const{
+  shader.Bind();
+  va.Bind();
+  ib.Bind();
+  GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+}
+
+void Renderer::Draw(const VertexArray& va, const HeapMesh& mesh, const Shader& shader) const{
+  shader.Bind();
+  va.Bind();
+  GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.buffer);
+  //* The index offset is a byte offset into the element buffer, the base vertex gets added to every index.
+  GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, mesh.indexType,
+    reinterpret_cast<const void*>(static_cast<uintptr_t>(mesh.indices.offset)), mesh.vertices.offset / mesh.vertexStride));
+}
+
+void Renderer::Draw(VertexFormat format, const HeapMesh& mesh, const Shader& shader) const{
+  shader.Bind();
+  //* Offset 0 + base vertex keeps the vertex buffer binding identical for every mesh in the block.
+  VertexFormatCache::Bind(format, mesh.vertices.buffer);
+  GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.buffer);
+  GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, mesh.indexType,
+    reinterpret_cast<const void*>(static_cast<uintptr_t>(mesh.indices.offset)), mesh.vertices.offset / mesh.vertexStride));
+}
+
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const{
+  shader.Bind();
+  va.Bind();
+  ib.Bind();
+  GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr, instanceCount));
+}
+
+void Renderer::DrawInstanced(const VertexArray& va, const HeapMesh& mesh, const Shader& shader, unsigned int instanceCount, unsigned int baseInstance) const{
+  shader.Bind();
+  va.Bind();
+  GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.buffer);
+  const void* indices = reinterpret_cast<const void*>(static_cast<uintptr_t>(mesh.indices.offset));
+  int baseVertex = mesh.vertices.offset / mesh.vertexStride;
+  //* Base vertex alone has been core since 3.2, only the base instance needs the extension.
+  if(baseInstance == 0){
+    GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.indexCount, mesh.indexType, indices, instanceCount, baseVertex));
+    return;
+  }
+  ASSERT(GLAD_GL_ARB_base_instance);
+  GLCall(glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, mesh.indexCount, mesh.indexType, indices, instanceCount, baseVertex, baseInstance));
+}
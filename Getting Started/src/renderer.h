@@ -5,14 +5,65 @@
 #include <csignal>
 #include <iostream>
 
+#include "GLDebug.h"
+
 #define ASSERT(x) if (!(x)) raise(SIGTRAP);
+
+//* Debug builds track call sites as well, so KHR_debug warnings (which glGetError never sees) say where they came from.
+#if !defined(NDEBUG) && !defined(GL_TRACK_CALL_SITES)
+#define GL_TRACK_CALL_SITES
+#endif
+
 //* This funciton is used to check for an error in any of our functions and then print the line, the file, and the 
 //* It will breakpoint whenever there is an error and quit the code and tell me where and stuff.
-#define GLCall(x) do { \
+//! Every GLCallChecked is two glGetError loops, and each glGetError is a round trip into the driver.
+#define GLCallChecked(x) do { \
     GLClearError();\
-    x;\
+    GLCallBare(x);\
     ASSERT(GLLogCall(#x, __FILE__, __LINE__)); \
 } while (false)
 
+//* The release version is just the call. Errors come from the KHR_debug callback (see GLDebug.h) instead.
+//* With GL_TRACK_CALL_SITES it also remembers the call site in a thread_local so synchronous debug output can report it.
+//* That's on in debug builds, for release builds pass -DGL_TRACK_CALL_SITES (make release-trace).
+#ifdef GL_TRACK_CALL_SITES
+#define GLCallBare(x) do { \
+    GLMarkCallSite(#x, __FILE__, __LINE__);\
+    x;\
+} while (false)
+#else
+#define GLCallBare(x) x
+#endif
+
+//* Release builds (make release, -DNDEBUG) drop the per call error checks.
+#ifdef NDEBUG
+#define GLCall(x) GLCallBare(x)
+#else
+#define GLCall(x) GLCallChecked(x)
+#endif
+
 void GLClearError();
-bool GLLogCall(const char* fn, const char* file, int line);
\ No newline at end of file
+bool GLLogCall(const char* fn, const char* file, int line);
+
+class VertexArray;
+class IndexBuffer;
+class Shader;
+struct HeapMesh;
+struct VertexFormat;
+
+class Renderer {
+public:
+  void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+  //* va has to be the VAO set up on the block mesh.vertices lives in.
+  void Draw(const VertexArray& va, const HeapMesh& mesh, const Shader& shader) const;
+  //* Uses the shared VAO of format instead, so meshes of every block can be drawn without their own VAO.
+  void Draw(VertexFormat format, const HeapMesh& mesh, const Shader& shader) const;
+
+  //* instanceCount copies in one call, per instance data comes from buffers added with a divisor.
+  void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const;
+  /*
+  baseInstance is where the per instance attributes start reading, so several instance ranges can share one buffer.
+  A non zero baseInstance needs ARB_base_instance (4.2), check GLAD_GL_ARB_base_instance first. macOS doesn't have it.
+  */
+  void DrawInstanced(const VertexArray& va, const HeapMesh& mesh, const Shader& shader, unsigned int instanceCount, unsigned int baseInstance = 0) const;
+};